@@ -0,0 +1,602 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   alert.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Starting powershell.exe for every alert takes 400-900 ms and a CPU spike, right when the pedal is failing.
+ * The SAPI backend creates one ISpVoice at startup and keeps it alive; SPF_ASYNC makes Speak() return
+ * immediately and the voice plays the phrase on its own thread, the alert thread waits for the
+ * SPEI_START_INPUT_STREAM event to measure the latency and then for the end of the phrase.
+ *
+ * ALERT_WAV takes SAPI out of the alert itself: the phrase of every watch (or --alert_wav file.wav) and,
+ * with --alert_value, the digits 0-9 are rendered once at startup into memory as WAV.  An alert is
+ * PlaySound(SND_MEMORY | SND_ASYNC) of a clip that is ready to play, or with --alert_value the phrase and
+ * the digit clips of lwan_uint32_to_str() copied one after the other into a preallocated buffer.
+ * The latency measured is until PlaySound() returns, the sound driver adds its own buffer to that.
+ *
+ * All backends are driven by AlertThread().  The sampling loop calls AlertPost(), which only takes
+ * alert_lock long enough to copy a few words into the queue; the thread does the slow part.
+ *
+ * I had to add ole32 in
+ * Run->Set-Project-Configuration->Customize->Build->Linker->Libraries->Add-Library
+ * for CoCreateInstance()
+ */
+
+#define COBJMACROS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "windows.h"
+#include <sapi.h>
+
+#include "alert.h"
+#include "timer.h"
+
+extern int verbose_flag; /* main.c */
+
+/* Local copies of the GUIDs so we don't depend on sapi.lib/uuid.lib exporting them */
+static const CLSID FPM_CLSID_SpVoice = {0x96749377, 0x3391, 0x11D2, {0x9E, 0xE3, 0x00, 0xC0, 0x4F, 0x79, 0x73, 0x96}};
+static const IID   FPM_IID_ISpVoice  = {0x6C44DF74, 0x72B9, 0x4992, {0xA1, 0xEC, 0xEF, 0x99, 0x6E, 0x04, 0x22, 0xD4}};
+static const CLSID FPM_CLSID_SpStream = {0x715D9C59, 0x4442, 0x11D2, {0x96, 0x05, 0x00, 0xC0, 0x4F, 0x8E, 0xE6, 0x28}};
+static const IID   FPM_IID_ISpStream  = {0x12E3CCA9, 0x7518, 0x44C5, {0xA5, 0xE7, 0xBA, 0x5A, 0x79, 0xCB, 0x92, 0x9E}};
+static const GUID  FPM_SPDFID_WaveFormatEx = {0xC31ADBAE, 0x527F, 0x4FF5, {0xA2, 0x30, 0xF6, 0x2B, 0xB6, 0x1F, 0xF7, 0x0C}};
+
+#define WAV_HEADER 44              // RIFF, fmt and data headers of a plain PCM file
+#define WAV_GAP_MS 80              // between the phrase and the value
+#define WAV_TRIM_MS 10             // silence kept at both ends of a rendered clip
+
+typedef struct {
+    unsigned char *wav;   // a whole WAV file that PlaySound(SND_MEMORY) plays as it is
+    DWORD wav_bytes;
+    const unsigned char *pcm; // the samples inside it
+    DWORD pcm_bytes;
+    int owned;            // wav was malloc()ed for this clip, the others share it
+} Clip;
+
+typedef struct {
+    int id;
+    DWORD axis_value;
+    LONGLONG posted_qpc;   // when AlertPost() queued it
+} AlertRequest;
+
+static AlertBackend alert_backend = ALERT_POWERSHELL;
+static ISpVoice *voice = NULL;
+static HANDLE voice_event = NULL; // signaled when the voice has SPEI_START_INPUT_STREAM events
+static int com_initialized = 0;
+
+static CRITICAL_SECTION alert_lock;
+static int lock_initialized = 0;
+static HANDLE alert_wake = NULL;   // auto-reset, signaled by AlertPost() and AlertShutdown()
+static HANDLE alert_ready = NULL;  // the thread finished initializing the backend
+static HANDLE alert_thread = NULL;
+static volatile LONG alert_quit = 0;
+
+/* Protected by alert_lock */
+static AlertRequest queue[ALERT_QUEUE_SIZE];
+static int queue_head = 0, queue_count = 0;
+static int playing_id = -1;
+static ULONGLONG last_alert_tick = 0;
+static int any_alert = 0;
+static UINT min_gap = 0;
+static AlertStats stats;
+static Histogram latency_us;
+
+static wchar_t names[ALERT_MAX_IDS][32];
+
+static char command_line[150];
+static char *where;
+
+/* ALERT_WAV */
+static const char *wav_file = NULL;
+static int speak_value = 0;
+static WAVEFORMATEX clip_format;
+static Clip file_clip;
+static Clip name_clips[ALERT_MAX_IDS];
+static Clip digit_clips[10];
+static unsigned char *play_buffer = NULL; // --alert_value, the phrase and the digits of one alert
+static DWORD play_capacity = 0;
+
+
+//https://tia.mat.br/posts/2014/06/23/integer_to_string_conversion.html
+#define INT_TO_STR_BUFFER_SIZE (3 * sizeof(int))
+char *lwan_uint32_to_str(uint32_t value, char buffer[static INT_TO_STR_BUFFER_SIZE]) {
+
+    char *p = buffer + INT_TO_STR_BUFFER_SIZE -1;
+
+   *p = '\0';
+    do {
+        *--p = "0123456789"[value % 10];
+    } while (value /= 10);
+
+    size_t difference = (size_t)(p - buffer);
+    int len = (int)(INT_TO_STR_BUFFER_SIZE - difference - 1);
+
+    p[len++] = ' '; // add a space to clean a possibly longer previous lastAxis value
+    p[len] = '\0';
+
+    return p;
+}
+
+
+int AlertBackendFromName(const char *name) {
+    for (int b = ALERT_SAPI; b <= ALERT_WAV; b++)
+        if (strcmp(name, AlertBackendName((AlertBackend)b)) == 0) return b;
+    return -1;
+}
+
+
+const char *AlertBackendName(AlertBackend backend) {
+    switch (backend) {
+        case ALERT_SAPI: return "sapi";
+        case ALERT_POWERSHELL: return "powershell";
+        case ALERT_WAV: return "wav";
+    }
+    return "?";
+}
+
+
+void AlertSetWav(const char *path, int with_value) {
+    wav_file = path;
+    speak_value = with_value;
+}
+
+
+static int SapiInit(void) {
+    HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    if (FAILED(hr)) return 0;
+    com_initialized = 1;
+
+    hr = CoCreateInstance(&FPM_CLSID_SpVoice, NULL, CLSCTX_ALL, &FPM_IID_ISpVoice, (void **)&voice);
+    if (FAILED(hr)) {
+        voice = NULL;
+        return 0;
+    }
+
+    ISpVoice_SetRate(voice, 3); // same as $speak.Rate = 3 in sayRudder.ps1
+
+    if (SUCCEEDED(ISpVoice_SetInterest(voice, SPFEI(SPEI_START_INPUT_STREAM), SPFEI(SPEI_START_INPUT_STREAM)))
+        && SUCCEEDED(ISpVoice_SetNotifyWin32Event(voice)))
+        voice_event = ISpVoice_GetNotifyEventHandle(voice);
+
+    // Speak nothing once, so the audio device is opened now and not on the first real alert
+    ISpVoice_Speak(voice, L"", SPF_ASYNC, NULL);
+    return 1;
+}
+
+
+static void DrainVoiceEvents(void) {
+    SPEVENT ev;
+    ULONG fetched = 0;
+    while (SUCCEEDED(ISpVoice_GetEvents(voice, 1, &ev, &fetched)) && fetched == 1) ; // no pointer parameters for this event
+}
+
+
+static void WriteWavHeader(unsigned char *p, const WAVEFORMATEX *f, DWORD pcm_bytes) {
+    DWORD riff = 36 + pcm_bytes, fmt = 16, rate = f->nSamplesPerSec, bytes_per_second = f->nAvgBytesPerSec;
+    WORD tag = WAVE_FORMAT_PCM, channels = f->nChannels, align = f->nBlockAlign, bits = f->wBitsPerSample;
+    memcpy(p, "RIFF", 4);       memcpy(p + 4, &riff, 4);
+    memcpy(p + 8, "WAVEfmt ", 8); memcpy(p + 16, &fmt, 4);
+    memcpy(p + 20, &tag, 2);    memcpy(p + 22, &channels, 2);
+    memcpy(p + 24, &rate, 4);   memcpy(p + 28, &bytes_per_second, 4);
+    memcpy(p + 32, &align, 2);  memcpy(p + 34, &bits, 2);
+    memcpy(p + 36, "data", 4);  memcpy(p + 40, &pcm_bytes, 4);
+}
+
+
+static int IsSilent(const unsigned char *frame) {
+    if (clip_format.wBitsPerSample == 8) return frame[0] > 124 && frame[0] < 132;
+    int16_t v;
+    memcpy(&v, frame, 2);
+    return v > -256 && v < 256;
+}
+
+
+/* Speaks text into memory in clip_format, without the silence SAPI puts around it.  Returns 0 on success */
+static int RenderClip(const wchar_t *text, Clip *clip) {
+    IStream *mem = NULL;
+    ISpStream *sp = NULL;
+    HGLOBAL global = NULL;
+    int result = -1;
+
+    if (FAILED(CreateStreamOnHGlobal(NULL, TRUE, &mem))) return -1;
+    if (FAILED(CoCreateInstance(&FPM_CLSID_SpStream, NULL, CLSCTX_ALL, &FPM_IID_ISpStream, (void **)&sp))) goto DONE;
+    if (FAILED(ISpStream_SetBaseStream(sp, mem, &FPM_SPDFID_WaveFormatEx, &clip_format))) goto DONE;
+    if (FAILED(ISpVoice_SetOutput(voice, (IUnknown *)sp, TRUE))) goto DONE;
+    HRESULT hr = ISpVoice_Speak(voice, text, SPF_IS_NOT_XML, NULL); // synchronous, it's only written to memory
+    ISpVoice_SetOutput(voice, NULL, TRUE);
+    if (FAILED(hr)) goto DONE;
+
+    LARGE_INTEGER zero;
+    ULARGE_INTEGER end;
+    zero.QuadPart = 0;
+    if (FAILED(IStream_Seek(mem, zero, STREAM_SEEK_CUR, &end)) || FAILED(GetHGlobalFromStream(mem, &global))) goto DONE;
+
+    const unsigned char *pcm = (const unsigned char *)GlobalLock(global);
+    DWORD align = clip_format.nBlockAlign, first = 0, last = (DWORD)end.QuadPart / align;
+    while (first < last && IsSilent(pcm + first * align)) first++;
+    while (last > first && IsSilent(pcm + (last - 1) * align)) last--;
+    DWORD keep = clip_format.nSamplesPerSec * WAV_TRIM_MS / 1000;
+    first = first > keep ? first - keep : 0;
+    last = last + keep < (DWORD)end.QuadPart / align ? last + keep : (DWORD)end.QuadPart / align;
+
+    DWORD bytes = (last - first) * align;
+    clip->wav = (unsigned char *)malloc(WAV_HEADER + bytes);
+    if (clip->wav) {
+        WriteWavHeader(clip->wav, &clip_format, bytes);
+        memcpy(clip->wav + WAV_HEADER, pcm + first * align, bytes);
+        clip->wav_bytes = WAV_HEADER + bytes;
+        clip->pcm = clip->wav + WAV_HEADER;
+        clip->pcm_bytes = bytes;
+        clip->owned = 1;
+        result = 0;
+    }
+    GlobalUnlock(global);
+
+DONE:
+    if (sp) ISpStream_Release(sp);
+    IStream_Release(mem);
+    return result;
+}
+
+
+/* --alert_wav: the file as it is, and its PCM samples if --alert_value has to add digits to it */
+static int LoadWavFile(const char *path, Clip *clip) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    clip->wav = size > 12 ? (unsigned char *)malloc(size) : NULL;
+    if (clip->wav == NULL || fread(clip->wav, 1, size, f) != (size_t)size) {
+        fclose(f);
+        free(clip->wav);
+        memset(clip, 0, sizeof(*clip));
+        return -1;
+    }
+    fclose(f);
+    clip->wav_bytes = (DWORD)size;
+    clip->owned = 1;
+    if (memcmp(clip->wav, "RIFF", 4) != 0 || memcmp(clip->wav + 8, "WAVE", 4) != 0) return -1;
+
+    int have_format = 0;
+    for (long pos = 12; pos + 8 <= size; ) {
+        DWORD chunk;
+        memcpy(&chunk, clip->wav + pos + 4, 4);
+        if (chunk > (DWORD)(size - pos - 8)) chunk = (DWORD)(size - pos - 8);
+        if (memcmp(clip->wav + pos, "fmt ", 4) == 0 && chunk >= 16) {
+            memset(&clip_format, 0, sizeof(clip_format));
+            memcpy(&clip_format, clip->wav + pos + 8, 16);
+            have_format = 1;
+        } else if (memcmp(clip->wav + pos, "data", 4) == 0) {
+            clip->pcm = clip->wav + pos + 8;
+            clip->pcm_bytes = chunk;
+        }
+        pos += 8 + chunk + (chunk & 1);
+    }
+    if (!have_format || clip->pcm == NULL) return -1;
+
+    // nBlockAlign and nAvgBytesPerSec are divisors on the alert thread, a broken header must not get there
+    const WAVEFORMATEX *fmt = &clip_format;
+    if (fmt->nChannels == 0 || fmt->nSamplesPerSec == 0 || fmt->nBlockAlign == 0 || fmt->nAvgBytesPerSec == 0) return -1;
+    if (fmt->wFormatTag == WAVE_FORMAT_PCM && fmt->nAvgBytesPerSec != fmt->nSamplesPerSec * fmt->nBlockAlign) return -1;
+    return 0;
+}
+
+
+/* On the alert thread, before the first alert.  Returns 0 if every clip is ready */
+static int WavInit(void) {
+    int need_voice = wav_file == NULL || speak_value;
+
+    clip_format.wFormatTag = WAVE_FORMAT_PCM; // what SAPI renders without a file: SPSF_22kHz16BitMono
+    clip_format.nChannels = 1;
+    clip_format.nSamplesPerSec = 22050;
+    clip_format.wBitsPerSample = 16;
+    clip_format.nBlockAlign = 2;
+    clip_format.nAvgBytesPerSec = 44100;
+    clip_format.cbSize = 0;
+
+    if (wav_file) {
+        if (LoadWavFile(wav_file, &file_clip) != 0) {
+            printf("Could not read '%s', or it is not a WAV file\n", wav_file);
+            return -1;
+        }
+        if (speak_value && (clip_format.wFormatTag != WAVE_FORMAT_PCM || (clip_format.wBitsPerSample != 8 && clip_format.wBitsPerSample != 16))) {
+            printf("'%s' is not 8 or 16-bit PCM, --alert_value is ignored\n", wav_file);
+            speak_value = 0;
+            need_voice = 0;
+        }
+    }
+    if (need_voice && !SapiInit()) return -1;
+
+    DWORD longest = 0;
+    for (int id = 0; id < ALERT_MAX_IDS; id++) {
+        if (wav_file || (id > 0 && names[id][0] == L'\0')) {
+            name_clips[id] = wav_file ? file_clip : name_clips[0];
+            name_clips[id].owned = 0;
+        } else if (RenderClip(names[id][0] ? names[id] : L"Rudder", &name_clips[id]) != 0) return -1;
+        if (name_clips[id].pcm_bytes > longest) longest = name_clips[id].pcm_bytes;
+    }
+    if (speak_value) {
+        DWORD digit_longest = 0;
+        for (int k = 0; k < 10; k++) {
+            wchar_t digit[2] = { (wchar_t)(L'0' + k), L'\0' };
+            if (RenderClip(digit, &digit_clips[k]) != 0) return -1;
+            if (digit_clips[k].pcm_bytes > digit_longest) digit_longest = digit_clips[k].pcm_bytes;
+        }
+        play_capacity = WAV_HEADER + longest + clip_format.nAvgBytesPerSec * WAV_GAP_MS / 1000 + 10 * digit_longest;
+        play_buffer = (unsigned char *)malloc(play_capacity);
+        if (play_buffer == NULL) return -1;
+    }
+    if (voice) { // not needed anymore, nothing of SAPI runs during an alert
+        ISpVoice_Release(voice);
+        voice = NULL;
+        voice_event = NULL;
+    }
+
+    // a silent clip once, so the wave device is opened now and not on the first real alert
+    static unsigned char silence[WAV_HEADER + 64];
+    WriteWavHeader(silence, &clip_format, 0);
+    PlaySound((LPCSTR)silence, NULL, SND_MEMORY | SND_NODEFAULT);
+    return 0;
+}
+
+
+/* The clip of one alert, with the value after the phrase for --alert_value.  Returns the WAV to play */
+static const unsigned char *ComposeWav(const AlertRequest *rq, DWORD *pcm_bytes) {
+    const Clip *name = &name_clips[rq->id >= 0 && rq->id < ALERT_MAX_IDS ? rq->id : 0];
+    if (!speak_value) {
+        *pcm_bytes = name->pcm_bytes;
+        return name->wav;
+    }
+
+    char num_str[30];
+    unsigned char *p = play_buffer + WAV_HEADER;
+    memcpy(p, name->pcm, name->pcm_bytes);
+    p += name->pcm_bytes;
+    DWORD gap = clip_format.nAvgBytesPerSec * WAV_GAP_MS / 1000 / clip_format.nBlockAlign * clip_format.nBlockAlign;
+    memset(p, clip_format.wBitsPerSample == 8 ? 0x80 : 0, gap);
+    p += gap;
+    for (const char *c = lwan_uint32_to_str(rq->axis_value, num_str); *c; c++) {
+        if (*c < '0' || *c > '9') continue; // the space lwan_uint32_to_str() adds for the command line
+        const Clip *digit = &digit_clips[*c - '0'];
+        memcpy(p, digit->pcm, digit->pcm_bytes);
+        p += digit->pcm_bytes;
+    }
+    *pcm_bytes = (DWORD)(p - play_buffer - WAV_HEADER);
+    WriteWavHeader(play_buffer, &clip_format, *pcm_bytes);
+    return play_buffer;
+}
+
+
+static void WavShutdown(void) {
+    PlaySound(NULL, NULL, SND_PURGE);
+    for (int id = 0; id < ALERT_MAX_IDS; id++) if (name_clips[id].owned) free(name_clips[id].wav);
+    for (int k = 0; k < 10; k++) if (digit_clips[k].owned) free(digit_clips[k].wav);
+    if (file_clip.owned) free(file_clip.wav);
+    free(play_buffer);
+    memset(name_clips, 0, sizeof(name_clips));
+    memset(digit_clips, 0, sizeof(digit_clips));
+    memset(&file_clip, 0, sizeof(file_clip));
+    play_buffer = NULL;
+}
+
+
+/* Returns when the phrase started (SAPI) or the script finished (powershell), in QPC units */
+static LONGLONG Say(const AlertRequest *rq) {
+    LONGLONG started;
+
+    if (alert_backend == ALERT_SAPI) {
+        const wchar_t *phrase = (rq->id >= 0 && rq->id < ALERT_MAX_IDS && names[rq->id][0]) ? names[rq->id] : L"Rudder";
+        if (verbose_flag) printf("speaking [%ls] lastAxis=[%lu]\n", phrase, rq->axis_value);
+        if (voice_event) DrainVoiceEvents();
+        ISpVoice_Speak(voice, phrase, SPF_ASYNC | SPF_IS_NOT_XML, NULL);
+        if (voice_event) WaitForSingleObject(voice_event, 2000);
+        started = QpcNow();
+        // Wait for the end on this thread: while it speaks, playing_id makes AlertPost() coalesce
+        ISpVoice_WaitUntilDone(voice, INFINITE);
+        return started;
+    }
+
+    if (alert_backend == ALERT_WAV) {
+        DWORD pcm_bytes;
+        const unsigned char *wav = ComposeWav(rq, &pcm_bytes);
+        if (verbose_flag) printf("playing [%u bytes] lastAxis=[%lu]\n", (unsigned)pcm_bytes, rq->axis_value);
+        PlaySound((LPCSTR)wav, NULL, SND_MEMORY | SND_ASYNC | SND_NODEFAULT);
+        started = QpcNow();
+        // the buffer is played from where it is, don't touch it before the end
+        Sleep((DWORD)((ULONGLONG)pcm_bytes * 1000 / clip_format.nAvgBytesPerSec) + 10);
+        return started;
+    }
+
+    char num_str[30]; // big enough for sizeof(lastAxis)
+
+    strcpy(where, lwan_uint32_to_str(rq->axis_value, num_str)); // where is the fixed position in command_line where the lastAxis should be copied into command_line
+    if (verbose_flag) printf("calling [%s]\n", command_line);
+    system(command_line); // tell the user that the pedal is failing
+    return QpcNow();
+}
+
+
+static DWORD WINAPI AlertThread(LPVOID param) {
+    AlertBackend requested = *(AlertBackend *)param;
+
+    alert_backend = ALERT_POWERSHELL;
+    if (requested == ALERT_SAPI) {
+        if (SapiInit())
+            alert_backend = ALERT_SAPI;
+        else
+            puts("Could not create the SAPI voice, falling back to sayRudder.ps1");
+    } else if (requested == ALERT_WAV) {
+        if (WavInit() == 0)
+            alert_backend = ALERT_WAV;
+        else {
+            puts("Could not prepare the alert sounds, falling back to sayRudder.ps1");
+            WavShutdown();
+        }
+    }
+    SetEvent(alert_ready);
+
+    while (!alert_quit) {
+        WaitForSingleObject(alert_wake, INFINITE);
+
+        for (;;) {
+            AlertRequest rq;
+
+            EnterCriticalSection(&alert_lock);
+            if (alert_quit || queue_count == 0) {
+                playing_id = -1;
+                LeaveCriticalSection(&alert_lock);
+                break;
+            }
+            rq = queue[queue_head];
+            queue_head = (queue_head + 1) % ALERT_QUEUE_SIZE;
+            queue_count--;
+            playing_id = rq.id;
+            stats.spoken++;
+            LeaveCriticalSection(&alert_lock);
+
+            LONGLONG started = Say(&rq);
+
+            EnterCriticalSection(&alert_lock);
+            HistAdd(&latency_us, (uint64_t)QpcToMicroseconds(started - rq.posted_qpc));
+            LeaveCriticalSection(&alert_lock);
+        }
+    }
+
+    if (alert_backend == ALERT_WAV) WavShutdown();
+    if (voice) {
+        ISpVoice_Release(voice);
+        voice = NULL;
+        voice_event = NULL; // owned by the voice
+    }
+    if (com_initialized) {
+        CoUninitialize();
+        com_initialized = 0;
+    }
+    return 0;
+}
+
+
+AlertBackend AlertInit(AlertBackend backend, UINT min_gap_ms) {
+    strcpy(command_line, "C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe  .\\sayRudder.ps1 12345678901234567890");
+    where = command_line + 75;  // 75 is the fixed position in string where the lastAxis should be copied into command_line
+
+    min_gap = min_gap_ms;
+    alert_quit = 0;
+    queue_head = queue_count = 0;
+    playing_id = -1;
+    any_alert = 0;
+    memset(&stats, 0, sizeof(stats));
+    HistReset(&latency_us);
+    if (!lock_initialized) { // kept after AlertShutdown(), AlertGetStats() still works then
+        InitializeCriticalSection(&alert_lock);
+        lock_initialized = 1;
+    }
+    alert_wake  = CreateEvent(NULL, FALSE, FALSE, NULL);
+    alert_ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+    alert_thread = CreateThread(NULL, 0, AlertThread, &backend, 0, NULL);
+    if (alert_thread == NULL) {
+        puts("Could not create the alert thread");
+        exit(1);
+    }
+    WaitForSingleObject(alert_ready, INFINITE); // backend is read by the thread before this returns
+
+    return alert_backend;
+}
+
+
+void AlertSetName(int id, const char *name) {
+    if (id < 0 || id >= ALERT_MAX_IDS) return;
+    if (MultiByteToWideChar(CP_ACP, 0, name, -1, names[id], 32) == 0) names[id][0] = L'\0';
+}
+
+
+void AlertPost(int id, DWORD axis_value) {
+    ULONGLONG now = GetTickCount64();
+    int wake = 0;
+
+    EnterCriticalSection(&alert_lock);
+
+    int i;
+    for (i = 0; i < queue_count; i++)
+        if (queue[(queue_head + i) % ALERT_QUEUE_SIZE].id == id) break;
+
+    if (i < queue_count) {
+        queue[(queue_head + i) % ALERT_QUEUE_SIZE].axis_value = axis_value; // still waiting, just refresh the value
+        stats.coalesced++;
+    } else if (playing_id == id) {
+        stats.coalesced++;
+    } else if (queue_count == ALERT_QUEUE_SIZE || (any_alert && now - last_alert_tick < min_gap)) {
+        stats.dropped++;
+    } else {
+        AlertRequest *rq = &queue[(queue_head + queue_count) % ALERT_QUEUE_SIZE];
+        rq->id = id;
+        rq->axis_value = axis_value;
+        rq->posted_qpc = QpcNow();
+        queue_count++;
+        stats.queued++;
+        last_alert_tick = now;
+        any_alert = 1;
+        wake = 1;
+    }
+
+    LeaveCriticalSection(&alert_lock);
+
+    if (wake) SetEvent(alert_wake);
+}
+
+
+void AlertGetStats(AlertStats *out) {
+    EnterCriticalSection(&alert_lock);
+    *out = stats;
+    LeaveCriticalSection(&alert_lock);
+}
+
+
+void AlertGetLatency(Histogram *out) {
+    EnterCriticalSection(&alert_lock);
+    *out = latency_us;
+    LeaveCriticalSection(&alert_lock);
+}
+
+
+int AlertWaitIdle(DWORD timeout_ms) {
+    DWORD deadline = GetTickCount() + timeout_ms;
+    for (;;) {
+        EnterCriticalSection(&alert_lock);
+        int busy = queue_count > 0 || playing_id >= 0;
+        LeaveCriticalSection(&alert_lock);
+        if (!busy) return 1;
+        if ((LONG)(GetTickCount() - deadline) >= 0) return 0;
+        Sleep(10);
+    }
+}
+
+
+HANDLE AlertThreadHandle(void) {
+    return alert_thread;
+}
+
+
+void AlertShutdown(void) {
+    if (alert_thread == NULL) return;
+
+    AlertWaitIdle(3000); // let the last warning finish, but don't hang the exit on a stuck backend
+
+    InterlockedExchange(&alert_quit, 1);
+    SetEvent(alert_wake);
+    WaitForSingleObject(alert_thread, 3000);
+
+    CloseHandle(alert_thread);
+    CloseHandle(alert_wake);
+    CloseHandle(alert_ready);
+    alert_thread = NULL;
+}
@@ -0,0 +1,78 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   alert.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Alert backends used to tell the user that the pedal is failing.
+ *
+ * ALERT_SAPI keeps one SAPI voice (ISpVoice) alive for the whole session and
+ * speaks asynchronously, so there is no child process per alert.
+ * ALERT_POWERSHELL is the original behavior: powershell.exe .\sayRudder.ps1 <lastAxis>
+ * ALERT_WAV plays a clip rendered once at startup (or a WAV file) from memory with PlaySound(),
+ * optionally followed by the digits of the axis value.
+ *
+ * The backend runs on its own alert thread.  AlertPost() only puts a request in a small bounded queue,
+ * so the sampling loop never waits for the speech to finish.
+ */
+
+#ifndef ALERT_H
+#define ALERT_H
+
+#include "windows.h"
+#include "hist.h"
+
+typedef enum {
+    ALERT_SAPI = 0,
+    ALERT_POWERSHELL,
+    ALERT_WAV
+} AlertBackend;
+
+#define ALERT_QUEUE_SIZE 8
+#define ALERT_MAX_IDS 32   // one per watched axis
+
+typedef struct {
+    LONG queued;     // accepted into the queue
+    LONG dropped;    // queue full, or closer than min_gap_ms to the previous alert
+    LONG coalesced;  // the same alert id was already queued or playing
+    LONG spoken;     // actually handed to the backend
+} AlertStats;
+
+/* ALERT_WAV: path NULL renders the names with SAPI, otherwise every alert plays that file.
+ * with_value says the digits of the axis value after it.  Call before AlertInit() */
+void AlertSetWav(const char *path, int with_value);
+
+/* Starts the alert thread and the backend.  min_gap_ms is the minimum time between two alerts.
+ * Returns the backend actually in use: if SAPI or the clips can't be created it falls back to ALERT_POWERSHELL */
+AlertBackend AlertInit(AlertBackend backend, UINT min_gap_ms);
+
+/* What the voice says for alerts of this id.  Default "Rudder".  Call before the first AlertPost() */
+void AlertSetName(int id, const char *name);
+
+/* Never blocks.  id identifies the axis that is failing, repeated alerts for the same id are coalesced */
+void AlertPost(int id, DWORD axis_value);
+
+void AlertGetStats(AlertStats *stats);
+
+/* Microseconds from AlertPost() to the voice starting the phrase (SAPI SPEI_START_INPUT_STREAM),
+ * to sayRudder.ps1 returning (powershell, the phrase is spoken before it exits) or to PlaySound() returning (wav) */
+void AlertGetLatency(Histogram *latency);
+
+/* Waits until the queue is empty and nothing is playing.  Returns 0 if timeout_ms passed first */
+int AlertWaitIdle(DWORD timeout_ms);
+
+/* AlertInit() can be called again after this */
+void AlertShutdown(void);
+
+/* For --resources and --games.  NULL when it isn't running */
+HANDLE AlertThreadHandle(void);
+
+/* Parses "sapi", "powershell" or "wav".  Returns -1 if the name is unknown */
+int AlertBackendFromName(const char *name);
+const char *AlertBackendName(AlertBackend backend);
+
+#endif /* ALERT_H */
@@ -0,0 +1,242 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   bench.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Every measurement is one CSV row: a histogram (HistWriteCsv) or, for throughput, only the mean column.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "detector.h"
+#include "input.h"
+
+#define BENCH_JOY_CALLS 10000
+#define BENCH_CAPS_CALLS 1000
+#define BENCH_TIMER_MS 3000          // each timer run stops after this, Sleep(1) is really ~15.6 ms
+#define BENCH_TIMER_TICKS 1000
+#define BENCH_ALERTS 3
+#define BENCH_SAMPLES (1 << 16)
+#define BENCH_DETECTOR_MS 500        // each detector run takes at least this
+
+static Histogram bench_hist;
+
+
+static void BenchInputCalls(const MonitorConfig *cfg, const WatchTable *wt) {
+    char name[48];
+    JOYINFOEX info;
+    JOYCAPS jc;
+
+    for (int d = 0; d < wt->device_count; d++) {
+        UINT id = wt->joy_ID[d];
+        int errors = 0;
+
+        HistReset(&bench_hist);
+        for (int i = 0; i < BENCH_JOY_CALLS; i++) {
+            info.dwSize = sizeof(info);
+            info.dwFlags = cfg->joy_Flags;
+            LONGLONG t0 = QpcNow();
+            MMRESULT mr = joyGetPosEx(id, &info);
+            HistAdd(&bench_hist, (uint64_t)QpcToNanoseconds(QpcNow() - t0));
+            if (mr != JOYERR_NOERROR) errors++;
+        }
+        if (errors) printf("# joyGetPosEx joystick %u: %d of %d calls failed\n", id, errors, BENCH_JOY_CALLS);
+        snprintf(name, sizeof(name), "joyGetPosEx_j%u", id);
+        HistWriteCsv(stdout, &bench_hist, name, "ns");
+
+        HistReset(&bench_hist);
+        for (int i = 0; i < BENCH_CAPS_CALLS; i++) {
+            LONGLONG t0 = QpcNow();
+            joyGetDevCaps(id, &jc, sizeof(jc));
+            HistAdd(&bench_hist, (uint64_t)QpcToNanoseconds(QpcNow() - t0));
+        }
+        snprintf(name, sizeof(name), "joyGetDevCaps_j%u", id);
+        HistWriteCsv(stdout, &bench_hist, name, "ns");
+
+#if FPM_INPUT != FPM_INPUT_WINMM
+        // the same read through the backend this binary was built with
+        WORD none = 0;
+        if (InputOpen(&id, &none, &none, 1, cfg->joy_Flags) != 0) continue;
+        FpmSample s;
+        errors = 0;
+        HistReset(&bench_hist);
+        for (int i = 0; i < BENCH_JOY_CALLS && !errors; i++) {
+            LONGLONG t0 = QpcNow();
+            InputRead(0, &s);
+            HistAdd(&bench_hist, (uint64_t)QpcToNanoseconds(QpcNow() - t0));
+            if (s.status != JOYERR_NOERROR) errors++; // lost, no more reads
+        }
+        InputClose();
+        snprintf(name, sizeof(name), "input_%s_j%u", InputName(), id);
+        HistWriteCsv(stdout, &bench_hist, name, "ns");
+#endif
+    }
+}
+
+
+static void BenchTimer(TimerKind kind, UINT period_ms) {
+    static SampleTimer t;
+    char name[48];
+    const char *kind_Name = kind == TIMER_WAITABLE ? "waitable" : "sleep";
+
+    if (SampleTimerStart(&t, kind, period_ms) != 0) {
+        printf("# timer_%s_%ums: could not create the timer\n", kind_Name, period_ms);
+        return;
+    }
+    LONGLONG start = QpcNow();
+    for (int i = 0; i < BENCH_TIMER_TICKS; i++) {
+        SampleTimerWait(&t);
+        if (QpcToMicroseconds(QpcNow() - start) > BENCH_TIMER_MS * 1000) break;
+    }
+    SampleTimerStop(&t);
+
+    printf("# timer_%s_%ums: requested=%u us high_resolution=%d missed=%llu\n", kind_Name, period_ms,
+           period_ms * 1000, t.high_resolution, t.missed);
+    snprintf(name, sizeof(name), "timer_%s_%ums", kind_Name, period_ms);
+    HistWriteCsv(stdout, &t.period_us, name, "us");
+}
+
+
+static void BenchAlert(AlertBackend backend) {
+    char name[32];
+    snprintf(name, sizeof(name), "alert_%s", AlertBackendName(backend));
+
+    if (AlertInit(backend, 0) != backend) { // SAPI or the clips fell back to powershell
+        AlertShutdown();
+        printf("# %s: not available\n", name);
+        return;
+    }
+    AlertSetName(0, "Rudder");
+    for (int i = 0; i < BENCH_ALERTS; i++) {
+        AlertPost(0, AXIS_REST);
+        if (!AlertWaitIdle(15000)) {
+            printf("# %s: no answer after 15 s\n", name);
+            break;
+        }
+    }
+    AlertGetLatency(&bench_hist);
+    AlertShutdown();
+    HistWriteCsv(stdout, &bench_hist, name, "us");
+}
+
+
+/* An idle pedal with a stuck stretch and some noise, the same every run */
+static void MakeTrace(uint16_t *axis, uint16_t *gate, FpmSample *samples) {
+    uint32_t seed = 12345;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint16_t a = AXIS_REST;
+        if (i % 4096 < 64) a = (uint16_t)(500 + (seed >> 16) % 3);          // stuck
+        else if ((seed >> 16) % 2000 == 0) a = (uint16_t)((seed >> 8) % 1024); // noise
+        axis[i] = a;
+        gate[i] = AXIS_REST;
+
+        memset(&samples[i], 0, sizeof(samples[i]));
+        samples[i].t_us = (int64_t)i * 1000; // 1 kHz, the stat engine measures the interval
+        for (int k = 0; k < FPM_AXES; k++) samples[i].axes[k] = AXIS_REST;
+        samples[i].axes[FPM_R] = a;
+    }
+}
+
+
+static void WriteThroughput(const char *name, unsigned long long samples, LONGLONG ticks) {
+    double seconds = QpcToMicroseconds(ticks) / 1e6;
+    printf("%s,samples/s,%llu,,,,,,%.0f\n", name, samples, seconds > 0 ? samples / seconds : 0.0);
+}
+
+
+static void BenchDetector(DetectorKernel configured) {
+    static uint16_t axis[BENCH_SAMPLES], gate[BENCH_SAMPLES];
+    static FpmSample samples[BENCH_SAMPLES];
+    static WatchTable wt;
+    uint32_t alert_at[1024];
+    char name[48];
+    volatile uint64_t sink = 0;
+
+    MakeTrace(axis, gate, samples);
+
+    // per sample, what the live loop does
+    WatchInit(&wt);
+    WatchFinish(&wt, 0, 5);
+    unsigned long long n = 0;
+    LONGLONG start = QpcNow(), ticks;
+    do {
+        for (int i = 0; i < BENCH_SAMPLES; i++) sink += DetectorFeed(&wt, &samples[i]);
+        n += BENCH_SAMPLES;
+        ticks = QpcNow() - start;
+    } while (QpcToMicroseconds(ticks) < BENCH_DETECTOR_MS * 1000);
+    WriteThroughput("detector_feed", n, ticks);
+
+    WatchInit(&wt);
+    wt.default_engine = ENGINE_STAT;
+    WatchFinish(&wt, 0, 5);
+    n = 0;
+    start = QpcNow();
+    do {
+        for (int i = 0; i < BENCH_SAMPLES; i++) sink += DetectorFeed(&wt, &samples[i]);
+        n += BENCH_SAMPLES;
+        ticks = QpcNow() - start;
+    } while (QpcToMicroseconds(ticks) < BENCH_DETECTOR_MS * 1000);
+    WriteThroughput("detector_feed_stat", n, ticks);
+
+    DetectorRule rule = { wt.margin[0], wt.rest[0], wt.gate_rest[0], wt.repeat[0] };
+    for (int k = KERNEL_SCALAR; k <= KERNEL_AVX2; k++) {
+        if (DetectorSetKernel((DetectorKernel)k) != (DetectorKernel)k) {
+            printf("# detector_%s: not supported by this CPU\n", DetectorKernelName((DetectorKernel)k));
+            continue;
+        }
+        n = 0;
+        start = QpcNow();
+        do {
+            DetectorState st = { 0, 0 };
+            for (size_t pos = 0; pos < BENCH_SAMPLES; ) {
+                int count;
+                pos += DetectorScan(&rule, &st, axis + pos, gate + pos, BENCH_SAMPLES - pos, alert_at, 1024, &count);
+                sink += count;
+            }
+            n += BENCH_SAMPLES;
+            ticks = QpcNow() - start;
+        } while (QpcToMicroseconds(ticks) < BENCH_DETECTOR_MS * 1000);
+        snprintf(name, sizeof(name), "detector_%s", DetectorKernelName((DetectorKernel)k));
+        WriteThroughput(name, n, ticks);
+    }
+    DetectorSetKernel(configured);
+}
+
+
+int BenchRun(MonitorConfig *cfg) {
+    WatchTable *wt = &cfg->watches;
+    SYSTEM_INFO si;
+
+    if (cfg->joy_ID < FPM_MAX_DEVICES || wt->spec_count) WatchFinish(wt, cfg->joy_ID, cfg->margin);
+    GetSystemInfo(&si);
+
+    printf("# fanatecmonitor --bench, built %s %s\n", __DATE__, __TIME__);
+    printf("# processors=%lu detector_kernel=%s joy_Flags=%lu\n", si.dwNumberOfProcessors,
+           DetectorKernelName(cfg->detector_Kernel), cfg->joy_Flags);
+    puts(HIST_CSV_HEADER);
+
+    if (wt->device_count == 0) puts("# no --joystick or --watch, joyGetPosEx and joyGetDevCaps skipped");
+    BenchInputCalls(cfg, wt);
+
+    UINT periods[3] = { 1, 10, cfg->sleep_Time };
+    int period_Count = (cfg->sleep_Time > 0 && cfg->sleep_Time <= 100 && cfg->sleep_Time != 1 && cfg->sleep_Time != 10) ? 3 : 2;
+    for (int k = TIMER_WAITABLE; k <= TIMER_SLEEP; k++)
+        for (int p = 0; p < period_Count; p++) BenchTimer((TimerKind)k, periods[p]);
+
+    AlertSetWav(cfg->alert_Wav, cfg->alert_Value);
+    BenchAlert(ALERT_SAPI);
+    BenchAlert(ALERT_POWERSHELL);
+    BenchAlert(ALERT_WAV);
+
+    BenchDetector(cfg->detector_Kernel);
+    return EXIT_SUCCESS;
+}
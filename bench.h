@@ -0,0 +1,27 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   bench.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --bench measures what the monitor costs on this machine and prints it as CSV on stdout:
+ *      joyGetPosEx() and joyGetDevCaps() call cost of every --joystick/--watch device, in ns
+ *      achieved sample period of every timer backend at 1 and 10 ms (and --sleep if it is 100 or less), in us
+ *      AlertPost() to start of the phrase of every alert backend, in us (says "Rudder" a few times, wav follows --alert_wav and --alert_value)
+ *      detector throughput of the per-sample DetectorFeed() (closure and stat engines) and of every DetectorScan() kernel, in samples/s
+ * Lines starting with # describe the machine and the build.  Redirect to a file and diff two builds.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "config.h"
+
+/* Returns the exit code of the program */
+int BenchRun(MonitorConfig *cfg);
+
+#endif /* BENCH_H */
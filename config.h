@@ -0,0 +1,61 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   config.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Everything that comes from the command line.  ParseCommandLine() used to take one pointer per option.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "windows.h"
+#include "alert.h"
+#include "sampler.h"
+#include "watch.h"
+#include "sweep.h"
+#include "detector.h"
+#include "vjoy.h"
+#include "cores.h"
+
+typedef struct {
+    UINT joy_ID;               // --joystick, used by the default watch
+    DWORD joy_Flags;
+    UINT iterations;
+    UINT margin;               // percentage, default margin of every watch
+    UINT sleep_Time;
+    UINT fast_Sleep;           // --fast_sleep, 0: always sleep_Time
+    UINT log_Flush;            // --log_flush, most milliseconds a line waits in the log buffer
+    const char *heatmap_File;  // --heatmap, NULL: none
+    UINT heatmap_Decay;        // --heatmap_decay, half-life in hours, 0: never
+    int heatmap_Margin;        // --heatmap_margin, percentage outside of the hot zones, -1: zones not used
+    const char *trend_Store;   // --trend_store, NULL: no daily records, see trend.h
+    const char *trend_File;    // --trend, print the store and exit
+    UINT vjoy_ID;              // --vjoy, 0: no output
+    FilterKind vjoy_Filter;    // --vjoy_filter
+    CoreChoice cores;          // --cores
+    int lean;                  // --lean, see footprint.h
+    const char *games;         // --games, NULL: no game detection, see game.h
+    UINT game_Delay;           // --game_delay, tolerable delay of the sampler wakeups while a game runs
+    UINT resources_Interval;   // --resources, seconds between two measurements, 0: none
+    int etw;                   // --etw, TraceLogging provider
+    AlertBackend alert_Backend;
+    UINT alert_Gap;
+    const char *alert_Wav;     // --alert_wav, NULL: the names rendered by SAPI
+    int alert_Value;           // --alert_value
+    InputBackend input_Backend;
+    TimerKind timer_Kind;
+    WatchTable watches;
+    const char *record_File;   // --record, NULL: no recording
+    const char *replay_File;   // --replay, NULL: live
+    SweepConfig sweep;         // --sweep, used if sweep.trace_count > 0
+    DetectorKernel detector_Kernel; // --kernel, for --replay and --sweep
+    int bench;                 // --bench
+} MonitorConfig;
+
+#endif /* CONFIG_H */
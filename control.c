@@ -0,0 +1,308 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   control.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "windows.h"
+
+#include "control.h"
+#include "detector.h"
+
+extern int verbose_flag; /* main.c */
+
+static const WatchTable *watches = NULL;  // names only, the consumer owns everything else
+static HANDLE thread = NULL;
+static HANDLE quit = NULL;                // manual-reset, ControlStop()
+static HANDLE io_event = NULL;
+static HANDLE done_event = NULL;          // auto-reset, ControlDone()
+static HANDLE pipe = INVALID_HANDLE_VALUE;
+static ControlRequest * volatile pending = NULL;
+static ControlRequest request;            // control thread only while pending is NULL
+
+
+/* Waits for one overlapped operation, -1 on error or ControlStop() */
+static int Finish(BOOL ok, OVERLAPPED *ov, DWORD *bytes, DWORD timeout_ms) {
+    if (!ok && GetLastError() != ERROR_IO_PENDING) return -1;
+    if (!ok) {
+        HANDLE events[2] = { io_event, quit };
+        DWORD r = WaitForMultipleObjects(2, events, FALSE, timeout_ms);
+        if (r != WAIT_OBJECT_0) {
+            CancelIo(pipe);
+            GetOverlappedResult(pipe, ov, bytes, TRUE);
+            return -1;
+        }
+    }
+    return GetOverlappedResult(pipe, ov, bytes, FALSE) ? 0 : -1;
+}
+
+
+/* Splits line in place, "quoted words" are one token, \" and \\ inside them are unescaped.  Returns the token count */
+static int Tokens(char *line, char **tok, int max) {
+    int n = 0;
+    char *p = line;
+    while (n < max) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (*p == '\0') break;
+        if (*p == '"') {
+            char *out = ++p;
+            tok[n++] = out;
+            while (*p && *p != '"') {
+                if (*p == '\\' && (p[1] == '"' || p[1] == '\\')) p++;
+                *out++ = *p++;
+            }
+            if (*p) p++;
+            *out = '\0'; // on the closing quote, or before it when something was unescaped
+        } else {
+            tok[n++] = p;
+            while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+            if (*p) *p++ = '\0';
+        }
+    }
+    return n;
+}
+
+
+static int Watch(const char *name, ControlRequest *rq) {
+    if (name == NULL) return -1;
+    int w = WatchFind(watches, name);
+    if (w < 0) ControlReply(rq, "error: no watch '%s'", name);
+    return w < 0 ? -2 : w;
+}
+
+
+/* One command into rq->cmds, 0 when it is understood */
+static int Command(ControlRequest *rq, ControlOp op, const char *value, const char *watch) {
+    if (rq->count == CONTROL_MAX_COMMANDS) { ControlReply(rq, "error: too many commands"); return -1; }
+    ControlCommand *c = &rq->cmds[rq->count];
+    memset(c, 0, sizeof(*c));
+    c->op = op;
+    if ((c->watch = Watch(watch, rq)) == -2) return -1;
+
+    char *end = NULL;
+    switch (op) {
+        case CONTROL_MARGIN:
+        case CONTROL_SLEEP:
+            if (value == NULL) break;
+            c->value = (int)strtol(value, &end, 10);
+            if (*end || (op == CONTROL_MARGIN ? c->value < 0 || c->value > 100 : c->value < 1)) end = NULL;
+            break;
+        case CONTROL_REPEAT:
+            if (value == NULL) break;
+            c->value = (int)strtol(value, &end, 10);
+            if (strcmp(end, "ms") == 0) { c->in_ms = 1; end += 2; }
+            if (*end || c->value < 1 || (!c->in_ms && c->value > 65535)) end = NULL;
+            break;
+        case CONTROL_ENGINE:
+            if (value == NULL || (c->value = DetectorEngineFromName(value)) < 0) break;
+            end = "";
+            break;
+        case CONTROL_RECORD:
+            if (value == NULL || strlen(value) >= MAX_PATH) break;
+            strcpy(c->path, value);
+            end = "";
+            break;
+        default:
+            end = "";
+    }
+    if (end == NULL) { ControlReply(rq, "error: wrong value '%s'", value ? value : ""); return -1; }
+    rq->count++;
+    return 0;
+}
+
+
+/* The options of a second launch: the ones that can change live become commands, the rest need a restart */
+static int Arguments(ControlRequest *rq, char **tok, int n) {
+    static const struct { const char *name; char short_name; ControlOp op; } live[] = {
+        { "margin", 'm', CONTROL_MARGIN },
+        { "sleep", 's', CONTROL_SLEEP },
+        { "repeat_ms", 0, CONTROL_REPEAT },
+        { "engine", 0, CONTROL_ENGINE },
+        { "record", 0, CONTROL_RECORD },
+    };
+    for (int i = 0; i < n; i++) {
+        char *name = tok[i], *value = NULL;
+        if (name[0] != '-') continue; // the program name, or the value of an option we don't know
+        int is_long = name[1] == '-';
+        name += is_long ? 2 : 1;
+        if (is_long && (value = strchr(name, '=')) != NULL) *value++ = '\0';
+
+        int k, known = sizeof(live) / sizeof(live[0]);
+        for (k = 0; k < known; k++)
+            if (is_long ? strcmp(name, live[k].name) == 0 : name[0] == live[k].short_name && name[1] == '\0') break;
+        if (k == known) {
+            if (strcmp(name, "verbose") && strcmp(name, "brief") && strcmp(name, "joystick") && strcmp(name, "j"))
+                ControlReply(rq, "ignored: %s%s needs a restart", is_long ? "--" : "-", name);
+            continue;
+        }
+        if (value == NULL && i + 1 < n) value = tok[++i];
+        if (live[k].op == CONTROL_REPEAT) { // --repeat_ms takes milliseconds: "1500" is "1500ms"
+            char ms[24];
+            snprintf(ms, sizeof(ms), "%sms", value ? value : "");
+            if (Command(rq, CONTROL_REPEAT, ms, NULL) != 0) return -1;
+        } else if (Command(rq, live[k].op, value, NULL) != 0) return -1;
+    }
+    return 0;
+}
+
+
+/* Fills rq from one line.  Returns 0 when there is something for the consumer */
+static int Parse(ControlRequest *rq, char *line) {
+    char *tok[64];
+    int n = Tokens(line, tok, 64);
+    if (n == 0) { ControlReply(rq, "error: empty request"); return -1; }
+
+    const char *cmd = tok[0], *value = n > 1 ? tok[1] : NULL, *watch = n > 2 ? tok[2] : NULL;
+    int r;
+    if (strcmp(cmd, "stats") == 0) r = Command(rq, CONTROL_STATS, NULL, NULL);
+    else if (strcmp(cmd, "margin") == 0) r = Command(rq, CONTROL_MARGIN, value, watch);
+    else if (strcmp(cmd, "repeat") == 0) r = Command(rq, CONTROL_REPEAT, value, watch);
+    else if (strcmp(cmd, "engine") == 0) r = Command(rq, CONTROL_ENGINE, value, watch);
+    else if (strcmp(cmd, "sleep") == 0) r = Command(rq, CONTROL_SLEEP, value, NULL);
+    else if (strcmp(cmd, "record") == 0)
+        r = value && strcmp(value, "stop") == 0 ? Command(rq, CONTROL_RECORD_STOP, NULL, NULL) : Command(rq, CONTROL_RECORD, value, NULL);
+    else if (strcmp(cmd, "args") == 0) r = Arguments(rq, tok + 1, n - 1);
+    else {
+        ControlReply(rq, "error: unknown command '%s', use stats margin repeat engine sleep record args", cmd);
+        return -1;
+    }
+    if (r == 0 && rq->count == 0 && rq->errors == 0) ControlReply(rq, "ok");
+    return r == 0 && rq->count ? 0 : -1;
+}
+
+
+static DWORD WINAPI ControlThread(LPVOID param) {
+    (void)param;
+    OVERLAPPED ov;
+    char line[CONTROL_LINE];
+
+    while (WaitForSingleObject(quit, 0) != WAIT_OBJECT_0) {
+        DWORD bytes = 0;
+        memset(&ov, 0, sizeof(ov));
+        ov.hEvent = io_event;
+        BOOL ok = ConnectNamedPipe(pipe, &ov);
+        if (!ok && GetLastError() == ERROR_PIPE_CONNECTED) ok = TRUE; // connected between CreateNamedPipe() and here
+        if (Finish(ok, &ov, &bytes, INFINITE) != 0) {
+            DisconnectNamedPipe(pipe);
+            continue;
+        }
+
+        memset(&ov, 0, sizeof(ov));
+        ov.hEvent = io_event;
+        ok = ReadFile(pipe, line, sizeof(line) - 1, NULL, &ov);
+        if (Finish(ok, &ov, &bytes, CONTROL_TIMEOUT_MS) == 0) {
+            line[bytes] = '\0';
+            request.count = 0;
+            request.errors = 0;
+            request.reply_len = 0;
+            request.reply[0] = '\0';
+            if (Parse(&request, line) == 0) {
+                ResetEvent(done_event);
+                InterlockedExchangePointer((PVOID volatile *)&pending, &request);
+                HANDLE events[2] = { done_event, quit };
+                DWORD r = WaitForMultipleObjects(2, events, FALSE, CONTROL_TIMEOUT_MS);
+                // not taken yet (quiet rawinput, or the monitor is stopping): take it back, or wait for the consumer
+                if (r != WAIT_OBJECT_0 && InterlockedCompareExchangePointer((PVOID volatile *)&pending, NULL, &request) == &request)
+                    ControlReply(&request, "error: the monitor didn't take the request, try again");
+                else if (r != WAIT_OBJECT_0)
+                    WaitForSingleObject(done_event, INFINITE);
+            }
+            memset(&ov, 0, sizeof(ov));
+            ov.hEvent = io_event;
+            ok = WriteFile(pipe, request.reply, (DWORD)request.reply_len, NULL, &ov);
+            if (Finish(ok, &ov, &bytes, CONTROL_TIMEOUT_MS) == 0) FlushFileBuffers(pipe); // until the client has read it
+        }
+        DisconnectNamedPipe(pipe);
+    }
+    return 0;
+}
+
+
+int ControlStart(const WatchTable *wt) {
+    watches = wt;
+    pipe = CreateNamedPipeA(CONTROL_PIPE, PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                            PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                            1, CONTROL_REPLY, CONTROL_LINE, 0, NULL);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        printf("Could not create the control pipe, error=[%lu]\n", GetLastError());
+        return -1;
+    }
+    quit = CreateEvent(NULL, TRUE, FALSE, NULL);
+    io_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+    done_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+    thread = CreateThread(NULL, 0, ControlThread, NULL, 0, NULL);
+    if (thread == NULL) {
+        puts("Could not create the control thread");
+        ControlStop();
+        return -1;
+    }
+    if (verbose_flag) printf("Control pipe=[%s]\n", CONTROL_PIPE);
+    return 0;
+}
+
+
+ControlRequest *ControlTake(void) {
+    if (pending == NULL) return NULL; // the usual case, a plain read
+    return (ControlRequest *)InterlockedExchangePointer((PVOID volatile *)&pending, NULL);
+}
+
+
+void ControlReply(ControlRequest *rq, const char *format, ...) {
+    if (strncmp(format, "error", 5) == 0) rq->errors++; // counted even when the reply is full
+    if (rq->reply_len + 2 >= sizeof(rq->reply)) return;
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(rq->reply + rq->reply_len, sizeof(rq->reply) - rq->reply_len - 1, format, args);
+    va_end(args);
+    if (len < 0) return;
+    rq->reply_len += (size_t)len < sizeof(rq->reply) - rq->reply_len - 1 ? (size_t)len : sizeof(rq->reply) - rq->reply_len - 2;
+    rq->reply[rq->reply_len++] = '\n';
+    rq->reply[rq->reply_len] = '\0';
+}
+
+
+void ControlDone(ControlRequest *rq) {
+    (void)rq;
+    SetEvent(done_event);
+}
+
+
+HANDLE ControlThreadHandle(void) {
+    return thread;
+}
+
+
+void ControlStop(void) {
+    if (thread) {
+        SetEvent(quit);
+        WaitForSingleObject(thread, 3000);
+        CloseHandle(thread);
+        thread = NULL;
+    }
+    if (pipe != INVALID_HANDLE_VALUE) CloseHandle(pipe);
+    pipe = INVALID_HANDLE_VALUE;
+    if (quit) CloseHandle(quit);
+    if (io_event) CloseHandle(io_event);
+    if (done_event) CloseHandle(done_event);
+    quit = io_event = done_event = NULL;
+}
+
+
+int ControlSend(const char *line, char *reply, size_t size) {
+    DWORD bytes = 0;
+    if (size == 0) return -1;
+    reply[0] = '\0';
+    // one instance of the pipe: waits up to the timeout if another client is being served, fails at once without a monitor
+    if (!CallNamedPipeA(CONTROL_PIPE, (LPVOID)line, (DWORD)strlen(line), reply, (DWORD)size - 1, &bytes, CONTROL_TIMEOUT_MS))
+        return -1;
+    reply[bytes] = '\0';
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   control.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Live reconfiguration through the named pipe \\.\pipe\FanatecMonitorControl, one line per request:
+ *      stats                          samples, lost, alerts and every watch
+ *      margin <pct> [watch]           watch is a name or a number, all of them without it
+ *      repeat <n>|<n>ms [watch]
+ *      engine closure|stat [watch]
+ *      sleep <ms>                     winmm: the idle sample period
+ *      record <file.fpm> | record stop
+ *      args <command line>            the options of a second launch: --margin --sleep --repeat_ms --engine --record
+ * The reply is text, one line per command then "ok", or no "ok" when a line said "error ...".  A request
+ * with a command that can't be applied (sleep without winmm, record while recording) changes nothing.
+ * Inside "quoted words" \" is a quote and \\ a backslash.
+ *
+ * The pipe is served by a thread of its own with overlapped I/O; it parses the line into a ControlRequest
+ * and publishes it in a single pointer.  The consumer (main) thread picks it up with ControlTake() between
+ * two samples and applies every command of it at once, so the detector never sees half a change and the
+ * loop never takes a lock: a read of the pointer per sample.  The detector state and the heatmap stay.
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdarg.h>
+#include "windows.h"
+#include "watch.h"
+
+#define CONTROL_PIPE "\\\\.\\pipe\\FanatecMonitorControl"
+#define CONTROL_LINE 1024
+#define CONTROL_REPLY 4096
+#define CONTROL_MAX_COMMANDS 8
+#define CONTROL_TIMEOUT_MS 3000      // a client that doesn't send, or a consumer that doesn't answer
+
+typedef enum {
+    CONTROL_STATS = 0,
+    CONTROL_MARGIN,
+    CONTROL_REPEAT,
+    CONTROL_ENGINE,
+    CONTROL_SLEEP,
+    CONTROL_RECORD,
+    CONTROL_RECORD_STOP
+} ControlOp;
+
+typedef struct {
+    ControlOp op;
+    int watch;                 // -1: every watch
+    int value;                 // margin %, repeat, engine, sleep ms
+    int in_ms;                 // CONTROL_REPEAT: value is milliseconds
+    char path[MAX_PATH];       // CONTROL_RECORD
+} ControlCommand;
+
+typedef struct {
+    int count;
+    ControlCommand cmds[CONTROL_MAX_COMMANDS];
+    int errors;                // reply lines that start with "error"
+    size_t reply_len;
+    char reply[CONTROL_REPLY];
+} ControlRequest;
+
+/* wt is only read, for the watch names.  Returns 0 when the pipe is served */
+int  ControlStart(const WatchTable *wt);
+
+/* Consumer thread, between two samples: NULL, or a request to apply now and answer with ControlDone() */
+ControlRequest *ControlTake(void);
+
+/* Appends a line to the reply */
+void ControlReply(ControlRequest *rq, const char *format, ...);
+void ControlDone(ControlRequest *rq);
+
+void ControlStop(void);
+
+/* For --games.  NULL when it isn't running */
+HANDLE ControlThreadHandle(void);
+
+/* Client side, the second instance.  Returns 0 with the reply of the running one */
+int  ControlSend(const char *line, char *reply, size_t size);
+
+#endif /* CONTROL_H */
@@ -0,0 +1,168 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   cores.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cores.h"
+
+#define MAX_CPU_SETS 256
+#define POWER_THROTTLING_VERSION 1
+#define POWER_THROTTLING_EXECUTION_SPEED 0x1
+#define POWER_THROTTLING_IGNORE_TIMER_RESOLUTION 0x4
+#define PROCESS_POWER_THROTTLING 4 // ProcessPowerThrottling in PROCESS_INFORMATION_CLASS
+#define THREAD_POWER_THROTTLING 3  // ThreadPowerThrottling in THREAD_INFORMATION_CLASS
+
+/* SYSTEM_CPU_SET_INFORMATION and *_POWER_THROTTLING_STATE, older MinGW headers don't have them */
+typedef struct {
+    DWORD Size;
+    DWORD Type;           // 0: CpuSetInformation
+    DWORD Id;
+    WORD  Group;
+    BYTE  LogicalProcessorIndex, CoreIndex, LastLevelCacheIndex, NumaNodeIndex;
+    BYTE  EfficiencyClass;
+    BYTE  AllFlags;
+    DWORD Reserved;
+    ULONGLONG AllocationTag;
+} CpuSetEntry;
+
+typedef struct {
+    ULONG Version;
+    ULONG ControlMask;
+    ULONG StateMask;
+} PowerThrottlingState;
+
+typedef BOOL (WINAPI *GetSystemCpuSetInformationFn)(void *info, ULONG length, ULONG *returned, HANDLE process, ULONG flags);
+typedef BOOL (WINAPI *SetCpuSetsFn)(HANDLE h, const ULONG *ids, ULONG count);
+typedef BOOL (WINAPI *SetInformationFn)(HANDLE h, int info_class, void *info, DWORD size);
+
+extern int verbose_flag; /* main.c */
+
+static ULONG sampler_ids[MAX_CPU_SETS];
+static ULONG sampler_count = 0;
+static int eco_qos = 0;        // the process runs with EcoQoS, the sampler opts out
+static SetCpuSetsFn SetThreadSelectedCpuSets = NULL;
+static SetInformationFn SetThreadInformation = NULL;
+
+
+const char *CoreChoiceName(CoreChoice c) {
+    switch (c) {
+        case CORES_ANY: return "any";
+        case CORES_EFFICIENT: return "efficient";
+        case CORES_PERFORMANCE: return "performance";
+        case CORES_AUTO: return "auto";
+    }
+    return "?";
+}
+
+
+int CoreChoiceFromName(const char *name) {
+    for (int c = CORES_EFFICIENT; c <= CORES_AUTO; c++)
+        if (strcmp(name, CoreChoiceName((CoreChoice)c)) == 0) return c;
+    return -1;
+}
+
+
+/* CPU set IDs of the lowest (want_high == 0) or the highest efficiency class.  Returns the number of classes */
+static int CpuSetsOfClass(GetSystemCpuSetInformationFn GetInfo, int want_high, ULONG *ids, ULONG *count) {
+    ULONG length = 0;
+    *count = 0;
+    GetInfo(NULL, 0, &length, GetCurrentProcess(), 0); // fails with ERROR_INSUFFICIENT_BUFFER and the size
+    if (length == 0) return 0;
+    unsigned char *buf = (unsigned char *)malloc(length);
+    if (buf == NULL || !GetInfo(buf, length, &length, GetCurrentProcess(), 0)) {
+        free(buf);
+        return 0;
+    }
+
+    // EfficiencyClass doesn't need to be contiguous, count the ones that really have processors
+    unsigned char seen[256] = { 0 };
+    int lowest = 255, highest = 0, classes = 0;
+    const CpuSetEntry *e;
+    for (ULONG pos = 0; pos + sizeof(CpuSetEntry) <= length && (e = (const CpuSetEntry *)(buf + pos))->Size; pos += e->Size) {
+        if (e->Type != 0) continue;
+        if (!seen[e->EfficiencyClass]) classes++;
+        seen[e->EfficiencyClass] = 1;
+        if (e->EfficiencyClass < lowest) lowest = e->EfficiencyClass;
+        if (e->EfficiencyClass > highest) highest = e->EfficiencyClass;
+    }
+    int wanted = want_high ? highest : lowest;
+    for (ULONG pos = 0; pos + sizeof(CpuSetEntry) <= length && (e = (const CpuSetEntry *)(buf + pos))->Size; pos += e->Size)
+        if (e->Type == 0 && e->EfficiencyClass == wanted && *count < MAX_CPU_SETS) ids[(*count)++] = e->Id;
+
+    free(buf);
+    return classes;
+}
+
+
+CoreChoice CoresApply(CoreChoice choice) {
+    if (choice == CORES_ANY) return CORES_ANY;
+
+    HMODULE kernel = GetModuleHandle("kernel32.dll");
+    GetSystemCpuSetInformationFn GetInfo = (GetSystemCpuSetInformationFn)GetProcAddress(kernel, "GetSystemCpuSetInformation");
+    SetCpuSetsFn SetProcessDefaultCpuSets = (SetCpuSetsFn)GetProcAddress(kernel, "SetProcessDefaultCpuSets");
+    SetInformationFn SetProcessInformation = (SetInformationFn)GetProcAddress(kernel, "SetProcessInformation");
+    SetThreadSelectedCpuSets = (SetCpuSetsFn)GetProcAddress(kernel, "SetThreadSelectedCpuSets");
+    SetThreadInformation = (SetInformationFn)GetProcAddress(kernel, "SetThreadInformation");
+    if (!GetInfo || !SetProcessDefaultCpuSets || !SetThreadSelectedCpuSets) {
+        puts("--cores needs Windows 10 or newer, ignored");
+        return CORES_ANY;
+    }
+
+    static ULONG ids[MAX_CPU_SETS];
+    ULONG count;
+    int classes = CpuSetsOfClass(GetInfo, choice == CORES_PERFORMANCE, ids, &count);
+    if (choice == CORES_AUTO) choice = classes > 1 ? CORES_EFFICIENT : CORES_AUTO;
+
+    if (classes < 2) {
+        if (choice != CORES_AUTO)
+            printf("Only one kind of core on this CPU, --cores %s only %s\n", CoreChoiceName(choice),
+                   choice == CORES_EFFICIENT ? "turns EcoQoS on" : "does nothing");
+        count = 0;
+    }
+    if (count > 0 && !SetProcessDefaultCpuSets(GetCurrentProcess(), ids, count)) {
+        printf("SetProcessDefaultCpuSets() failed, error=[%lu]\n", GetLastError());
+        count = 0;
+    }
+    memcpy(sampler_ids, ids, sizeof(ids[0]) * count);
+    sampler_count = count;
+
+    if (choice != CORES_PERFORMANCE && SetProcessInformation) {
+        PowerThrottlingState s;
+        s.Version = POWER_THROTTLING_VERSION;
+        s.ControlMask = POWER_THROTTLING_EXECUTION_SPEED | POWER_THROTTLING_IGNORE_TIMER_RESOLUTION;
+        s.StateMask = POWER_THROTTLING_EXECUTION_SPEED; // EcoQoS on, timer resolution still honored
+        if (SetProcessInformation(GetCurrentProcess(), PROCESS_POWER_THROTTLING, &s, sizeof(s)))
+            eco_qos = 1;
+        else if (verbose_flag)
+            printf("EcoQoS not available, error=[%lu]\n", GetLastError());
+    }
+
+    if (verbose_flag)
+        printf("Cores=[%s] efficiency classes=[%d] cpu sets=[%lu] EcoQoS=[%d]\n", CoreChoiceName(choice), classes,
+               count, eco_qos);
+    return sampler_count || eco_qos ? choice : CORES_ANY;
+}
+
+
+void CoresSamplerThread(void) {
+    if (sampler_count && !SetThreadSelectedCpuSets(GetCurrentThread(), sampler_ids, sampler_count))
+        printf("SetThreadSelectedCpuSets() failed, error=[%lu]\n", GetLastError());
+
+    if (eco_qos && SetThreadInformation) {
+        PowerThrottlingState s;
+        s.Version = POWER_THROTTLING_VERSION;
+        s.ControlMask = POWER_THROTTLING_EXECUTION_SPEED;
+        s.StateMask = 0; // never throttled, the sample period must not stretch
+        SetThreadInformation(GetCurrentThread(), THREAD_POWER_THROTTLING, &s, sizeof(s));
+    }
+}
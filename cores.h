@@ -0,0 +1,47 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   cores.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --cores efficient|performance|auto places the process with CPU Sets instead of a hand made affinity mask.
+ * GetSystemCpuSetInformation() gives the EfficiencyClass of every logical processor (0 is the most
+ * efficient, hybrid CPUs like Alder Lake have two classes):
+ *      efficient    the whole process and the sampler thread on the lowest class, EcoQoS for every
+ *                   thread except the sampler
+ *      performance  the whole process on the highest class, no EcoQoS
+ *      auto         efficient on a hybrid CPU, on any other CPU only the EcoQoS part
+ * EcoQoS (PROCESS_POWER_THROTTLING_EXECUTION_SPEED) lets Windows run the alert, log and main threads
+ * slowly and on the efficient cores.  The sampler opts out of it, and the process asks Windows to keep
+ * honoring its timer resolution, so the sample period is the same as without --cores.
+ *
+ * The functions are looked up in kernel32.dll at run time: on Windows older than 10 --cores only prints
+ * that it is not available.
+ */
+
+#ifndef CORES_H
+#define CORES_H
+
+#include "platform.h"
+
+typedef enum {
+    CORES_ANY = 0,        // no --cores
+    CORES_EFFICIENT,
+    CORES_PERFORMANCE,
+    CORES_AUTO
+} CoreChoice;
+
+const char *CoreChoiceName(CoreChoice choice);
+int CoreChoiceFromName(const char *name);   // -1 if unknown
+
+/* Before the threads start.  Returns what was really applied, CORES_ANY if nothing could be */
+CoreChoice CoresApply(CoreChoice choice);
+
+/* First thing on the sampler thread, nothing to do without --cores */
+void CoresSamplerThread(void);
+
+#endif /* CORES_H */
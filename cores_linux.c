@@ -0,0 +1,123 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   cores_linux.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --cores for the Linux build, with sched_setaffinity() instead of CPU Sets.  The kinds of core come
+ * from the hybrid PMUs of the kernel (/sys/devices/cpu_atom/cpus are the efficient cores of an Intel
+ * hybrid CPU, cpu_core/cpus the performance ones) or, on other hybrid CPUs, from cpu_capacity.
+ * There is no EcoQoS: efficient and auto only pin the process.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "cores.h"
+
+extern int verbose_flag; /* main_linux.c */
+
+
+const char *CoreChoiceName(CoreChoice choice) {
+    switch (choice) {
+        case CORES_ANY: return "any";
+        case CORES_EFFICIENT: return "efficient";
+        case CORES_PERFORMANCE: return "performance";
+        case CORES_AUTO: return "auto";
+    }
+    return "?";
+}
+
+
+int CoreChoiceFromName(const char *name) {
+    for (int c = CORES_EFFICIENT; c <= CORES_AUTO; c++)
+        if (strcmp(name, CoreChoiceName((CoreChoice)c)) == 0) return c;
+    return -1;
+}
+
+
+/* "0-7,16,18-19" into set.  Returns the number of processors, 0 if the file isn't there */
+static int ReadCpuList(const char *path, cpu_set_t *set) {
+    char buf[1024];
+    FILE *f = fopen(path, "r");
+    CPU_ZERO(set);
+    if (f == NULL) return 0;
+    int ok = fgets(buf, sizeof(buf), f) != NULL;
+    fclose(f);
+    if (!ok) return 0;
+
+    for (char *p = buf; *p && *p != '\n'; ) {
+        char *end;
+        long lo = strtol(p, &end, 10), hi = lo;
+        if (end == p) break;
+        if (*end == '-') hi = strtol(end + 1, &end, 10);
+        for (long c = lo; c <= hi && c < CPU_SETSIZE; c++) CPU_SET(c, set);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return CPU_COUNT(set);
+}
+
+
+/* Processors with the lowest (want_high == 0) or the highest cpu_capacity.  Returns the number of capacities */
+static int CapacityClass(int want_high, cpu_set_t *set) {
+    int capacity[CPU_SETSIZE], lowest = 1 << 30, highest = -1, classes = 0, last = -1;
+    CPU_ZERO(set);
+    for (int c = 0; c < CPU_SETSIZE; c++) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", c);
+        FILE *f = fopen(path, "r");
+        capacity[c] = -1;
+        if (f == NULL) {
+            if (c > 0 && capacity[c - 1] < 0) break; // past the last processor
+            continue;
+        }
+        if (fscanf(f, "%d", &capacity[c]) != 1) capacity[c] = -1;
+        fclose(f);
+        if (capacity[c] < 0) continue;
+        last = c;
+        if (capacity[c] < lowest) lowest = capacity[c];
+        if (capacity[c] > highest) highest = capacity[c];
+    }
+    if (highest < 0) return 0;
+    classes = highest > lowest ? 2 : 1;
+    for (int c = 0; c <= last; c++)
+        if (capacity[c] == (want_high ? highest : lowest)) CPU_SET(c, set);
+    return classes;
+}
+
+
+CoreChoice CoresApply(CoreChoice choice) {
+    if (choice == CORES_ANY) return CORES_ANY;
+
+    cpu_set_t efficient, performance;
+    int classes = 0;
+    if (ReadCpuList("/sys/devices/cpu_atom/cpus", &efficient) && ReadCpuList("/sys/devices/cpu_core/cpus", &performance))
+        classes = 2;
+    else if ((classes = CapacityClass(0, &efficient)) > 1)
+        CapacityClass(1, &performance);
+
+    if (choice == CORES_AUTO) choice = classes > 1 ? CORES_EFFICIENT : CORES_AUTO;
+    if (classes < 2) {
+        if (choice != CORES_AUTO) printf("Only one kind of core on this CPU, --cores %s does nothing\n", CoreChoiceName(choice));
+        return CORES_ANY;
+    }
+    cpu_set_t *set = choice == CORES_PERFORMANCE ? &performance : &efficient;
+    if (sched_setaffinity(0, sizeof(*set), set) != 0) {
+        perror("sched_setaffinity() failed");
+        return CORES_ANY;
+    }
+    if (verbose_flag) printf("Cores=[%s] processors=[%d]\n", CoreChoiceName(choice), CPU_COUNT(set));
+    return choice;
+}
+
+
+void CoresSamplerThread(void) {
+    // one thread reads and detects, CoresApply() already placed it
+}
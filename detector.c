@@ -0,0 +1,318 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   detector.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Moved out of main() so --replay can use it.  No printf(), no alerts and no system calls here.
+ * The SIMD kernels use __attribute__((target)) and are picked at run time, the project flags stay the same.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "detector.h"
+
+
+/* --engine stat, run[] counts the samples off rest with the gate idle */
+static int StatStep(WatchTable *wt, int w, uint32_t axis, int gate_open, int64_t t_us, int32_t margin) {
+    int active = gate_open && axis != wt->rest[w];
+    int alert = NoiseStep(&wt->noise[w], axis, active, t_us, margin, wt->repeat[w], wt->repeat_us[w]);
+
+    if (!active || alert) wt->run[w] = 0;
+    else if (wt->run[w] < UINT16_MAX) wt->run[w]++;
+    wt->last[w] = axis;
+    return alert;
+}
+
+
+int DetectorStep(WatchTable *wt, int w, uint32_t axis, int gate_open, int64_t t_us) {
+    int closure;
+    int32_t margin = wt->margin[w];
+
+    if (wt->zoned[w]) { // outside of the hot zones the tighter margin
+        uint32_t bin = axis >> wt->zone_shift[w];
+        if (bin >= WATCH_ZONE_BINS) bin = WATCH_ZONE_BINS - 1;
+        if (!(wt->hot[w][bin >> 5] & (1u << (bin & 31)))) margin = wt->margin_cold[w];
+    }
+    if (wt->engine[w] == ENGINE_STAT) return StatStep(wt, w, axis, gate_open, t_us, margin);
+
+    // Determinar si el pedal izquierdo (clutch) esta fallando:
+    // 1. Ver que no estemos usando los pedales (el pedal derecho sin moverse)
+    // 2. Ver si se quedo trabado el pedal izquierdo en alguna posicion
+    if ( gate_open && (axis!=wt->rest[w]) ) {
+        closure = abs((int)(axis - wt->last[w]));
+        if (closure > margin) wt->run[w] = 0;
+        else if (wt->run[w] < UINT16_MAX) wt->run[w]++; // a timed repeat at 1 ms can take more than 65535 samples
+    } else
+        wt->run[w] = 0;
+
+    wt->last[w] = axis;
+    if (wt->run[w] == 0) wt->since_us[w] = t_us;
+
+    if (wt->run[w] >= wt->repeat[w] && (wt->repeat_us[w] == 0 || t_us - wt->since_us[w] >= wt->repeat_us[w])) {
+        wt->run[w] = 0; // reset count
+        wt->since_us[w] = t_us;
+        return 1;
+    }
+    return 0;
+}
+
+
+uint32_t DetectorFeed(WatchTable *wt, const FpmSample *s) {
+    uint32_t alerts = 0;
+
+    // Every watched axis of this device, contiguous in the arrays
+    int w_End = wt->first[s->device] + wt->n[s->device];
+    if (s->status != 0) { // a failed read has no values, the runs start again when the device is back
+        DetectorResetDevice(wt, s->device);
+        return 0;
+    }
+    for (int w = wt->first[s->device]; w < w_End; w++) {
+        int gate_open = wt->gate_axis[w] < 0 || s->axes[wt->gate_axis[w]] == wt->gate_rest[w];
+        if (DetectorStep(wt, w, s->axes[wt->axis[w]], gate_open, s->t_us)) alerts |= 1u << w;
+    }
+    return alerts;
+}
+
+
+void DetectorResetDevice(WatchTable *wt, int device) {
+    int w_End = wt->first[device] + wt->n[device];
+    for (int w = wt->first[device]; w < w_End; w++) {
+        wt->run[w] = 0;
+        wt->since_us[w] = 0;
+        NoiseReset(&wt->noise[w]);
+    }
+}
+
+
+void DetectorReset(WatchTable *wt) {
+    memset(wt->last, 0, sizeof(wt->last));
+    memset(wt->run, 0, sizeof(wt->run));
+    memset(wt->since_us, 0, sizeof(wt->since_us));
+    for (int w = 0; w < MAX_WATCHES; w++) NoiseReset(&wt->noise[w]);
+}
+
+
+const char *DetectorEngineName(DetectorEngine e) {
+    return e == ENGINE_STAT ? "stat" : "closure";
+}
+
+
+int DetectorEngineFromName(const char *name) {
+    if (strcmp(name, "closure") == 0) return ENGINE_CLOSURE;
+    if (strcmp(name, "stat") == 0) return ENGINE_STAT;
+    return -1;
+}
+
+
+/* Scalar rule over samples i .. end-1.  Returns where it stopped: end, or after the alert that filled alert_at */
+static inline __attribute__((always_inline)) size_t ScanRange(const DetectorRule *rule, uint32_t *last, uint32_t *run, const uint16_t *axis, const uint16_t *gate,
+                        size_t i, size_t end, uint32_t *alert_at, int max_alerts, int *count) {
+    uint32_t l = *last, r = *run;
+
+    while (i < end && *count < max_alerts) {
+        uint32_t a = axis[i];
+        int open = (gate == NULL || gate[i] == rule->gate_rest) && a != rule->rest;
+        int32_t closure = abs((int)(a - l));
+        r = (open && closure <= rule->margin) ? r + 1 : 0;
+        l = a;
+        if (r >= rule->repeat) {
+            alert_at[(*count)++] = (uint32_t)i;
+            r = 0;
+        }
+        i++;
+    }
+    *last = l;
+    *run = r;
+    return i;
+}
+
+
+/*
+ * Advances the run counter over one block of width samples starting at base, bit j of hits set when
+ * sample base+j passed the gated closure test.  Returns where it stopped: base+width, or after the alert
+ * that filled alert_at.
+ */
+static inline size_t ScanBits(uint32_t hits, int width, size_t base, uint32_t *run, uint32_t repeat,
+                              uint32_t *alert_at, int max_alerts, int *count) {
+    uint32_t full = (1u << width) - 1;
+
+    if (hits == 0) { *run = 0; return base + width; }
+    if (hits == full && *run + width < repeat) { *run += width; return base + width; }
+
+    int j = 0;
+    while (j < width) {
+        uint32_t rest = hits >> j;
+        if (rest == 0) { *run = 0; break; }
+        if (!(rest & 1)) {                       // misses
+            *run = 0;
+            j += __builtin_ctz(rest);
+            continue;
+        }
+        int ones = __builtin_ctz(~rest);         // hits, bits above width are 0
+        uint32_t need = repeat - *run;           // run < repeat between samples
+        if ((uint32_t)ones < need) { *run += ones; j += ones; continue; }
+
+        j += need;
+        alert_at[(*count)++] = (uint32_t)(base + j - 1);
+        *run = 0;
+        if (*count == max_alerts) return base + j;
+    }
+    return base + width;
+}
+
+
+/*
+ * The scalar kernel for a released pedal at the top of a 10, 12 or 16 bit range: rest and gate_rest are
+ * constants in the inlined ScanRange(), the compare is against an immediate.
+ */
+#define SCAN_SCALAR_WIDTH(bits) \
+static size_t ScanScalar##bits(const DetectorRule *rule, DetectorState *st, const uint16_t *axis, const uint16_t *gate, \
+                               size_t n, uint32_t *alert_at, int max_alerts, int *alert_count) { \
+    DetectorRule fixed = *rule; \
+    fixed.rest = fixed.gate_rest = (1u << bits) - 1; \
+    *alert_count = 0; \
+    return ScanRange(&fixed, &st->last, &st->run, axis, gate, 0, n, alert_at, max_alerts, alert_count); \
+}
+
+SCAN_SCALAR_WIDTH(10)
+SCAN_SCALAR_WIDTH(12)
+SCAN_SCALAR_WIDTH(16)
+
+
+static size_t ScanScalar(const DetectorRule *rule, DetectorState *st, const uint16_t *axis, const uint16_t *gate,
+                         size_t n, uint32_t *alert_at, int max_alerts, int *alert_count) {
+    if (rule->gate_rest == rule->rest || gate == NULL) {
+        switch (rule->rest) {
+            case 0x3FF: return ScanScalar10(rule, st, axis, gate, n, alert_at, max_alerts, alert_count);
+            case 0xFFF: return ScanScalar12(rule, st, axis, gate, n, alert_at, max_alerts, alert_count);
+            case 0xFFFF: return ScanScalar16(rule, st, axis, gate, n, alert_at, max_alerts, alert_count);
+        }
+    }
+    *alert_count = 0;
+    return ScanRange(rule, &st->last, &st->run, axis, gate, 0, n, alert_at, max_alerts, alert_count);
+}
+
+
+__attribute__((target("sse4.1")))
+static size_t ScanSSE41(const DetectorRule *rule, DetectorState *st, const uint16_t *axis, const uint16_t *gate,
+                        size_t n, uint32_t *alert_at, int max_alerts, int *alert_count) {
+    const __m128i margin = _mm_set1_epi16((short)rule->margin);
+    const __m128i rest = _mm_set1_epi16((short)rule->rest);
+    const __m128i gate_rest = _mm_set1_epi16((short)rule->gate_rest);
+    const __m128i zero = _mm_setzero_si128();
+    int count = 0;
+
+    // the first sample is compared with st->last, the others with the sample before them
+    size_t i = ScanRange(rule, &st->last, &st->run, axis, gate, 0, n < 1 ? n : 1, alert_at, max_alerts, &count);
+    if (i < 1) goto DONE;
+
+    for (; i + 8 <= n && count < max_alerts; ) {
+        __m128i cur = _mm_loadu_si128((const __m128i *)(axis + i));
+        __m128i prev = _mm_loadu_si128((const __m128i *)(axis + i - 1));
+        __m128i d = _mm_sub_epi16(_mm_max_epu16(cur, prev), _mm_min_epu16(cur, prev));
+        __m128i hit = _mm_cmpeq_epi16(_mm_min_epu16(d, margin), d);           // closure <= margin
+        if (gate) hit = _mm_and_si128(hit, _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(gate + i)), gate_rest));
+        hit = _mm_andnot_si128(_mm_cmpeq_epi16(cur, rest), hit);
+        uint32_t hits = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(hit, zero));
+
+        i = ScanBits(hits, 8, i, &st->run, rule->repeat, alert_at, max_alerts, &count);
+        st->last = axis[i - 1];
+    }
+    i = ScanRange(rule, &st->last, &st->run, axis, gate, i, n, alert_at, max_alerts, &count);
+DONE:
+    *alert_count = count;
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+static size_t ScanAVX2(const DetectorRule *rule, DetectorState *st, const uint16_t *axis, const uint16_t *gate,
+                       size_t n, uint32_t *alert_at, int max_alerts, int *alert_count) {
+    const __m256i margin = _mm256_set1_epi16((short)rule->margin);
+    const __m256i rest = _mm256_set1_epi16((short)rule->rest);
+    const __m256i gate_rest = _mm256_set1_epi16((short)rule->gate_rest);
+    int count = 0;
+
+    size_t i = ScanRange(rule, &st->last, &st->run, axis, gate, 0, n < 1 ? n : 1, alert_at, max_alerts, &count);
+    if (i < 1) goto DONE;
+
+    for (; i + 16 <= n && count < max_alerts; ) {
+        __m256i cur = _mm256_loadu_si256((const __m256i *)(axis + i));
+        __m256i prev = _mm256_loadu_si256((const __m256i *)(axis + i - 1));
+        __m256i d = _mm256_sub_epi16(_mm256_max_epu16(cur, prev), _mm256_min_epu16(cur, prev));
+        __m256i hit = _mm256_cmpeq_epi16(_mm256_min_epu16(d, margin), d);
+        if (gate) hit = _mm256_and_si256(hit, _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)(gate + i)), gate_rest));
+        hit = _mm256_andnot_si256(_mm256_cmpeq_epi16(cur, rest), hit);
+        // 16 words -> 16 bytes in order: packs works per 128 bit lane, the permute puts the two halves together
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(hit, hit), 0xD8);
+        uint32_t hits = (uint32_t)_mm256_movemask_epi8(packed) & 0xFFFF;
+
+        i = ScanBits(hits, 16, i, &st->run, rule->repeat, alert_at, max_alerts, &count);
+        st->last = axis[i - 1];
+    }
+    i = ScanRange(rule, &st->last, &st->run, axis, gate, i, n, alert_at, max_alerts, &count);
+DONE:
+    *alert_count = count;
+    return i;
+}
+
+
+typedef size_t (*ScanKernel)(const DetectorRule *, DetectorState *, const uint16_t *, const uint16_t *,
+                             size_t, uint32_t *, int, int *);
+
+static DetectorKernel kernel = KERNEL_AUTO;  // resolved by the first DetectorSetKernel()
+static ScanKernel scan = NULL;
+
+
+DetectorKernel DetectorSetKernel(DetectorKernel k) {
+    __builtin_cpu_init();
+    int avx2 = __builtin_cpu_supports("avx2");
+    int sse41 = __builtin_cpu_supports("sse4.1");
+
+    if (k == KERNEL_AUTO) k = avx2 ? KERNEL_AVX2 : sse41 ? KERNEL_SSE41 : KERNEL_SCALAR;
+    if (k == KERNEL_AVX2 && !avx2) k = KERNEL_SSE41;
+    if (k == KERNEL_SSE41 && !sse41) k = KERNEL_SCALAR;
+
+    scan = k == KERNEL_AVX2 ? ScanAVX2 : k == KERNEL_SSE41 ? ScanSSE41 : ScanScalar;
+    kernel = k;
+    return k;
+}
+
+
+const char *DetectorKernelName(DetectorKernel k) {
+    switch (k) {
+        case KERNEL_SCALAR: return "scalar";
+        case KERNEL_SSE41: return "sse4";
+        case KERNEL_AVX2: return "avx2";
+        default: return "auto";
+    }
+}
+
+
+int DetectorKernelFromName(const char *name) {
+    if (strcmp(name, "auto") == 0) return KERNEL_AUTO;
+    if (strcmp(name, "scalar") == 0) return KERNEL_SCALAR;
+    if (strcmp(name, "sse4") == 0) return KERNEL_SSE41;
+    if (strcmp(name, "avx2") == 0) return KERNEL_AVX2;
+    return -1;
+}
+
+
+size_t DetectorScan(const DetectorRule *rule, DetectorState *st, const uint16_t *axis, const uint16_t *gate,
+                    size_t n, uint32_t *alert_at, int max_alerts, int *alert_count) {
+    if (scan == NULL) DetectorSetKernel(kernel); // main() calls it before --sweep starts its threads
+
+    // 16 bit lanes: values, margin and counters must fit, and run < repeat must hold between samples
+    if (rule->margin < 0 || rule->margin > 0xFFFF || rule->rest > 0xFFFF || rule->gate_rest > 0xFFFF
+        || rule->repeat == 0 || rule->repeat > 0xFFFF || st->run >= rule->repeat || max_alerts < 1)
+        return ScanScalar(rule, st, axis, gate, n, alert_at, max_alerts, alert_count);
+
+    return scan(rule, st, axis, gate, n, alert_at, max_alerts, alert_count);
+}
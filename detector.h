@@ -0,0 +1,90 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   detector.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The stuck pedal rule, one sample at a time.  The live loop and --replay call the same function, so a
+ * recorded trace gives exactly the alerts the monitor would have given.
+ *
+ * Every watch has an engine: closure is the original rule (repeat samples in a row within the margin),
+ * stat is the streaming estimator of noise.c.  DetectorStep() picks the engine of the watch; a new one
+ * needs a DetectorEngine value, its state in WatchTable, a case there and a name below.
+ */
+
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sample.h"
+#include "watch.h"
+
+typedef enum {
+    ENGINE_CLOSURE = 0,        // --engine closure, default
+    ENGINE_STAT                // --engine stat
+} DetectorEngine;
+
+const char *DetectorEngineName(DetectorEngine engine);
+int DetectorEngineFromName(const char *name);  // -1 if unknown
+
+/*
+ * Updates last[] and run[] of every watch of s->device.
+ * Returns a mask with bit w set for every watch w that reached its repeat count (and, for a repeat in ms,
+ * stayed stuck for repeat_us since since_us[w]); run[w] is reset to 0 then.
+ * A sample with an error status resets the runs of its device and never alerts.
+ */
+uint32_t DetectorFeed(WatchTable *wt, const FpmSample *s);
+
+/* The same for watch w alone.  gate_open: no gate, or the gate axis is at gate_rest.  Returns 1 on alert */
+int DetectorStep(WatchTable *wt, int w, uint32_t axis, int gate_open, int64_t t_us);
+
+/* What a failed read does to the watches of device: the runs and the noise state start again, last[] stays.
+ * DetectorFeed() calls it, and --replay and --sweep at the same samples */
+void DetectorResetDevice(WatchTable *wt, int device);
+
+/* Clears last[] and run[], before a new replay */
+void DetectorReset(WatchTable *wt);
+
+/*
+ * Batch form of the same rule for one watch, used by --replay and --sweep: the axis and its gate axis are
+ * plain arrays of one device (gate == NULL: no gate).  Writes the index of every alert into alert_at and
+ * stops early when max_alerts are written.  Returns how many samples were consumed; call again with the rest.
+ *
+ * The SSE4.1 and AVX2 kernels compute the gated closure test of 8 or 16 samples at once and only walk the
+ * run counter bit by bit when a block is neither all misses nor all hits.  They give exactly the alerts
+ * of DetectorFeed(); rules they can't represent in 16 bits go to the scalar kernel.
+ * Closure engine, sample counts and no hot zones only: any other watch goes through DetectorStep().
+ */
+typedef struct {
+    int32_t margin;            // in axis units
+    uint32_t rest;
+    uint32_t gate_rest;
+    uint32_t repeat;
+} DetectorRule;
+
+typedef struct {
+    uint32_t last;
+    uint32_t run;
+} DetectorState;
+
+size_t DetectorScan(const DetectorRule *rule, DetectorState *st, const uint16_t *axis, const uint16_t *gate,
+                    size_t n, uint32_t *alert_at, int max_alerts, int *alert_count);
+
+typedef enum {
+    KERNEL_AUTO = 0,           // the best one this CPU supports
+    KERNEL_SCALAR,
+    KERNEL_SSE41,
+    KERNEL_AVX2
+} DetectorKernel;
+
+/* Returns the kernel that will be used, a kernel the CPU doesn't support falls back to the next one */
+DetectorKernel DetectorSetKernel(DetectorKernel kernel);
+const char *DetectorKernelName(DetectorKernel kernel);
+int DetectorKernelFromName(const char *name);  // -1 if unknown
+
+#endif /* DETECTOR_H */
@@ -0,0 +1,174 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   etw.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * TraceLogging without TraceLoggingProvider.h (the MinGW headers don't have it): the provider and the
+ * event metadata are the same self-describing blobs the macros would build, passed to EventWriteTransfer()
+ * as the first two data descriptors.  Every blob starts with its own size in a UINT16.
+ * Event: size, tags (0), name, then for every field its name and TlgIn type.  Channel 11 is the one
+ * TraceLogging events use.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "windows.h"
+#include <evntprov.h>
+
+#include "etw.h"
+
+extern int verbose_flag; /* main.c */
+
+#define TLG_CHANNEL 11
+#define TLG_IN_ANSISTRING 2
+#define TLG_IN_UINT32 8
+#define TLG_IN_INT64 9
+#define DESC_PROVIDER_METADATA 2
+#define DESC_EVENT_METADATA 1
+#define PROVIDER_SET_TRAITS 2      // EVENT_INFO_CLASS EventProviderSetTraits
+
+static const GUID FPM_PROVIDER = {0x676AFE20, 0x89F1, 0x5390, {0x7A, 0x61, 0xCC, 0x76, 0xFB, 0x9A, 0x09, 0xEC}};
+
+typedef struct {
+    USHORT size;
+    unsigned char data[160];
+} Metadata;
+
+typedef ULONG (WINAPI *EventSetInformationFn)(REGHANDLE, int, PVOID, ULONG);
+
+volatile LONG etw_on = 0;
+static REGHANDLE provider = 0;
+static Metadata provider_meta, sample_meta, alert_meta, stall_meta;
+
+
+static void MetaText(Metadata *m, const char *text) {
+    size_t len = strlen(text) + 1;
+    memcpy(m->data + m->size, text, len);
+    m->size = (USHORT)(m->size + len);
+}
+
+
+static void MetaEvent(Metadata *m, const char *name) {
+    m->size = 2;
+    m->data[m->size++] = 0; // no tags
+    MetaText(m, name);
+}
+
+
+static void MetaField(Metadata *m, const char *name, unsigned char in_type) {
+    MetaText(m, name);
+    m->data[m->size++] = in_type;
+}
+
+
+static void MetaEnd(Metadata *m) {
+    memcpy(m->data, &m->size, sizeof(m->size));
+}
+
+
+static void NTAPI EnableCallback(LPCGUID source, ULONG is_enabled, UCHAR level, ULONGLONG any, ULONGLONG all,
+                                 PEVENT_FILTER_DESCRIPTOR filter, PVOID context) {
+    (void)source; (void)any; (void)all; (void)filter; (void)context;
+    if (is_enabled == 2) return; // EVENT_CONTROL_CODE_CAPTURE_STATE, nothing to capture
+    InterlockedExchange(&etw_on, is_enabled ? (level ? level : 255) : 0);
+}
+
+
+static void Write(UCHAR level, const Metadata *meta, EVENT_DATA_DESCRIPTOR *data, ULONG count) {
+    EVENT_DESCRIPTOR desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.Channel = TLG_CHANNEL;
+    desc.Level = level;
+
+    EventDataDescCreate(&data[0], provider_meta.data, provider_meta.size);
+    data[0].Reserved = DESC_PROVIDER_METADATA;
+    EventDataDescCreate(&data[1], meta->data, meta->size);
+    data[1].Reserved = DESC_EVENT_METADATA;
+    EventWriteTransfer(provider, &desc, NULL, NULL, count, data);
+}
+
+
+int EtwRegister(void) {
+    provider_meta.size = 2;
+    MetaText(&provider_meta, "FanatecMonitor");
+    MetaEnd(&provider_meta);
+
+    MetaEvent(&sample_meta, "Sample");
+    MetaField(&sample_meta, "t_us", TLG_IN_INT64);
+    MetaField(&sample_meta, "device", TLG_IN_UINT32);
+    MetaField(&sample_meta, "status", TLG_IN_UINT32);
+    static const char *axes[FPM_AXES] = { "X", "Y", "Z", "R", "U", "V" };
+    for (int a = 0; a < FPM_AXES; a++) MetaField(&sample_meta, axes[a], TLG_IN_UINT32);
+    MetaEnd(&sample_meta);
+
+    MetaEvent(&alert_meta, "Alert");
+    MetaField(&alert_meta, "t_us", TLG_IN_INT64);
+    MetaField(&alert_meta, "name", TLG_IN_ANSISTRING);
+    MetaField(&alert_meta, "value", TLG_IN_UINT32);
+    MetaEnd(&alert_meta);
+
+    MetaEvent(&stall_meta, "Stall");
+    MetaField(&stall_meta, "t_us", TLG_IN_INT64);
+    MetaField(&stall_meta, "device", TLG_IN_UINT32);
+    MetaField(&stall_meta, "gap_us", TLG_IN_INT64);
+    MetaEnd(&stall_meta);
+
+    ULONG r = EventRegister(&FPM_PROVIDER, EnableCallback, NULL, &provider);
+    if (r != ERROR_SUCCESS) {
+        printf("Could not register the ETW provider, error=[%lu]\n", r);
+        provider = 0;
+        return -1;
+    }
+    // Windows 8+: the name of the provider for the tools that list the registered ones
+    HMODULE advapi = GetModuleHandle("advapi32.dll");
+    EventSetInformationFn set_information = advapi ? (EventSetInformationFn)(void (*)(void))GetProcAddress(advapi, "EventSetInformation") : NULL;
+    if (set_information) set_information(provider, PROVIDER_SET_TRAITS, provider_meta.data, provider_meta.size);
+
+    if (verbose_flag) puts("ETW provider FanatecMonitor {676AFE20-89F1-5390-7A61-CC76FB9A09EC} registered");
+    return 0;
+}
+
+
+void EtwSample(const FpmSample *s) {
+    if (etw_on < 5) return; // verbose level only
+    EVENT_DATA_DESCRIPTOR data[5];
+    uint32_t fields[2] = { s->device, s->status };
+    EventDataDescCreate(&data[2], &s->t_us, sizeof(s->t_us));
+    EventDataDescCreate(&data[3], fields, sizeof(fields));
+    EventDataDescCreate(&data[4], s->axes, sizeof(s->axes)); // X..V are contiguous
+    Write(5, &sample_meta, data, 5);
+}
+
+
+void EtwAlert(int64_t t_us, const char *name, uint32_t value) {
+    if (etw_on < 4) return;
+    EVENT_DATA_DESCRIPTOR data[5];
+    EventDataDescCreate(&data[2], &t_us, sizeof(t_us));
+    EventDataDescCreate(&data[3], name, (ULONG)strlen(name) + 1);
+    EventDataDescCreate(&data[4], &value, sizeof(value));
+    Write(4, &alert_meta, data, 5);
+}
+
+
+void EtwStall(int64_t t_us, int device, int64_t gap_us) {
+    if (etw_on < 3) return;
+    EVENT_DATA_DESCRIPTOR data[5];
+    uint32_t d = (uint32_t)device;
+    EventDataDescCreate(&data[2], &t_us, sizeof(t_us));
+    EventDataDescCreate(&data[3], &d, sizeof(d));
+    EventDataDescCreate(&data[4], &gap_us, sizeof(gap_us));
+    Write(3, &stall_meta, data, 5);
+}
+
+
+void EtwUnregister(void) {
+    if (provider == 0) return;
+    InterlockedExchange(&etw_on, 0);
+    EventUnregister(provider);
+    provider = 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   etw.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --etw registers the TraceLogging provider FanatecMonitor {676AFE20-89F1-5390-7A61-CC76FB9A09EC}, the
+ * GUID TraceLogging derives from the name, so the usual *FanatecMonitor syntax of the tools finds it:
+ *      wpr -start GeneralProfile ... or  tracelog -start fpm -guid *FanatecMonitor -f fpm.etl
+ * Events, to line the monitor up with the frames of the game in Windows Performance Analyzer:
+ *      Sample  t_us, device, status, X..V   sampler thread, when the sample is pushed (level 5)
+ *      Alert   t_us, name, value            consumer thread, when the alert is posted (level 4)
+ *      Stall   t_us, device, gap_us         consumer thread, two samples more than 2 periods apart (level 3)
+ *
+ * When no session listens, an event costs the test of etw_on; without --etw it is never set.
+ */
+
+#ifndef ETW_H
+#define ETW_H
+
+#include <stdint.h>
+#include "windows.h"
+#include "sample.h"
+
+extern volatile LONG etw_on;    /* a session enabled the provider */
+
+/* Returns 0 when the provider is registered */
+int  EtwRegister(void);
+
+void EtwSample(const FpmSample *s);
+void EtwAlert(int64_t t_us, const char *name, uint32_t value);
+void EtwStall(int64_t t_us, int device, int64_t gap_us);
+
+void EtwUnregister(void);
+
+#endif /* ETW_H */
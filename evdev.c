@@ -0,0 +1,274 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   evdev.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+
+#include "evdev.h"
+
+#define EVDEV_QUEUE_MASK (EVDEV_QUEUE - 1)
+#define EVDEV_MAX_BUTTONS 32
+#define INOTIFY_TAG (-1)     // epoll data of the inotify fd, the devices are 0..count-1
+
+extern int verbose_flag; /* main_linux.c */
+
+static const int abs_code[FPM_AXES] = { ABS_X, ABS_Y, ABS_Z, ABS_RZ, ABS_RX, ABS_RY };
+
+typedef struct {
+    char path[MAX_PATH];
+    char name[NAME_MAX + 1];  // of the node in /dev/input, for inotify
+    int fd;                   // -1: gone
+    int dropped;              // SYN_DROPPED seen, wait for the next SYN_REPORT and read the state again
+    int monotonic;            // EVIOCSCLOCKID worked, the event stamps are CLOCK_MONOTONIC
+    int32_t minimum[FPM_AXES];
+    FpmSample state;
+    uint16_t button_code[EVDEV_MAX_BUTTONS]; // bit i of buttons
+    int buttons;
+} EvDevice;
+
+static EvDevice dev[FPM_MAX_DEVICES];
+static int dev_count = 0;
+static int epoll_fd = -1;
+static int inotify_fd = -1;
+static int64_t start_us;
+
+static FpmSample queue[EVDEV_QUEUE];
+static unsigned queue_head = 0, queue_tail = 0;
+
+
+/* Without CLOCK_MONOTONIC the stamps are CLOCK_REALTIME, which EvdevLast() can't be compared with: the time of the read then */
+static int64_t Stamp(const EvDevice *d, const struct input_event *e) {
+    if (!d->monotonic) return PlatformMicroseconds() - start_us;
+    return (int64_t)e->input_event_sec * 1000000 + e->input_event_usec - start_us;
+}
+
+
+static void Queue(const FpmSample *s) {
+    if (queue_head - queue_tail == EVDEV_QUEUE) queue_tail++; // the oldest goes, like a full ring
+    queue[queue_head++ & EVDEV_QUEUE_MASK] = *s;
+}
+
+
+/* The state of every axis and button, at open and after SYN_DROPPED */
+static void ReadState(EvDevice *d) {
+    struct input_absinfo info;
+    for (int a = 0; a < FPM_AXES; a++)
+        if (ioctl(d->fd, EVIOCGABS(abs_code[a]), &info) == 0) d->state.axes[a] = (uint32_t)(info.value - info.minimum);
+
+    unsigned char keys[KEY_MAX / 8 + 1];
+    memset(keys, 0, sizeof(keys));
+    ioctl(d->fd, EVIOCGKEY(sizeof(keys)), keys);
+    d->state.buttons = 0;
+    for (int i = 0; i < d->buttons; i++)
+        if (keys[d->button_code[i] / 8] & (1 << (d->button_code[i] % 8))) d->state.buttons |= 1u << i;
+}
+
+
+static int OpenDevice(int i, uint32_t *axis_min, uint32_t *axis_max) {
+    EvDevice *d = &dev[i];
+    d->fd = open(d->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (d->fd < 0) return -1;
+
+    int clock = CLOCK_MONOTONIC; // the same clock as PlatformMicroseconds()
+    d->monotonic = ioctl(d->fd, EVIOCSCLOCKID, &clock) == 0;
+    if (!d->monotonic && verbose_flag) printf("%s: no EVIOCSCLOCKID, the samples are stamped when they are read\n", d->path);
+
+    // the axis values are given from 0, like winmm with the minimum of JOYCAPS
+    struct input_absinfo info;
+    for (int a = 0; a < FPM_AXES; a++) {
+        int have = ioctl(d->fd, EVIOCGABS(abs_code[a]), &info) == 0 && info.maximum > info.minimum;
+        d->minimum[a] = have ? info.minimum : 0;
+        if (axis_min) axis_min[a] = 0;
+        if (axis_max) axis_max[a] = have ? (uint32_t)(info.maximum - info.minimum) : 0;
+    }
+    unsigned char keys[KEY_MAX / 8 + 1];
+    memset(keys, 0, sizeof(keys));
+    ioctl(d->fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys);
+    d->buttons = 0;
+    for (int code = BTN_MISC; code <= KEY_MAX && d->buttons < EVDEV_MAX_BUTTONS; code++)
+        if (keys[code / 8] & (1 << (code % 8))) d->button_code[d->buttons++] = (uint16_t)code;
+
+    ReadState(d);
+    d->dropped = 0;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)i;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, d->fd, &ev);
+    return 0;
+}
+
+
+static void Gone(int i) {
+    EvDevice *d = &dev[i];
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, d->fd, NULL);
+    close(d->fd);
+    d->fd = -1;
+    FpmSample s = d->state;
+    s.t_us = PlatformMicroseconds() - start_us;
+    s.status = JOYERR_UNPLUGGED;
+    Queue(&s);
+}
+
+
+int EvdevOpen(char paths[][MAX_PATH], int count, uint32_t axis_min[][FPM_AXES], uint32_t axis_max[][FPM_AXES]) {
+    int failed = 0;
+    start_us = PlatformMicroseconds();
+    queue_head = queue_tail = 0;
+    dev_count = count;
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) return -1;
+
+    // udev creates the node of a device that comes back, and gives us access a moment later
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd >= 0 && inotify_add_watch(inotify_fd, "/dev/input", IN_CREATE | IN_ATTRIB) >= 0) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)INOTIFY_TAG;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, inotify_fd, &ev);
+    }
+
+    for (int i = 0; i < count; i++) {
+        EvDevice *d = &dev[i];
+        memset(d, 0, sizeof(*d));
+        snprintf(d->path, sizeof(d->path), "%s", paths[i]);
+        char base[MAX_PATH];
+        snprintf(base, sizeof(base), "%s", paths[i]);
+        snprintf(d->name, sizeof(d->name), "%s", basename(base));
+        d->state.device = (uint16_t)i;
+        if (OpenDevice(i, axis_min[i], axis_max[i]) != 0) {
+            printf("Could not open '%s': %s\n", d->path, strerror(errno));
+            failed = 1;
+            continue;
+        }
+        if (verbose_flag) {
+            char name[256] = "?";
+            ioctl(d->fd, EVIOCGNAME(sizeof(name)), name);
+            printf("Device %d=[%s] name=[%s] buttons=[%d]\n", i, d->path, name, d->buttons);
+        }
+    }
+    return failed ? -1 : 0;
+}
+
+
+static void ReadDevice(int i) {
+    EvDevice *d = &dev[i];
+    struct input_event events[64];
+    for (;;) {
+        ssize_t n = read(d->fd, events, sizeof(events));
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EINTR) Gone(i); // ENODEV: unplugged
+            return;
+        }
+        for (size_t k = 0; k < (size_t)n / sizeof(events[0]); k++) {
+            const struct input_event *e = &events[k];
+            if (e->type == EV_SYN && e->code == SYN_DROPPED) {
+                d->dropped = 1;
+            } else if (e->type == EV_SYN && e->code == SYN_REPORT) {
+                if (d->dropped) {
+                    ReadState(d);
+                    d->dropped = 0;
+                }
+                d->state.t_us = Stamp(d, e);
+                d->state.status = JOYERR_NOERROR;
+                Queue(&d->state);
+            } else if (d->dropped) {
+                continue;
+            } else if (e->type == EV_ABS) {
+                for (int a = 0; a < FPM_AXES; a++)
+                    if (abs_code[a] == e->code) d->state.axes[a] = (uint32_t)(e->value - d->minimum[a]);
+            } else if (e->type == EV_KEY) {
+                for (int b = 0; b < d->buttons; b++)
+                    if (d->button_code[b] == e->code) {
+                        if (e->value) d->state.buttons |= 1u << b;
+                        else d->state.buttons &= ~(1u << b);
+                    }
+            }
+        }
+        if ((size_t)n < sizeof(events)) return;
+    }
+}
+
+
+/* A node was created or its permissions changed: the devices that are gone get another try */
+static void NodesChanged(void) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(inotify_fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len) {
+            const struct inotify_event *ie = (const struct inotify_event *)p;
+            for (int i = 0; i < dev_count; i++) {
+                if (dev[i].fd >= 0 || ie->len == 0 || strcmp(ie->name, dev[i].name) != 0) continue;
+                if (OpenDevice(i, NULL, NULL) == 0) {
+                    FpmSample s = dev[i].state;
+                    s.t_us = PlatformMicroseconds() - start_us;
+                    s.status = JOYERR_NOERROR;
+                    Queue(&s);
+                }
+            }
+        }
+    }
+}
+
+
+int EvdevWait(FpmSample *s, int timeout_ms) {
+    if (queue_head == queue_tail) {
+        struct epoll_event events[FPM_MAX_DEVICES + 1];
+        int n = epoll_wait(epoll_fd, events, FPM_MAX_DEVICES + 1, timeout_ms);
+        if (n < 0) return errno == EINTR ? 0 : -1;
+        for (int k = 0; k < n; k++) {
+            int tag = (int)events[k].data.u32;
+            if (tag == INOTIFY_TAG) NodesChanged();
+            else if (dev[tag].fd >= 0) ReadDevice(tag);
+        }
+    }
+    if (queue_head == queue_tail) return 0;
+    *s = queue[queue_tail++ & EVDEV_QUEUE_MASK];
+    return 1;
+}
+
+
+int64_t EvdevNow(void) {
+    return PlatformMicroseconds() - start_us;
+}
+
+
+void EvdevLast(int device, FpmSample *s) {
+    *s = dev[device].state;
+    s->t_us = PlatformMicroseconds() - start_us;
+    s->status = dev[device].fd >= 0 ? JOYERR_NOERROR : JOYERR_UNPLUGGED;
+}
+
+
+int EvdevGone(int device) {
+    return dev[device].fd < 0;
+}
+
+
+void EvdevClose(void) {
+    for (int i = 0; i < dev_count; i++)
+        if (dev[i].fd >= 0) close(dev[i].fd);
+    if (inotify_fd >= 0) close(inotify_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+    inotify_fd = epoll_fd = -1;
+    dev_count = 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   evdev.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Linux input, the counterpart of rawinput.c: the pedals are /dev/input/eventN (joystick N, or the
+ * node a --device path points to) and every device fd, plus an inotify watch on /dev/input, is in one
+ * epoll set.  EvdevWait() sleeps in epoll_wait() until a device reports, so there is no polling interval
+ * and no wakeup at all while the pedals are quiet, except the sleep_Time repeat the detector needs.
+ * A sample is made at every SYN_REPORT with the kernel time stamp of the report (CLOCK_MONOTONIC).
+ *
+ * Axes: ABS_X, ABS_Y, ABS_Z, ABS_RZ, ABS_RX and ABS_RY are X Y Z R U V, the order winmm uses for the
+ * same HID usages.  The values are the logical ones of the device, EvdevOpen() gives their range.
+ * After SYN_DROPPED the state is read again with EVIOCGABS.  A device that goes away sends one sample
+ * with JOYERR_UNPLUGGED and is opened again when udev gives its node back (IN_CREATE or IN_ATTRIB).
+ */
+
+#ifndef EVDEV_H
+#define EVDEV_H
+
+#include <stdint.h>
+#include "platform.h"
+#include "sample.h"
+
+#define EVDEV_QUEUE 256     // samples made by one epoll_wait() and not returned yet, power of two
+
+/* Fills the range of every axis of every device, max <= min for the axes a device doesn't have.
+ * Returns 0 when every device could be opened */
+int  EvdevOpen(char paths[][MAX_PATH], int count, uint32_t axis_min[][FPM_AXES], uint32_t axis_max[][FPM_AXES]);
+
+/* 1 with a sample, 0 after timeout_ms without one, -1 on error */
+int  EvdevWait(FpmSample *s, int timeout_ms);
+
+/* Microseconds since EvdevOpen(), the clock of the samples */
+int64_t EvdevNow(void);
+
+/* The last values of device, stamped now, for the repeat of a quiet device */
+void EvdevLast(int device, FpmSample *s);
+
+/* 1 while the device is gone */
+int  EvdevGone(int device);
+
+void EvdevClose(void);
+
+#endif /* EVDEV_H */
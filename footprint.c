@@ -0,0 +1,76 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   footprint.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * HeapWalk() touches every page of the heaps, so the check only runs with the report (Ctrl+Break, the
+ * verbose report once a minute and at exit), never per sample.
+ */
+
+#include <stdio.h>
+#include "windows.h"
+#include <psapi.h>
+
+#include "footprint.h"
+
+extern int verbose_flag; /* main.c */
+
+#define MAX_HEAPS 64
+
+static HeapCount baseline;
+static int settled = 0;
+
+
+void FootprintCountHeaps(HeapCount *out) {
+    HANDLE heaps[MAX_HEAPS];
+    DWORD n = GetProcessHeaps(MAX_HEAPS, heaps);
+    if (n > MAX_HEAPS) n = MAX_HEAPS;
+
+    out->heaps = n;
+    out->blocks = out->bytes = 0;
+    for (DWORD h = 0; h < n; h++) {
+        PROCESS_HEAP_ENTRY e;
+        e.lpData = NULL;
+        if (!HeapLock(heaps[h])) continue;
+        while (HeapWalk(heaps[h], &e)) {
+            if (!(e.wFlags & PROCESS_HEAP_ENTRY_BUSY)) continue;
+            out->blocks++;
+            out->bytes += e.cbData;
+        }
+        HeapUnlock(heaps[h]);
+    }
+}
+
+
+void FootprintSettle(void) {
+    FootprintCountHeaps(&baseline);
+    settled = 1;
+    SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1); // same as EmptyWorkingSet()
+    if (verbose_flag) printf("Lean: heaps=[%lu] blocks=[%llu] bytes=[%llu] after startup, working set trimmed\n",
+                             baseline.heaps, baseline.blocks, baseline.bytes);
+}
+
+
+LONGLONG FootprintReport(void) {
+    PROCESS_MEMORY_COUNTERS_EX pmc;
+    pmc.cb = sizeof(pmc);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS *)&pmc, sizeof(pmc)))
+        printf("Footprint: working set=[%llu KB] peak=[%llu KB] private=[%llu KB]\n", (unsigned long long)pmc.WorkingSetSize / 1024,
+               (unsigned long long)pmc.PeakWorkingSetSize / 1024, (unsigned long long)pmc.PrivateUsage / 1024);
+    if (!settled) return 0;
+
+    HeapCount now;
+    FootprintCountHeaps(&now);
+    LONGLONG grown = (LONGLONG)now.blocks - (LONGLONG)baseline.blocks;
+    if (grown > 0)
+        printf("Heap check VIOLATION: %lld blocks (%lld bytes) allocated since startup, heaps=[%lu]\n", grown,
+               (long long)now.bytes - (long long)baseline.bytes, now.heaps);
+    else
+        printf("Heap check: no allocation since startup, blocks=[%llu] bytes=[%llu]\n", now.blocks, now.bytes);
+    return grown;
+}
@@ -0,0 +1,41 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   footprint.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --lean, for the 25 hour runs next to a sim: once everything is initialized the monitor doesn't allocate
+ * anymore.  The ring, the histograms, the log buffers and the alert queue are static, the alert clips and
+ * the recorder buffers are allocated at startup, and alerts are the preloaded --alert wav clips instead of a
+ * powershell.exe per alert.  FootprintSettle() then gives the pages back to Windows with
+ * SetProcessWorkingSetSize(-1, -1), and remembers how many heap blocks the process has.
+ *
+ * The check counts the busy blocks of every heap of the process with HeapWalk(): the CRT heap and the
+ * ones of winmm, SAPI and the other DLLs.  More blocks than after startup is reported as a violation,
+ * it is the net count, an allocation that was freed again is not seen.
+ */
+
+#ifndef FOOTPRINT_H
+#define FOOTPRINT_H
+
+#include "windows.h"
+
+typedef struct {
+    DWORD heaps;
+    ULONGLONG blocks;     // busy entries
+    ULONGLONG bytes;
+} HeapCount;
+
+void FootprintCountHeaps(HeapCount *out);
+
+/* When the initialization is over: baseline of the heaps and working set trimmed */
+void FootprintSettle(void);
+
+/* Working set, private bytes and the heap check.  Returns the blocks allocated since FootprintSettle() */
+LONGLONG FootprintReport(void);
+
+#endif /* FOOTPRINT_H */
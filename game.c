@@ -0,0 +1,111 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   game.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The process of the foreground window is only opened again when the window changes.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "windows.h"
+#include <shellapi.h>
+
+#include "game.h"
+
+static char names[GAME_MAX][MAX_PATH];
+static int name_count = 0;
+static int fullscreen = 0;        // "fullscreen" was in the list
+
+static ULONGLONG next_poll = 0;
+static HWND last_window = NULL;
+static int active = 0;
+static int by_fullscreen = 0;     // active because of "fullscreen", the window is looked at again after it
+static char current[MAX_PATH] = "";
+
+
+int GameInit(const char *list) {
+    name_count = fullscreen = 0;
+    while (list && *list) {
+        const char *end = strchr(list, ',');
+        size_t len = end ? (size_t)(end - list) : strlen(list);
+        if (len > 0 && len < MAX_PATH) {
+            if (len == 10 && _strnicmp(list, "fullscreen", 10) == 0)
+                fullscreen = 1;
+            else if (name_count < GAME_MAX) {
+                memcpy(names[name_count], list, len);
+                names[name_count][len] = '\0';
+                name_count++;
+            } else
+                printf("--games: only %d names, '%.*s' ignored\n", GAME_MAX, (int)len, list);
+        }
+        list = end ? end + 1 : NULL;
+    }
+    next_poll = 0;
+    last_window = NULL;
+    active = by_fullscreen = 0;
+    current[0] = '\0';
+    return name_count + fullscreen;
+}
+
+
+/* Exe name of the process that owns hwnd, without the path */
+static int WindowExe(HWND hwnd, char *exe, DWORD size) {
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hwnd, &pid);
+    HANDLE p = pid ? OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid) : NULL;
+    if (p == NULL) return 0;
+
+    char path[MAX_PATH];
+    DWORD len = MAX_PATH;
+    BOOL ok = QueryFullProcessImageNameA(p, 0, path, &len);
+    CloseHandle(p);
+    if (!ok) return 0;
+
+    const char *slash = strrchr(path, '\\');
+    snprintf(exe, size, "%s", slash ? slash + 1 : path);
+    return 1;
+}
+
+
+int GamePoll(void) {
+    ULONGLONG now = GetTickCount64();
+    if (now < next_poll) return active;
+    next_poll = now + GAME_POLL_MS;
+
+    if (fullscreen) {
+        QUERY_USER_NOTIFICATION_STATE state;
+        if (SHQueryUserNotificationState(&state) == S_OK && state == QUNS_RUNNING_D3D_FULL_SCREEN) {
+            snprintf(current, sizeof(current), "fullscreen");
+            by_fullscreen = 1;
+            return active = 1;
+        }
+    }
+
+    HWND hwnd = GetForegroundWindow();
+    if (hwnd == last_window && !by_fullscreen) return active;
+    last_window = hwnd;
+    by_fullscreen = 0;
+
+    char exe[MAX_PATH];
+    active = 0;
+    current[0] = '\0';
+    if (hwnd == NULL || !WindowExe(hwnd, exe, sizeof(exe))) return 0;
+    for (int k = 0; k < name_count; k++)
+        if (_stricmp(exe, names[k]) == 0) {
+            snprintf(current, sizeof(current), "%s", exe);
+            active = 1;
+            break;
+        }
+    return active;
+}
+
+
+const char *GameName(void) {
+    return current;
+}
@@ -0,0 +1,36 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   game.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --games DCS.exe,Il-2.exe,fullscreen: is one of these games in the foreground?  The exe of the foreground
+ * window is compared with the list (case insensitive, without the path); "fullscreen" matches any
+ * program running Direct3D in exclusive fullscreen (SHQueryUserNotificationState()).
+ *
+ * While one is, the monitor gets out of its way: the sampler waits with a tolerable delay so Windows can
+ * coalesce its wakeups with the ones of the game, the consumer and log threads run at a lower priority,
+ * the log is flushed less often and the heatmap checkpoints wait until the game goes to the background.
+ * The sampler and the alert thread keep their priority, an alert is exactly when it matters.
+ */
+
+#ifndef GAME_H
+#define GAME_H
+
+#define GAME_MAX 16
+#define GAME_POLL_MS 1000     // GetForegroundWindow() at most this often
+
+/* Comma separated list.  Returns the number of names, 0 if the list is empty */
+int GameInit(const char *list);
+
+/* Returns 1 while a game of the list is in the foreground.  Cheap, call it as often as you like */
+int GamePoll(void);
+
+/* The exe that matched, "" if none */
+const char *GameName(void);
+
+#endif /* GAME_H */
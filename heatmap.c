@@ -0,0 +1,297 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   heatmap.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "windows.h"
+
+#include "heatmap.h"
+#include "timer.h"
+
+#define HEAT_HEADER 64
+#define HEAT_MAX_ZONES 8
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t bins;
+    uint32_t slots;
+    int64_t created_unix_us;
+    int64_t updated_unix_us;
+    uint64_t samples;
+    uint8_t reserved[24];
+} HeatHeader;
+
+typedef struct {
+    uint32_t used;
+    uint32_t joy_ID;
+    uint8_t axis;
+    uint8_t shift;
+    uint16_t reserved1;
+    uint32_t reserved2;
+    char name[WATCH_NAME_SIZE];
+    HeatBin bins[WATCH_ZONE_BINS];
+} HeatSlot;
+
+typedef struct {
+    int first, last;
+    uint64_t hits, alerts, dwell_us;
+} HeatZone;
+
+extern int verbose_flag; /* main.c */
+
+static HANDLE file = INVALID_HANDLE_VALUE;
+static HANDLE mapping = NULL;
+static HeatHeader *header = NULL;
+static HeatSlot *slots = NULL;
+static int writable = 0;
+static int cold_margin = -1;        // percentage, -1: zones not used by the detector
+static double half_life_us = 0;     // 0: no decay
+
+static HeatSlot *slot_of[MAX_WATCHES];
+static int dirty_lo[MAX_WATCHES], dirty_hi[MAX_WATCHES]; // bins changed since the last checkpoint, lo > hi: none
+static int64_t last_t[FPM_MAX_DEVICES];
+static int64_t last_decay_us = 0;
+
+
+/* 10-bit values go as they are, anything wider is cut to 10 bits */
+static uint8_t ShiftFor(uint32_t rest) {
+    int bits = 0;
+    while (bits < 32 && (rest >> bits)) bits++;
+    return (uint8_t)(bits > 10 ? bits - 10 : 0);
+}
+
+
+static HeatSlot *FindSlot(const WatchTable *wt, int w) {
+    HeatSlot *free_Slot = NULL;
+    for (int i = 0; i < HEAT_SLOTS; i++) {
+        HeatSlot *sl = &slots[i];
+        if (!sl->used) {
+            if (free_Slot == NULL) free_Slot = sl;
+            continue;
+        }
+        if (sl->joy_ID == wt->joy_ID[wt->device[w]] && sl->axis == wt->axis[w]
+            && strncmp(sl->name, wt->specs[w].name, WATCH_NAME_SIZE) == 0) return sl;
+    }
+    if (free_Slot == NULL || !writable) return NULL;
+
+    memset(free_Slot, 0, sizeof(*free_Slot));
+    free_Slot->used = 1;
+    free_Slot->joy_ID = wt->joy_ID[wt->device[w]];
+    free_Slot->axis = wt->axis[w];
+    free_Slot->shift = ShiftFor(wt->rest[w]);
+    strncpy(free_Slot->name, wt->specs[w].name, WATCH_NAME_SIZE - 1);
+    return free_Slot;
+}
+
+
+/* Hot bins of one slot into the detector mask of watch w */
+static void Zones(WatchTable *wt, int w) {
+    const HeatSlot *sl = slot_of[w];
+    memset(wt->hot[w], 0, sizeof(wt->hot[w]));
+    wt->zoned[w] = 0;
+    if (sl == NULL || cold_margin < 0) return;
+
+    uint64_t total = 0;
+    for (int b = 0; b < WATCH_ZONE_BINS; b++) total += sl->bins[b].hits;
+    if (total < HEAT_MIN_TOTAL) return;
+
+    for (int b = 0; b < WATCH_ZONE_BINS; b++) {
+        uint64_t h = sl->bins[b].hits;
+        if (h < HEAT_MIN_HITS || h * WATCH_ZONE_BINS < total * 4) continue;
+        int lo = b - HEAT_WIDEN < 0 ? 0 : b - HEAT_WIDEN;
+        int hi = b + HEAT_WIDEN >= WATCH_ZONE_BINS ? WATCH_ZONE_BINS - 1 : b + HEAT_WIDEN;
+        for (int k = lo; k <= hi; k++) wt->hot[w][k >> 5] |= 1u << (k & 31);
+    }
+    wt->zone_shift[w] = sl->shift;
+    wt->cold_pct[w] = (uint8_t)cold_margin;
+    wt->margin_cold[w] = (int32_t)((uint64_t)(wt->rest[w] - wt->axis_min[w]) * wt->cold_pct[w] / 100);
+    wt->zoned[w] = 1;
+}
+
+
+int HeatmapOpen(const char *path, WatchTable *wt, UINT decay_hours, int cold_margin_pct, int read_only) {
+    size_t size = HEAT_HEADER + sizeof(HeatSlot) * HEAT_SLOTS;
+
+    writable = !read_only;
+    cold_margin = cold_margin_pct;
+    half_life_us = decay_hours ? (double)decay_hours * 3600e6 : 0;
+
+    // --replay can read the file while the monitor has it open
+    file = CreateFile(path, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                      writable ? FILE_SHARE_READ : FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                      writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        printf("Could not open the heatmap '%s', error=[%lu]\n", path, GetLastError());
+        return -1;
+    }
+    LARGE_INTEGER old_Size;
+    if (!GetFileSizeEx(file, &old_Size) || (old_Size.QuadPart != 0 && old_Size.QuadPart != (LONGLONG)size)
+        || (read_only && old_Size.QuadPart == 0)) {
+        printf("'%s' is not a heatmap of this version\n", path);
+        goto BAD;
+    }
+    // a mapping bigger than the file grows it, with zeros
+    mapping = CreateFileMapping(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, (DWORD)size, NULL);
+    if (mapping == NULL) goto BAD;
+    header = (HeatHeader *)MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+    if (header == NULL) goto BAD;
+    slots = (HeatSlot *)((char *)header + HEAT_HEADER);
+
+    if (old_Size.QuadPart == 0) {
+        memcpy(header->magic, "FPH1", 4);
+        header->version = HEAT_VERSION;
+        header->bins = WATCH_ZONE_BINS;
+        header->slots = HEAT_SLOTS;
+        header->created_unix_us = UnixMicrosecondsNow();
+    } else if (memcmp(header->magic, "FPH1", 4) != 0 || header->version != HEAT_VERSION
+               || header->bins != WATCH_ZONE_BINS || header->slots != HEAT_SLOTS) {
+        printf("'%s' is not a heatmap of this version\n", path);
+        goto BAD;
+    }
+
+    for (int w = 0; w < wt->count; w++) {
+        slot_of[w] = FindSlot(wt, w);
+        dirty_lo[w] = WATCH_ZONE_BINS;
+        dirty_hi[w] = -1;
+        if (slot_of[w] == NULL && verbose_flag) printf("Heatmap: no slot for watch %s\n", wt->specs[w].name);
+        Zones(wt, w);
+    }
+    WatchPublish(wt);
+    for (int d = 0; d < FPM_MAX_DEVICES; d++) last_t[d] = -1;
+    last_decay_us = UnixMicrosecondsNow();
+    return 0;
+
+BAD:
+    HeatmapClose();
+    return -1;
+}
+
+
+void HeatmapUpdate(const WatchTable *wt, const FpmSample *s, uint32_t alerts) {
+    if (slots == NULL || !writable) return;
+
+    int64_t dt = last_t[s->device] >= 0 ? s->t_us - last_t[s->device] : 0;
+    last_t[s->device] = s->t_us;
+
+    int w_End = wt->first[s->device] + wt->n[s->device];
+    for (int w = wt->first[s->device]; w < w_End; w++) {
+        int alert = (alerts >> w) & 1;
+        if ((wt->run[w] == 0 && !alert) || slot_of[w] == NULL) continue;
+
+        HeatSlot *sl = slot_of[w];
+        uint32_t b = s->axes[wt->axis[w]] >> sl->shift;
+        if (b >= WATCH_ZONE_BINS) b = WATCH_ZONE_BINS - 1;
+        sl->bins[b].hits++;
+        sl->bins[b].alerts += alert;
+        sl->bins[b].dwell_us += (uint64_t)dt;
+        if ((int)b < dirty_lo[w]) dirty_lo[w] = b;
+        if ((int)b > dirty_hi[w]) dirty_hi[w] = b;
+    }
+}
+
+
+static void Decay(double factor) {
+    for (int i = 0; i < HEAT_SLOTS; i++) {
+        if (!slots[i].used) continue;
+        for (int b = 0; b < WATCH_ZONE_BINS; b++) {
+            HeatBin *hb = &slots[i].bins[b];
+            hb->hits = (uint32_t)(hb->hits * factor);
+            hb->alerts = (uint32_t)(hb->alerts * factor);
+            hb->dwell_us = (uint64_t)(hb->dwell_us * factor);
+        }
+    }
+}
+
+
+void HeatmapCheckpoint(WatchTable *wt) {
+    if (slots == NULL) return;
+
+    if (writable) {
+        int64_t now = UnixMicrosecondsNow();
+        int decayed = 0;
+        if (half_life_us > 0 && now > last_decay_us) {
+            Decay(pow(0.5, (double)(now - last_decay_us) / half_life_us));
+            last_decay_us = now;
+            decayed = 1;
+        }
+        header->updated_unix_us = now;
+        FlushViewOfFile(header, HEAT_HEADER);
+
+        for (int w = 0; w < wt->count; w++) {
+            if (slot_of[w] == NULL) continue;
+            if (decayed) FlushViewOfFile(slot_of[w], sizeof(HeatSlot));
+            else if (dirty_lo[w] <= dirty_hi[w])
+                FlushViewOfFile(&slot_of[w]->bins[dirty_lo[w]], sizeof(HeatBin) * (size_t)(dirty_hi[w] - dirty_lo[w] + 1));
+            dirty_lo[w] = WATCH_ZONE_BINS;
+            dirty_hi[w] = -1;
+        }
+    }
+    for (int w = 0; w < wt->count; w++) Zones(wt, w);
+    WatchPublish(wt); // the sampler keeps the old zones until here
+}
+
+
+static int CompareZones(const void *a, const void *b) {
+    const HeatZone *x = (const HeatZone *)a, *y = (const HeatZone *)b;
+    return x->hits < y->hits ? 1 : x->hits > y->hits ? -1 : 0;
+}
+
+
+void HeatmapReport(const WatchTable *wt) {
+    if (slots == NULL) return;
+
+    for (int w = 0; w < wt->count; w++) {
+        const HeatSlot *sl = slot_of[w];
+        if (sl == NULL) continue;
+
+        uint64_t total = 0;
+        for (int b = 0; b < WATCH_ZONE_BINS; b++) total += sl->bins[b].hits;
+
+        // runs of bins with at least 4 times the average, the same test as the detector zones but not widened
+        HeatZone zones[WATCH_ZONE_BINS / 2];
+        int n = 0;
+        for (int b = 0; b < WATCH_ZONE_BINS; b++) {
+            uint64_t h = sl->bins[b].hits;
+            if (h < HEAT_MIN_HITS || h * WATCH_ZONE_BINS < total * 4) continue;
+            if (n && zones[n - 1].last == b - 1) zones[n - 1].last = b;
+            else if (n < WATCH_ZONE_BINS / 2) zones[n++] = (HeatZone){ b, b, 0, 0, 0 };
+            else continue;
+            zones[n - 1].hits += h;
+            zones[n - 1].alerts += sl->bins[b].alerts;
+            zones[n - 1].dwell_us += sl->bins[b].dwell_us;
+        }
+        qsort(zones, n, sizeof(zones[0]), CompareZones);
+
+        printf("Heatmap %s: stuck samples=[%llu] hot zones=[%d]%s\n", wt->specs[w].name, (unsigned long long)total, n,
+               wt->zoned[w] ? " (used by the detector)" : "");
+        for (int i = 0; i < n && i < HEAT_MAX_ZONES; i++)
+            printf("    %u-%u: hits=[%llu] alerts=[%llu] dwell=[%.1f s]\n",
+                   (unsigned)zones[i].first << sl->shift, (((unsigned)zones[i].last + 1) << sl->shift) - 1,
+                   (unsigned long long)zones[i].hits, (unsigned long long)zones[i].alerts, zones[i].dwell_us / 1e6);
+    }
+}
+
+
+void HeatmapClose(void) {
+    if (header) {
+        if (writable) FlushViewOfFile(header, 0);
+        UnmapViewOfFile(header);
+    }
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    header = NULL;
+    slots = NULL;
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+}
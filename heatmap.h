@@ -0,0 +1,64 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   heatmap.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Where in the travel the pedal gets stuck (--heatmap file.fph).  Every watch has WATCH_ZONE_BINS bins by
+ * axis position (the value itself for 10-bit data, value >> 6 for 16-bit raw data) that count the samples
+ * of stuck runs, their dwell time and the alerts.  The counters live in a memory mapped file, so they
+ * survive restarts and a crash loses at most the last checkpoint; HeatmapCheckpoint() only flushes the
+ * pages that changed.  --heatmap_decay halves the counters every that many hours, old noise fades out.
+ *
+ * Bins with at least 4 times the average hits (and HEAT_MIN_HITS) are hot, widened by HEAT_WIDEN bins
+ * on each side.  With --heatmap_margin the detector uses its normal margin inside the hot zones and the
+ * tighter --heatmap_margin everywhere else: a pedal that is held still on purpose outside the worn
+ * area no longer alerts.  It is one bit test per sample, see DetectorStep().
+ *
+ * File, little endian: "FPH1", u32 version, u32 bins, u32 slots, i64 created and i64 updated (us since 1970),
+ * u64 samples, 24 bytes 0; then HEAT_SLOTS * { u32 used, u32 joy_ID, u8 axis, u8 shift, u16 0, u32 0,
+ * char name[24], bins * { u32 hits, u32 alerts, u64 dwell_us } }.  A watch finds its slot by joystick,
+ * axis and name, a new one takes a free slot.
+ */
+
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <stdint.h>
+#include "watch.h"
+
+#define HEAT_VERSION 1
+#define HEAT_SLOTS MAX_WATCHES
+#define HEAT_MIN_HITS 20
+#define HEAT_MIN_TOTAL 500          // stuck samples a watch needs before its zones are used
+#define HEAT_WIDEN 2
+
+typedef struct {
+    uint32_t hits;                  // samples of stuck runs at this position
+    uint32_t alerts;
+    uint64_t dwell_us;
+} HeatBin;
+
+/*
+ * Maps the file, creating it if needed, and finds the slot of every watch.  cold_margin_pct >= 0 turns the
+ * hot zones on in the detector.  read_only (--replay) uses the zones without changing the file.
+ * Returns 0 on success.
+ */
+int  HeatmapOpen(const char *path, WatchTable *wt, UINT decay_hours, int cold_margin_pct, int read_only);
+
+/* After DetectorFeed(), a few increments in one or two cache lines per watch of the device */
+void HeatmapUpdate(const WatchTable *wt, const FpmSample *s, uint32_t alerts);
+
+/* Once a minute: decay, flush the changed pages and compute the hot zones again */
+void HeatmapCheckpoint(WatchTable *wt);
+
+/* Hot zones of every watch, hottest first */
+void HeatmapReport(const WatchTable *wt);
+
+void HeatmapClose(void);
+
+#endif /* HEATMAP_H */
@@ -0,0 +1,100 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   hist.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "hist.h"
+
+#define SUB_COUNT (1u << HIST_SUB_BITS)
+
+
+static unsigned BucketIndex(uint64_t v) {
+    if (v < SUB_COUNT) return (unsigned)v;
+
+    unsigned e = 63 - (unsigned)__builtin_clzll(v); // position of the highest bit, >= HIST_SUB_BITS
+    if (e >= HIST_MAX_BITS) return HIST_BUCKETS - 1;
+
+    unsigned shift = e - HIST_SUB_BITS;
+    return ((shift + 1) << HIST_SUB_BITS) + (unsigned)((v >> shift) - SUB_COUNT);
+}
+
+
+/* Smallest value that goes to bucket i, and the width of the bucket */
+static uint64_t BucketLow(unsigned i, uint64_t *width) {
+    if (i < SUB_COUNT) { *width = 1; return i; }
+
+    unsigned shift = (i >> HIST_SUB_BITS) - 1;
+    *width = (uint64_t)1 << shift;
+    return ((uint64_t)(i & (SUB_COUNT - 1)) + SUB_COUNT) << shift;
+}
+
+
+void HistReset(Histogram *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+
+void HistAdd(Histogram *h, uint64_t value) {
+    h->buckets[BucketIndex(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+}
+
+
+uint64_t HistPercentile(const Histogram *h, double p) {
+    if (h->count == 0) return 0;
+    if (p <= 0) return h->min;
+    if (p >= 100) return h->max;
+
+    uint64_t rank = (uint64_t)(p * (double)h->count / 100.0);
+    if (rank >= h->count) rank = h->count - 1;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen > rank) {
+            uint64_t width;
+            uint64_t v = BucketLow(i, &width) + width / 2;
+            // the exact extremes are known, don't report something outside of them
+            if (v < h->min) v = h->min;
+            if (v > h->max) v = h->max;
+            return v;
+        }
+    }
+    return h->max;
+}
+
+
+void HistPrint(const Histogram *h, const char *name, const char *unit) {
+    if (h->count == 0) {
+        printf("%s: n=0\n", name);
+        return;
+    }
+    printf("%s: n=%" PRIu64 " min=%" PRIu64 " p50=%" PRIu64 " p90=%" PRIu64 " p99=%" PRIu64 " max=%" PRIu64 " mean=%" PRIu64 " %s\n",
+           name, h->count, h->min, HistPercentile(h, 50), HistPercentile(h, 90), HistPercentile(h, 99), h->max,
+           h->sum / h->count, unit);
+}
+
+
+void HistWriteCsv(FILE *f, const Histogram *h, const char *name, const char *unit) {
+    if (h->count == 0) {
+        fprintf(f, "%s,%s,0,,,,,,\n", name, unit);
+        return;
+    }
+    fprintf(f, "%s,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+            name, unit, h->count, h->min, HistPercentile(h, 50), HistPercentile(h, 90), HistPercentile(h, 99), h->max,
+            h->sum / h->count);
+}
@@ -0,0 +1,48 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   hist.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Fixed memory log-linear histogram, in the style of HdrHistogram.
+ * Every power of two is split in 2^HIST_SUB_BITS linear buckets, so a percentile is off by at most
+ * 1/2^HIST_SUB_BITS (6.25%) of the value.  HistAdd() is O(1) and never allocates.
+ * min, max, count and sum are exact.
+ */
+
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define HIST_SUB_BITS 4
+#define HIST_MAX_BITS 40  // values >= 2^40 (12 days in microseconds) go to the last bucket
+#define HIST_BUCKETS  ((HIST_MAX_BITS - HIST_SUB_BITS + 1) << HIST_SUB_BITS)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[HIST_BUCKETS];
+} Histogram;
+
+void HistReset(Histogram *h);
+void HistAdd(Histogram *h, uint64_t value);
+
+/* p from 0 to 100.  Returns the middle of the bucket that holds the value, 0 if the histogram is empty */
+uint64_t HistPercentile(const Histogram *h, double p);
+
+/* One line: name n= min= p50= p90= p99= max= mean= unit */
+void HistPrint(const Histogram *h, const char *name, const char *unit);
+
+/* One CSV row with the columns of HIST_CSV_HEADER, for --bench */
+#define HIST_CSV_HEADER "name,unit,n,min,p50,p90,p99,max,mean"
+void HistWriteCsv(FILE *f, const Histogram *h, const char *name, const char *unit);
+
+#endif /* HIST_H */
@@ -0,0 +1,129 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   hotplug.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "windows.h"
+#include <dbt.h>
+
+#include "hotplug.h"
+
+extern int verbose_flag; /* main.c */
+
+/* Local copy of GUID_DEVINTERFACE_HID, so we don't depend on hid.lib exporting it */
+static const GUID FPM_GUID_DEVINTERFACE_HID = {0x4D1E55B2, 0xF16F, 0x11CF, {0x88, 0xCB, 0x00, 0x11, 0x11, 0x00, 0x00, 0x30}};
+
+static HANDLE thread = NULL;
+static DWORD thread_ID = 0;
+static HANDLE ready = NULL;
+static HANDLE changed = NULL;
+static HWND hwnd = NULL;
+static HDEVNOTIFY notify = NULL;
+static volatile LONG changes = 0;
+static int start_failed = 0;
+static DWORD start_error = 0;   // GetLastError() of the hot-plug thread, the main thread has its own
+
+
+static LRESULT CALLBACK HotplugWndProc(HWND h, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (msg == WM_DEVICECHANGE && (wParam == DBT_DEVICEARRIVAL || wParam == DBT_DEVICEREMOVECOMPLETE)) {
+        InterlockedIncrement(&changes);
+        SetEvent(changed);
+        return TRUE;
+    }
+    return DefWindowProc(h, msg, wParam, lParam);
+}
+
+
+static DWORD WINAPI HotplugThread(LPVOID param) {
+    (void)param;
+    HINSTANCE hInstance = GetModuleHandle(NULL);
+    WNDCLASSEX wc;
+    memset(&wc, 0, sizeof(wc));
+    wc.cbSize = sizeof(wc);
+    wc.lpfnWndProc = HotplugWndProc;
+    wc.hInstance = hInstance;
+    wc.lpszClassName = "FanatecMonitorHotplug";
+    RegisterClassEx(&wc);
+
+    hwnd = CreateWindowEx(0, wc.lpszClassName, "", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, hInstance, NULL);
+    if (hwnd) {
+        DEV_BROADCAST_DEVICEINTERFACE filter;
+        memset(&filter, 0, sizeof(filter));
+        filter.dbcc_size = sizeof(filter);
+        filter.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
+        filter.dbcc_classguid = FPM_GUID_DEVINTERFACE_HID;
+        notify = RegisterDeviceNotification(hwnd, &filter, DEVICE_NOTIFY_WINDOW_HANDLE);
+    }
+    if (notify == NULL) {
+        start_error = GetLastError();
+        if (hwnd) DestroyWindow(hwnd);
+        hwnd = NULL;
+        start_failed = 1;
+        SetEvent(ready);
+        return 1;
+    }
+    SetEvent(ready);
+
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0) > 0) DispatchMessage(&msg); // WM_QUIT from HotplugStop()
+
+    UnregisterDeviceNotification(notify);
+    notify = NULL;
+    DestroyWindow(hwnd);
+    hwnd = NULL;
+    return 0;
+}
+
+
+int HotplugStart(void) {
+    start_failed = 0;
+    start_error = 0;
+    changed = CreateEvent(NULL, FALSE, FALSE, NULL);
+    ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+    thread = CreateThread(NULL, 0, HotplugThread, NULL, 0, &thread_ID);
+    if (thread == NULL) {
+        puts("Could not create the hot-plug thread");
+        return -1;
+    }
+    WaitForSingleObject(ready, INFINITE);
+    if (start_failed) {
+        printf("Could not register for device notifications, error=[%lu]\n", start_error);
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+        CloseHandle(changed);
+        CloseHandle(ready);
+        thread = NULL;
+        return -1;
+    }
+    if (verbose_flag) puts("Hot-plug notifications registered");
+    return 0;
+}
+
+
+LONG HotplugChanges(void) {
+    return changes;
+}
+
+
+HANDLE HotplugEvent(void) {
+    return thread ? changed : NULL;
+}
+
+
+void HotplugStop(void) {
+    if (thread == NULL) return;
+    PostThreadMessage(thread_ID, WM_QUIT, 0, 0);
+    WaitForSingleObject(thread, 3000);
+    CloseHandle(thread);
+    CloseHandle(changed);
+    CloseHandle(ready);
+    thread = NULL;
+}
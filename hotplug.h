@@ -0,0 +1,34 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   hotplug.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * WM_DEVICECHANGE for HID devices, on a thread of its own with a message-only window: the winmm sampler
+ * waits on a timer and has no message loop.  The sampler stops calling joyGetPosEx() for a device that
+ * failed and only looks for it again when HotplugChanges() moves, on an arrival or a removal.
+ * While every device is gone it waits on HotplugEvent() instead of the timer, so a reconnect is seen
+ * within milliseconds.
+ */
+
+#ifndef HOTPLUG_H
+#define HOTPLUG_H
+
+#include "windows.h"
+
+/* Returns 0 when the notifications are registered */
+int  HotplugStart(void);
+
+/* Arrivals and removals so far */
+LONG HotplugChanges(void);
+
+/* Auto-reset, signaled on every arrival and removal.  NULL if HotplugStart() failed */
+HANDLE HotplugEvent(void);
+
+void HotplugStop(void);
+
+#endif /* HOTPLUG_H */
@@ -0,0 +1,57 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   input.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The polled input of the sampler (--backend winmm), chosen when the program is built:
+ *      FPM_INPUT_WINMM    joyGetPosEx(), input_winmm.c.  Default
+ *      FPM_INPUT_DINPUT8  DirectInput8 with buffered device data, input_dinput8.c
+ * Only one of the input_*.c files compiles to anything, the others are empty, so the binary has only the
+ * selected backend and the sampler calls it directly, there isn't any function pointer per sample.
+ * Every backend fills the same FpmSample the detector reads.
+ *
+ * To build the DirectInput8 binary (make doesn't know the objects depend on FPM_INPUT):
+ *      make clean && make CONF=Release CFLAGS=-DFPM_INPUT=FPM_INPUT_DINPUT8
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "windows.h"
+#include "sample.h"
+
+#define FPM_INPUT_WINMM   1
+#define FPM_INPUT_DINPUT8 2
+
+#ifndef FPM_INPUT
+#define FPM_INPUT FPM_INPUT_WINMM
+#endif
+
+#if FPM_INPUT != FPM_INPUT_WINMM && FPM_INPUT != FPM_INPUT_DINPUT8
+#error "FPM_INPUT must be FPM_INPUT_WINMM or FPM_INPUT_DINPUT8"
+#endif
+
+/* "winmm" or "dinput8" */
+const char *InputName(void);
+
+/* On the thread that will call InputRead().  vids[d] and pids[d] 0 and 0: taken from joyGetDevCaps().
+ * joy_Flags: without JOY_RETURNRAWDATA the axes go from 0 to 65535 like winmm scales them.
+ * Returns 0 when every device could be opened */
+int  InputOpen(const UINT *joy_IDs, const WORD *vids, const WORD *pids, int count, DWORD joy_Flags);
+
+/* Fills axes, buttons and status of s, not t_us nor device.  After a status != JOYERR_NOERROR the device
+ * is lost, don't read it again before InputRefind() found it */
+void InputRead(int d, FpmSample *s);
+
+/* Looks for a lost device again by VendorID/ProductID.  Returns 1 when it's back, *joy_ID is the winmm
+ * joystick ID it has now */
+int  InputRefind(int d, UINT *joy_ID);
+
+void InputClose(void);
+
+#endif /* INPUT_H */
@@ -0,0 +1,226 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   input_dinput8.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * DirectInput8 with buffered device data.  Every device gets a buffer of DI8_BUFFER events; one
+ * InputRead() applies what arrived since the last one to the state it keeps, so a change between two
+ * reads is never lost, the sample has the last value of every axis.  If the buffer overflowed the state
+ * is read again with GetDeviceState().
+ * Devices are found by the VendorID/ProductID winmm reports, DirectInput has its own instance GUIDs.
+ */
+
+#include "input.h"
+
+#if FPM_INPUT == FPM_INPUT_DINPUT8
+
+#include <stdio.h>
+#include <string.h>
+#define DIRECTINPUT_VERSION 0x0800
+#include <dinput.h>
+
+#define DI8_BUFFER 64
+
+extern int verbose_flag; /* main.c */
+
+/* Local copy of IID_IDirectInput8A, so we don't need dxguid.lib */
+static const GUID FPM_IID_IDirectInput8A = {0xBF798030, 0x483A, 0x4DA2, {0xAA, 0x99, 0x5D, 0x64, 0xED, 0x36, 0x97, 0x00}};
+
+static LPDIRECTINPUT8A di = NULL;
+static LPDIRECTINPUTDEVICE8A dev[FPM_MAX_DEVICES];
+static DIJOYSTATE2 state[FPM_MAX_DEVICES];
+static GUID instance[FPM_MAX_DEVICES];
+static UINT ids[FPM_MAX_DEVICES];
+static WORD vid[FPM_MAX_DEVICES], pid[FPM_MAX_DEVICES];
+static LONG range_max = 65535;
+static HWND hwnd = NULL;         // for SetCooperativeLevel(): the console, or a message-only window of ours
+static int own_Window = 0;
+static int devices = 0;
+
+typedef struct {
+    int d;
+    int found;
+} FindContext;
+
+
+static BOOL CALLBACK FindDevice(LPCDIDEVICEINSTANCEA inst, LPVOID ctx) {
+    FindContext *fc = (FindContext *)ctx;
+    if (LOWORD(inst->guidProduct.Data1) != vid[fc->d] || HIWORD(inst->guidProduct.Data1) != pid[fc->d]) return DIENUM_CONTINUE;
+    for (int k = 0; k < devices; k++) // two identical devices: the first one not taken yet
+        if (k != fc->d && dev[k] && IsEqualGUID(&instance[k], &inst->guidInstance)) return DIENUM_CONTINUE;
+    instance[fc->d] = inst->guidInstance;
+    fc->found = 1;
+    return DIENUM_STOP;
+}
+
+
+static void Release(int d) {
+    if (dev[d] == NULL) return;
+    IDirectInputDevice8_Unacquire(dev[d]);
+    IDirectInputDevice8_Release(dev[d]);
+    dev[d] = NULL;
+}
+
+
+static int OpenDevice(int d) {
+    FindContext fc = { d, 0 };
+    IDirectInput8_EnumDevices(di, DI8DEVCLASS_GAMECTRL, FindDevice, &fc, DIEDFL_ATTACHEDONLY);
+    if (!fc.found) return -1;
+    if (FAILED(IDirectInput8_CreateDevice(di, &instance[d], &dev[d], NULL))) {
+        dev[d] = NULL;
+        return -1;
+    }
+
+    DIPROPRANGE range;
+    range.diph.dwSize = sizeof(range);
+    range.diph.dwHeaderSize = sizeof(range.diph);
+    range.diph.dwObj = 0;
+    range.diph.dwHow = DIPH_DEVICE;
+    range.lMin = 0;
+    range.lMax = range_max;
+
+    DIPROPDWORD buffer;
+    buffer.diph.dwSize = sizeof(buffer);
+    buffer.diph.dwHeaderSize = sizeof(buffer.diph);
+    buffer.diph.dwObj = 0;
+    buffer.diph.dwHow = DIPH_DEVICE;
+    buffer.dwData = DI8_BUFFER;
+
+    if (FAILED(IDirectInputDevice8_SetDataFormat(dev[d], &c_dfDIJoystick2))
+            || FAILED(IDirectInputDevice8_SetCooperativeLevel(dev[d], hwnd, DISCL_BACKGROUND | DISCL_NONEXCLUSIVE))
+            || FAILED(IDirectInputDevice8_SetProperty(dev[d], DIPROP_BUFFERSIZE, &buffer.diph))) {
+        Release(d);
+        return -1;
+    }
+    IDirectInputDevice8_SetProperty(dev[d], DIPROP_RANGE, &range.diph); // every axis, fails on a device without any
+
+    IDirectInputDevice8_Acquire(dev[d]);
+    IDirectInputDevice8_Poll(dev[d]);
+    if (FAILED(IDirectInputDevice8_GetDeviceState(dev[d], sizeof(state[d]), &state[d]))) {
+        Release(d);
+        return -1;
+    }
+    return 0;
+}
+
+
+const char *InputName(void) {
+    return "dinput8";
+}
+
+
+int InputOpen(const UINT *joy_IDs, const WORD *vids, const WORD *pids, int count, DWORD joy_Flags) {
+    JOYCAPS jc;
+    range_max = (joy_Flags & JOY_RETURNRAWDATA) ? 1023 : 65535; // like rawinput, 10 bits raw
+    devices = count;
+    for (int d = 0; d < count; d++) {
+        dev[d] = NULL;
+        ids[d] = joy_IDs[d];
+        vid[d] = vids[d];
+        pid[d] = pids[d];
+        if (vid[d] == 0 && pid[d] == 0 && joyGetDevCaps(ids[d], &jc, sizeof(jc)) == JOYERR_NOERROR) {
+            vid[d] = jc.wMid;
+            pid[d] = jc.wPid;
+        }
+    }
+
+    // the sampler thread never pumps messages: a top-level window of its own would hold up every
+    // broadcast SendMessage() of the other processes, a message-only one gets no broadcasts
+    hwnd = GetConsoleWindow();
+    own_Window = hwnd == NULL;
+    if (own_Window) hwnd = CreateWindowEx(0, "STATIC", "", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, GetModuleHandle(NULL), NULL);
+    HRESULT hr = DirectInput8Create(GetModuleHandle(NULL), DIRECTINPUT_VERSION, &FPM_IID_IDirectInput8A, (LPVOID *)&di, NULL);
+    if (hwnd == NULL || FAILED(hr)) {
+        printf("Could not initialize DirectInput8, hr=[0x%08lx]\n", (unsigned long)hr);
+        InputClose();
+        return -1;
+    }
+
+    for (int d = 0; d < count; d++) {
+        if (OpenDevice(d) != 0) {
+            printf("DirectInput8 could not open joystick %u (VendorID=%04X ProductID=%04X)\n", ids[d], vid[d], pid[d]);
+            InputClose();
+            return -1;
+        }
+        if (verbose_flag) printf("DirectInput8: joystick %u opened, buffer of %d events\n", ids[d], DI8_BUFFER);
+    }
+    return 0;
+}
+
+
+static void Apply(DIJOYSTATE2 *js, const DIDEVICEOBJECTDATA *e) {
+    DWORD ofs = e->dwOfs;
+    if (ofs == DIJOFS_X) js->lX = (LONG)e->dwData;
+    else if (ofs == DIJOFS_Y) js->lY = (LONG)e->dwData;
+    else if (ofs == DIJOFS_Z) js->lZ = (LONG)e->dwData;
+    else if (ofs == DIJOFS_RZ) js->lRz = (LONG)e->dwData;
+    else if (ofs == DIJOFS_RX) js->lRx = (LONG)e->dwData;
+    else if (ofs == DIJOFS_RY) js->lRy = (LONG)e->dwData;
+    else if (ofs >= DIJOFS_BUTTON(0) && ofs <= DIJOFS_BUTTON(31)) js->rgbButtons[ofs - DIJOFS_BUTTON(0)] = (BYTE)e->dwData;
+}
+
+
+void InputRead(int d, FpmSample *s) {
+    DIDEVICEOBJECTDATA events[DI8_BUFFER];
+    DWORD n = DI8_BUFFER;
+    HRESULT hr;
+
+    IDirectInputDevice8_Poll(dev[d]); // DI_NOEFFECT for the usual interrupt driven USB device
+    hr = IDirectInputDevice8_GetDeviceData(dev[d], sizeof(events[0]), events, &n, 0);
+    if (hr == DIERR_INPUTLOST || hr == DIERR_NOTACQUIRED) {
+        IDirectInputDevice8_Acquire(dev[d]);
+        n = DI8_BUFFER;
+        hr = IDirectInputDevice8_GetDeviceData(dev[d], sizeof(events[0]), events, &n, 0);
+    }
+
+    if (FAILED(hr)) {
+        s->status = JOYERR_UNPLUGGED;
+        Release(d);
+    } else {
+        for (DWORD k = 0; k < n; k++) Apply(&state[d], &events[k]);
+        if (hr == DI_BUFFEROVERFLOW) IDirectInputDevice8_GetDeviceState(dev[d], sizeof(state[d]), &state[d]);
+        s->status = JOYERR_NOERROR;
+    }
+
+    const DIJOYSTATE2 *js = &state[d];
+    s->axes[FPM_X] = (uint32_t)js->lX;
+    s->axes[FPM_Y] = (uint32_t)js->lY;
+    s->axes[FPM_Z] = (uint32_t)js->lZ;
+    s->axes[FPM_R] = (uint32_t)js->lRz;
+    s->axes[FPM_U] = (uint32_t)js->lRx;
+    s->axes[FPM_V] = (uint32_t)js->lRy;
+    uint32_t buttons = 0;
+    for (int b = 0; b < 32; b++) if (js->rgbButtons[b] & 0x80) buttons |= 1u << b;
+    s->buttons = buttons;
+}
+
+
+int InputRefind(int d, UINT *joy_ID) {
+    if (OpenDevice(d) != 0) return 0;
+    JOYCAPS jc;
+    for (UINT id = 0; id < FPM_MAX_DEVICES; id++) // only for the messages, DirectInput doesn't use it
+        if (joyGetDevCaps(id, &jc, sizeof(jc)) == JOYERR_NOERROR && jc.wMid == vid[d] && jc.wPid == pid[d]) {
+            ids[d] = id;
+            break;
+        }
+    *joy_ID = ids[d];
+    return 1;
+}
+
+
+void InputClose(void) {
+    for (int d = 0; d < devices; d++) Release(d);
+    devices = 0;
+    if (di) IDirectInput8_Release(di);
+    di = NULL;
+    if (hwnd && own_Window) DestroyWindow(hwnd);
+    hwnd = NULL;
+    own_Window = 0;
+}
+
+#endif /* FPM_INPUT == FPM_INPUT_DINPUT8 */
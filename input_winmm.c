@@ -0,0 +1,89 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   input_winmm.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include "input.h"
+
+#if FPM_INPUT == FPM_INPUT_WINMM
+
+#include <string.h>
+
+static JOYINFOEX info[FPM_MAX_DEVICES];
+static UINT ids[FPM_MAX_DEVICES];
+static WORD vid[FPM_MAX_DEVICES], pid[FPM_MAX_DEVICES];
+static int lost[FPM_MAX_DEVICES];
+static int devices = 0;
+
+
+const char *InputName(void) {
+    return "winmm";
+}
+
+
+int InputOpen(const UINT *joy_IDs, const WORD *vids, const WORD *pids, int count, DWORD joy_Flags) {
+    JOYCAPS jc;
+    devices = count;
+    for (int d = 0; d < count; d++) {
+        memset(&info[d], 0, sizeof(info[d]));
+        info[d].dwSize = sizeof(info[d]);
+        info[d].dwFlags = joy_Flags; // Required: JOY_RETURNRAWDATA | JOY_RETURNR | JOY_RETURNV
+        ids[d] = joy_IDs[d];
+        vid[d] = vids[d];
+        pid[d] = pids[d];
+        if (vid[d] == 0 && pid[d] == 0 && joyGetDevCaps(ids[d], &jc, sizeof(jc)) == JOYERR_NOERROR) {
+            vid[d] = jc.wMid;
+            pid[d] = jc.wPid;
+        }
+        lost[d] = 0;
+    }
+    return 0; // an unplugged device is reported by the first InputRead()
+}
+
+
+void InputRead(int d, FpmSample *s) {
+    MMRESULT mr = joyGetPosEx(ids[d], &info[d]);
+    s->axes[FPM_X] = info[d].dwXpos;
+    s->axes[FPM_Y] = info[d].dwYpos;
+    s->axes[FPM_Z] = info[d].dwZpos;
+    s->axes[FPM_R] = info[d].dwRpos;
+    s->axes[FPM_U] = info[d].dwUpos;
+    s->axes[FPM_V] = info[d].dwVpos;
+    s->buttons = info[d].dwButtons;
+    s->status = (uint16_t)mr;
+    if (mr != JOYERR_NOERROR) lost[d] = 1;
+}
+
+
+/* The same VendorID/ProductID under any free joystick ID, or the same ID if they are not known */
+int InputRefind(int d, UINT *joy_ID) {
+    JOYCAPS jc;
+    int by_ID = vid[d] == 0 && pid[d] == 0;
+
+    for (UINT id = 0; id < FPM_MAX_DEVICES; id++) {
+        if (by_ID && id != ids[d]) continue;
+        int used = 0;
+        for (int k = 0; k < devices; k++) used |= k != d && !lost[k] && ids[k] == id;
+        if (used) continue;
+        if (!by_ID && (joyGetDevCaps(id, &jc, sizeof(jc)) != JOYERR_NOERROR || jc.wMid != vid[d] || jc.wPid != pid[d])) continue;
+        if (joyGetPosEx(id, &info[d]) != JOYERR_NOERROR) continue;
+        ids[d] = id;
+        lost[d] = 0;
+        *joy_ID = id;
+        return 1;
+    }
+    return 0;
+}
+
+
+void InputClose(void) {
+    devices = 0;
+}
+
+#endif /* FPM_INPUT == FPM_INPUT_WINMM */
@@ -0,0 +1,300 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   log.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * log_lock is only taken when a buffer changes hands, never per line.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "windows.h"
+
+#include "log.h"
+
+typedef struct {
+    size_t len;
+    char data[LOG_BUFFER_SIZE];
+} LogBuffer;
+
+static LogBuffer buffers[LOG_BUFFERS];
+
+static CRITICAL_SECTION log_lock;
+static HANDLE log_wake = NULL;     // auto-reset, a buffer was queued or LogShutdown()
+static HANDLE log_written = NULL;  // auto-reset, the writer finished a buffer
+static HANDLE log_thread = NULL;
+static volatile LONG log_quit = 0;
+
+/* Protected by log_lock */
+static int queued[LOG_BUFFERS];    // FIFO of full buffers
+static int queue_head = 0, queue_count = 0;
+static int free_ids[LOG_BUFFERS];
+static int free_count = 0;
+static int writing = 0;            // the writer holds a buffer that is not in either list
+static volatile LONG pending = 0;  // queue_count + writing, also read without the lock as a hint
+
+/* Consumer thread only */
+static LogBuffer *current = NULL;
+static int current_id = -1;
+static ULONGLONG current_since = 0; // GetTickCount64() of the first line in current
+static UINT flush_delay = 100;
+static UINT normal_delay = 100;    // flush_delay without LogDefer()
+static ULONGLONG dropped = 0;
+
+
+// From facebook_int_to_str.txt, for 64 bits
+static int Digits10(uint64_t v) {
+    if (v < 10ULL) return 1;
+    if (v < 100ULL) return 2;
+    if (v < 1000ULL) return 3;
+    if (v < 1000000000000ULL) {
+        if (v < 100000000ULL) {
+            if (v < 1000000ULL) {
+                if (v < 10000ULL) return 4;
+                return 5 + (v >= 100000ULL);
+            }
+            return 7 + (v >= 10000000ULL);
+        }
+        if (v < 10000000000ULL) return 9 + (v >= 1000000000ULL);
+        return 11 + (v >= 100000000000ULL);
+    }
+    return 12 + Digits10(v / 1000000000000ULL);
+}
+
+
+/* Writes the digits of value at dst, no '\0'.  Returns the length */
+static int U64ToAsciiTable(uint64_t value, char *dst) {
+    static const char digits[201] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    int const length = Digits10(value);
+    int next = length - 1;
+
+    while (value >= 100) {
+        int const i = (int)(value % 100) * 2;
+        value /= 100;
+        dst[next] = digits[i + 1];
+        dst[next - 1] = digits[i];
+        next -= 2;
+    }
+
+    // Handle last 1-2 digits
+    if (value < 10) {
+        dst[next] = (char)('0' + value);
+    } else {
+        int const i = (int)value * 2;
+        dst[next] = digits[i + 1];
+        dst[next - 1] = digits[i];
+    }
+    return length;
+}
+
+
+static char *CopyText(char *p, const char *text, size_t max) {
+    while (max-- && *text) *p++ = *text++;
+    return p;
+}
+
+
+static DWORD WINAPI LogThread(LPVOID param) {
+    (void)param;
+
+    for (;;) {
+        EnterCriticalSection(&log_lock);
+        int id = -1;
+        if (queue_count) {
+            id = queued[queue_head];
+            queue_head = (queue_head + 1) % LOG_BUFFERS;
+            queue_count--;
+            writing = 1;
+        }
+        pending = queue_count + writing;
+        LeaveCriticalSection(&log_lock);
+
+        if (id < 0) {
+            if (log_quit) break;
+            WaitForSingleObject(log_wake, INFINITE);
+            continue;
+        }
+
+        fwrite(buffers[id].data, 1, buffers[id].len, stdout);
+        fflush(stdout);
+        buffers[id].len = 0;
+
+        EnterCriticalSection(&log_lock);
+        free_ids[free_count++] = id;
+        writing = 0;
+        pending = queue_count;
+        LeaveCriticalSection(&log_lock);
+        SetEvent(log_written);
+    }
+    return 0;
+}
+
+
+/* Queues current if it has something, and takes a free buffer if current is empty or gone */
+static void HandOver(void) {
+    int queue_it = current != NULL && current->len > 0;
+    if (current != NULL && !queue_it) return;
+
+    EnterCriticalSection(&log_lock);
+    if (queue_it) {
+        queued[(queue_head + queue_count) % LOG_BUFFERS] = current_id;
+        queue_count++;
+        pending = queue_count + writing;
+        current = NULL;
+        current_id = -1;
+    }
+    if (free_count) {
+        current_id = free_ids[--free_count];
+        current = &buffers[current_id];
+    }
+    LeaveCriticalSection(&log_lock);
+    if (queue_it) SetEvent(log_wake);
+}
+
+
+/* Room for one line in current, NULL (and the line is counted as dropped) if the writer has every buffer */
+static char *Reserve(void) {
+    if (current == NULL || current->len + LOG_LINE_MAX > LOG_BUFFER_SIZE) HandOver();
+    if (current == NULL) {
+        dropped++;
+        return NULL;
+    }
+    if (current->len == 0) current_since = GetTickCount64();
+    return current->data + current->len;
+}
+
+
+static void Commit(char *end) {
+    current->len = (size_t)(end - current->data);
+    // no delay: send it now if the writer is idle, otherwise the lines pile up until it is
+    if (flush_delay == 0 && pending == 0) HandOver();
+}
+
+
+int LogInit(UINT flush_ms) {
+    flush_delay = normal_delay = flush_ms;
+    InitializeCriticalSection(&log_lock);
+    for (int i = 0; i < LOG_BUFFERS; i++) {
+        buffers[i].len = 0;
+        free_ids[i] = LOG_BUFFERS - 1 - i;
+    }
+    free_count = LOG_BUFFERS;
+    queue_head = queue_count = 0;
+    writing = 0;
+    pending = 0;
+    dropped = 0;
+    log_quit = 0;
+
+    log_wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+    log_written = CreateEvent(NULL, FALSE, FALSE, NULL);
+    log_thread = CreateThread(NULL, 0, LogThread, NULL, 0, NULL);
+    if (log_thread == NULL) {
+        puts("Could not create the log thread, printing directly");
+        return -1;
+    }
+    HandOver(); // take the first buffer
+    return 0;
+}
+
+
+void LogSample(int64_t t_us, const char *name, uint32_t value) {
+    if (log_thread == NULL) { // no writer, the old way
+        if (name) printf("%lld, %s, %lu\n", (long long)t_us, name, (unsigned long)value);
+        else printf("%lld, %lu\n", (long long)t_us, (unsigned long)value);
+        return;
+    }
+    char *p = Reserve();
+    if (p == NULL) return;
+
+    p += U64ToAsciiTable((uint64_t)(t_us < 0 ? 0 : t_us), p);
+    *p++ = ',';
+    *p++ = ' ';
+    if (name) {
+        p = CopyText(p, name, LOG_LINE_MAX - 48); // two 20 digit numbers and the separators fit in the rest
+        *p++ = ',';
+        *p++ = ' ';
+    }
+    p += U64ToAsciiTable(value, p);
+    *p++ = '\n';
+    Commit(p);
+}
+
+
+void LogText(const char *text) {
+    if (log_thread == NULL) {
+        puts(text);
+        return;
+    }
+    char *p = Reserve();
+    if (p == NULL) return;
+
+    p = CopyText(p, text, LOG_LINE_MAX - 1);
+    *p++ = '\n';
+    Commit(p);
+}
+
+
+void LogPoll(void) {
+    if (current != NULL && current->len > 0 && GetTickCount64() - current_since >= flush_delay) HandOver();
+}
+
+
+void LogDefer(int defer) {
+    if (normal_delay == 0) return;
+    flush_delay = defer ? LOG_DEFER_MS : normal_delay;
+    if (log_thread) SetThreadPriority(log_thread, defer ? THREAD_PRIORITY_LOWEST : THREAD_PRIORITY_NORMAL);
+}
+
+
+void LogFlush(void) {
+    if (log_thread == NULL) {
+        fflush(stdout);
+        return;
+    }
+    HandOver();
+    for (;;) {
+        EnterCriticalSection(&log_lock);
+        int busy = queue_count + writing;
+        LeaveCriticalSection(&log_lock);
+        if (busy == 0) break;
+        WaitForSingleObject(log_written, 100);
+    }
+    if (current == NULL) HandOver(); // every buffer was queued, take one back now that they are free
+}
+
+
+void LogShutdown(void) {
+    if (log_thread == NULL) return;
+    LogFlush();
+    InterlockedExchange(&log_quit, 1);
+    SetEvent(log_wake);
+    WaitForSingleObject(log_thread, INFINITE);
+    CloseHandle(log_thread);
+    CloseHandle(log_wake);
+    CloseHandle(log_written);
+    DeleteCriticalSection(&log_lock);
+    log_thread = NULL;
+    current = NULL;
+    current_id = -1;
+}
+
+
+HANDLE LogThreadHandle(void) {
+    return log_thread;
+}
+
+
+ULONGLONG LogDropped(void) {
+    return dropped;
+}
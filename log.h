@@ -0,0 +1,58 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   log.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Output of the live loop.  Lines are formatted into one of LOG_BUFFERS preallocated buffers with the
+ * two-digits-at-a-time formatter of facebook_int_to_str.txt, and a writer thread does the fwrite().
+ * A buffer is handed over when it is full or older than the flush delay (--log_flush), so the loop
+ * never waits for the console or the disk.  If the writer is so far behind that every buffer is queued,
+ * lines are dropped and counted instead of blocking.
+ *
+ * Only the consumer (main) thread calls these.  Before a printf() of its own it calls LogFlush(),
+ * so the console keeps the order of the lines.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include "windows.h"
+
+#define LOG_BUFFER_SIZE (64 * 1024)
+#define LOG_BUFFERS 4
+#define LOG_LINE_MAX 128           // the longest line LogSample() or LogText() writes
+
+/* flush_ms 0: every line is handed to the writer at once (--no_buffer).  Returns 0 when the writer runs */
+int  LogInit(UINT flush_ms);
+
+/* "t_us, value" or, with a name, "t_us, name, value" */
+void LogSample(int64_t t_us, const char *name, uint32_t value);
+
+/* One line, '\n' is added.  Cut at LOG_LINE_MAX */
+void LogText(const char *text);
+
+/* Hands the current buffer over if it is older than the flush delay.  Call at least once per flush delay */
+void LogPoll(void);
+
+/* While a game is in the foreground (--games): the buffer is handed over only when it is full or after
+ * LOG_DEFER_MS, and the writer runs at THREAD_PRIORITY_LOWEST.  Nothing changes with --no_buffer */
+#define LOG_DEFER_MS 10000
+void LogDefer(int defer);
+
+/* Hands the current buffer over and waits until everything was written */
+void LogFlush(void);
+
+/* Flushes and stops the writer */
+void LogShutdown(void);
+
+ULONGLONG LogDropped(void);        // lines lost because every buffer was queued
+
+HANDLE LogThreadHandle(void);      // for --resources
+
+#endif /* LOG_H */
@@ -23,17 +23,278 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "windows.h"
 
 #include <getopt.h> // Sample code from: https://www.gnu.org/software/libc/manual/html_node/Getopt-Long-Option-Example.html
 #include <stdint.h>
 
+#include "config.h"
+#include "recorder.h"
+#include "detector.h"
+#include "replay.h"
+#include "bench.h"
+#include "stats.h"
+#include "telemetry.h"
+#include "log.h"
+#include "heatmap.h"
+#include "vjoy.h"
+#include "cores.h"
+#include "input.h"
+#include "footprint.h"
+#include "game.h"
+#include "resources.h"
+#include "etw.h"
+#include "control.h"
+#include "trend.h"
+#include "pipeline.h"
+#include "monitor.h"
+
 
 /* Flag set by ‘--verbose’. */
-static int verbose_flag = 0;
+int verbose_flag = 0;
+
+static MonitorStats monitor_stats;      // sample interval and stuck run histograms
+static volatile LONG report_requested = 0;
+
+
+/* Ctrl+Break prints the report and keeps monitoring, Ctrl+C still ends the program */
+static BOOL WINAPI ConsoleHandler(DWORD ctrl) {
+    if (ctrl != CTRL_BREAK_EVENT) return FALSE;
+    InterlockedExchange(&report_requested, 1);
+    return TRUE;
+}
+
+
+static ULONGLONG samples_Seen = 0; // for --resources
+static int sink_Recorder = -1, sink_Telemetry = -1;
+static const SampleTimer *sample_Timer = NULL; // winmm only
+
+/* The last --resources measurement, for the telemetry sink: only one thread writes the shared memory.
+ * A seqlock, the sink may still be copying the previous one when the main thread writes the next */
+static ResourceSnapshot resources_First, resources_Latest;
+static ResourceRates resources_Rates;
+static int64_t resources_T;
+static volatile LONG resources_Seq = 0;    // odd while ResourcesHandOver() writes
+static volatile LONG resources_Ready = 0;
+
+
+static void ResourcesHandOver(int64_t t_us) {
+    InterlockedIncrement(&resources_Seq);
+    resources_First = *ResourcesFirst();
+    resources_Latest = *ResourcesLatest();
+    resources_Rates = *ResourcesRates();
+    resources_T = t_us;
+    InterlockedIncrement(&resources_Seq);
+    InterlockedExchange(&resources_Ready, 1);
+}
+
+
+static void RecorderSink(const PipeBatch *batch, void *context) {
+    (void)context;
+    for (int i = 0; i < batch->count; i++) RecorderWrite(&batch->items[i].s); // a few bytes into a 256 KB buffer
+}
+
+
+static void TelemetrySink(const PipeBatch *batch, void *context) {
+    const WatchTable *wt = (const WatchTable *)context;
+    uint64_t lost = SamplerLost(), missed = sample_Timer ? sample_Timer->missed : 0;
+    for (int i = 0; i < batch->count; i++) {
+        const PipeItem *it = &batch->items[i];
+        TelemetryUpdate(wt, &it->s, it->run, it->alerts, lost, missed);
+    }
+    if (InterlockedExchange(&resources_Ready, 0)) {
+        ResourceSnapshot first, latest;
+        ResourceRates rates;
+        int64_t t;
+        LONG seq;
+        do {
+            seq = resources_Seq;
+            MemoryBarrier();
+            first = resources_First;
+            latest = resources_Latest;
+            rates = resources_Rates;
+            t = resources_T;
+            MemoryBarrier();
+        } while ((seq & 1) || seq != resources_Seq);
+        TelemetryUpdateResources(t, &first, &latest, &rates);
+    }
+}
+
+
+static void PrintReport(const MonitorConfig *cfg) {
+    LogFlush(); // the lines still in the log buffers come first
+    if (cfg->input_Backend == INPUT_WINMM) SampleTimerReport(SamplerTimer());
+    printf("Lost samples=[%llu]\n", SamplerLost());
+    StatsPrint(&monitor_stats, &cfg->watches);
+    HeatmapReport(&cfg->watches);
+    VJoyReport();
+    PipelineReport();
+    if (cfg->lean) FootprintReport();
+    if (cfg->resources_Interval) {
+        ResourcesMeasure(samples_Seen);
+        ResourcesPrint();
+    }
+}
+
+
+/* What --record writes first, at start or when the control pipe starts a recording */
+static void FillHeader(FpmHeader *fh, const MonitorConfig *cfg, uint32_t period_us) {
+    MonitorFillHeader(fh, &cfg->watches, cfg->margin, cfg->joy_Flags, period_us, SamplerStartUnixMicroseconds());
+}
+
+
+/* The alert of the shared per-sample step, see monitor.h */
+static const WatchTable *alert_Watches = NULL;
+
+static void MonitorAlert(int w, uint32_t value, int64_t t_us) {
+    AlertPost(w, value); // returns immediately
+    if (etw_on) EtwAlert(t_us, alert_Watches->specs[w].name, value);
+}
+
+
+static void RecordingStopped(const char *path) {
+    printf("Recorded samples=[%llu] bytes=[%llu] file=[%s]\n", (unsigned long long)RecorderSamples(), (unsigned long long)RecorderBytes(), path);
+}
+
+
+/* Every command of a request is checked before the first one is applied, the state a record or
+ * record stop leaves is what the next command sees.  Returns 0 with the errors in the reply */
+static int CheckControl(ControlRequest *rq, const MonitorConfig *cfg) {
+    const char *recording = cfg->record_File;
+    for (int i = 0; i < rq->count; i++) {
+        const ControlCommand *c = &rq->cmds[i];
+        if (c->op == CONTROL_SLEEP && cfg->input_Backend != INPUT_WINMM) ControlReply(rq, "error: --sleep is the winmm sample period");
+        else if (c->op == CONTROL_RECORD && recording) ControlReply(rq, "error: already recording to '%s'", recording);
+        else if (c->op == CONTROL_RECORD_STOP && recording == NULL) ControlReply(rq, "error: not recording");
+        if (c->op == CONTROL_RECORD) recording = c->path;
+        else if (c->op == CONTROL_RECORD_STOP) recording = NULL;
+    }
+    return rq->errors == 0;
+}
+
+
+/* A request of the control pipe, applied between two samples: the detector sees all of it or none */
+static void ApplyControl(ControlRequest *rq, MonitorConfig *cfg, FpmHeader *fh, uint32_t *period_us) {
+    static char record_Path[MAX_PATH];
+    WatchTable *wt = &cfg->watches;
+    if (!CheckControl(rq, cfg)) {
+        LogText("Control pipe: request refused, nothing applied");
+        ControlDone(rq);
+        return;
+    }
+    for (int i = 0; i < rq->count; i++) {
+        const ControlCommand *c = &rq->cmds[i];
+        int w_First = c->watch < 0 ? 0 : c->watch, w_End = c->watch < 0 ? wt->count : c->watch + 1;
+        switch (c->op) {
+            case CONTROL_STATS: {
+                AlertStats as;
+                AlertGetStats(&as);
+                ControlReply(rq, "samples=[%llu] lost=[%llu] alerts=[%ld] sleep=[%u] record=[%s]", samples_Seen, SamplerLost(),
+                             as.spoken, cfg->sleep_Time, cfg->record_File ? cfg->record_File : "");
+                for (int w = 0; w < wt->count; w++) {
+                    char repeat[16];
+                    if (wt->repeat_us[w]) snprintf(repeat, sizeof(repeat), "%ums", wt->repeat_us[w] / 1000);
+                    else snprintf(repeat, sizeof(repeat), "%u", wt->repeat[w]);
+                    ControlReply(rq, "watch %d %s: margin=[%u%%] (%ld) repeat=[%s] engine=[%s] last=[%lu] run=[%u]", w, wt->specs[w].name,
+                                 wt->margin_pct[w], (long)wt->margin[w], repeat, DetectorEngineName((DetectorEngine)wt->engine[w]),
+                                 (DWORD)wt->last[w], wt->run[w]);
+                }
+                break;
+            }
+            case CONTROL_MARGIN:
+                for (int w = w_First; w < w_End; w++) WatchSetMargin(wt, w, c->value);
+                if (c->watch < 0) cfg->margin = c->value;
+                ControlReply(rq, "margin=[%d%%] %s", c->value, c->watch < 0 ? "every watch" : wt->specs[c->watch].name);
+                break;
+            case CONTROL_REPEAT:
+                for (int w = w_First; w < w_End; w++) WatchSetRepeat(wt, w, c->value, c->in_ms);
+                ControlReply(rq, "repeat=[%d%s] %s", c->value, c->in_ms ? "ms" : "", c->watch < 0 ? "every watch" : wt->specs[c->watch].name);
+                break;
+            case CONTROL_ENGINE:
+                for (int w = w_First; w < w_End; w++) WatchSetEngine(wt, w, c->value);
+                ControlReply(rq, "engine=[%s] %s", DetectorEngineName((DetectorEngine)c->value), c->watch < 0 ? "every watch" : wt->specs[c->watch].name);
+                break;
+            case CONTROL_SLEEP:
+                SamplerSetSleep(c->value);
+                cfg->sleep_Time = c->value;
+                if (*period_us) *period_us = c->value * 1000; // a recording started from here on says so, the telemetry keeps its start value
+                ControlReply(rq, "sleep=[%d]", c->value);
+                break;
+            case CONTROL_RECORD:
+                strcpy(record_Path, c->path);
+                FillHeader(fh, cfg, *period_us);
+                if (RecorderOpen(record_Path, fh) != 0) { ControlReply(rq, "error: could not create '%s'", record_Path); break; }
+                cfg->record_File = record_Path;
+                PipelineSetActive(sink_Recorder, 1); // idle until now, the file is ready before its first batch
+                ControlReply(rq, "recording to '%s'", record_Path);
+                break;
+            case CONTROL_RECORD_STOP:
+                if (cfg->record_File == NULL) break; // the record before it could not create its file, that was the error
+                PipelineSetActive(sink_Recorder, 0); // waits until the sink wrote everything
+                RecorderClose();
+                RecordingStopped(cfg->record_File);
+                ControlReply(rq, "recorded samples=[%llu] bytes=[%llu]", (unsigned long long)RecorderSamples(), (unsigned long long)RecorderBytes());
+                cfg->record_File = NULL;
+                break;
+        }
+    }
+    if (rq->errors == 0) ControlReply(rq, "ok"); // the client sees "ok" or the errors, never both
+    char line[LOG_LINE_MAX];
+    snprintf(line, sizeof(line), "Control pipe: %d change%s applied", rq->count, rq->count == 1 ? "" : "s");
+    LogText(line);
+    ControlDone(rq);
+}
 
 
-void ParseCommandLine(int argc, char ** argv,UINT *joy_ID, DWORD *joy_Flags, UINT *iterations, UINT *margin, UINT *sleep_Time) {
+/* The arguments of a second launch for the running instance, quoted with \" and \\ escaped.  Returns 0 when it answered */
+static int ForwardArguments(int argc, char **argv) {
+    char line[CONTROL_LINE], reply[CONTROL_REPLY];
+    size_t len = snprintf(line, sizeof(line), "args");
+    for (int i = 1; i < argc; i++) {
+        if (len + 3 >= sizeof(line)) return -1;
+        line[len++] = ' ';
+        line[len++] = '"';
+        for (const char *p = argv[i]; *p; p++) {
+            if (len + 4 >= sizeof(line)) return -1; // the character, its escape and the closing quote
+            if (*p == '"' || *p == '\\') line[len++] = '\\';
+            line[len++] = *p;
+        }
+        line[len++] = '"';
+    }
+    line[len] = '\0';
+    if (ControlSend(line, reply, sizeof(reply)) != 0) return -1;
+    printf("Another instance is already running, it answered:\n%s", reply);
+    return 0;
+}
+
+
+/* A game of --games came to the foreground (on) or went to the background */
+static void GameMode(const MonitorConfig *cfg, int on) {
+    char line[LOG_LINE_MAX];
+    snprintf(line, sizeof(line), on ? "Game in the foreground=[%s], low impact mode" : "No game in the foreground, normal mode", GameName());
+    LogText(line);
+    SamplerSetTolerance(on ? cfg->game_Delay : 0);
+    LogDefer(on);
+    int priority = on ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_NORMAL;
+    SetThreadPriority(GetCurrentThread(), priority); // the ring holds the samples meanwhile
+    if (AlertThreadHandle()) SetThreadPriority(AlertThreadHandle(), priority); // queued alerts are only spoken a little later
+    if (ControlThreadHandle()) SetThreadPriority(ControlThreadHandle(), priority);
+    PipelineLower(on);
+}
+
+
+/* A whole decimal number >= lo, nothing after it.  Returns 0 with *value set */
+static int ParseNumber(const char *text, long lo, UINT *value) {
+    char *end;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end || v < lo) return -1;
+    *value = (UINT)v;
+    return 0;
+}
+
+
+void ParseCommandLine(int argc, char ** argv, MonitorConfig *cfg) {
   int c;
   int j=0;
   
@@ -58,6 +319,41 @@ void ParseCommandLine(int argc, char ** argv,UINT *joy_ID, DWORD *joy_Flags, UIN
           {"idle",  no_argument, 0, 'd'},
           {"belownormal",  no_argument, 0, 'b'},
           {"affinitymask",  required_argument, 0, 'a'},
+          {"alert",  required_argument, 0, 'l'},
+          {"alert_gap",  required_argument, 0, 'g'},
+          {"alert_wav",  required_argument, 0, 'W'},
+          {"alert_value",  no_argument, 0, 'V'},
+          {"backend",  required_argument, 0, 'k'},
+          {"timer",  required_argument, 0, 't'},
+          {"watch",  required_argument, 0, 'w'},
+          {"record",  required_argument, 0, 'r'},
+          {"replay",  required_argument, 0, 'p'},
+          {"sweep",  required_argument, 0, 'e'},
+          {"sweep_margin",  required_argument, 0, 'M'},
+          {"sweep_repeat",  required_argument, 0, 'R'},
+          {"sweep_gate",  required_argument, 0, 'G'},
+          {"sweep_csv",  required_argument, 0, 'C'},
+          {"labels",  required_argument, 0, 'L'},
+          {"kernel",  required_argument, 0, 'K'},
+          {"bench",  no_argument, 0, 'B'},
+          {"fast_sleep",  required_argument, 0, 'F'},
+          {"repeat_ms",  required_argument, 0, 'T'},
+          {"log_flush",  required_argument, 0, 'O'},
+          {"engine",  required_argument, 0, 'N'},
+          {"heatmap",  required_argument, 0, 'H'},
+          {"heatmap_decay",  required_argument, 0, 'Y'},
+          {"heatmap_margin",  required_argument, 0, 'Z'},
+          {"trend_store",  required_argument, 0, 'D'},
+          {"trend",  required_argument, 0, 'y'},
+          {"calibrate",  no_argument, 0, 'A'},
+          {"vjoy",  required_argument, 0, 'J'},
+          {"cores",  required_argument, 0, 'c'},
+          {"vjoy_filter",  required_argument, 0, 'Q'},
+          {"lean",  no_argument, 0, 'E'},
+          {"games",  required_argument, 0, 'u'},
+          {"game_delay",  required_argument, 0, 'x'},
+          {"resources",  required_argument, 0, 'U'},
+          {"etw",  no_argument, 0, 'P'},
           {0, 0, 0, 0}
         };
       /* getopt_long stores the option index here. */
@@ -84,18 +380,95 @@ void ParseCommandLine(int argc, char ** argv,UINT *joy_ID, DWORD *joy_Flags, UIN
 
         case 'h':
 HELP:           
-          puts ("Usage: fanatecmonitor.exe [--help] [--verbose] [--brief] [--no_buffer] --joystick 0-15 [--flags number] [--margin number] [--iterations number] [-sleep number] [-idle] [-belownormal] [-priorityclass number]\n\n");
-          puts ("       no_buffer:      Disables standard output buffer.\n");
+          puts ("Usage: fanatecmonitor.exe [--help] [--verbose] [--brief] [--no_buffer] --joystick 0-15 [--watch joystick:axis[:gate[:margin[:repeat[:name]]]]]... [--flags number] [--margin number] [--iterations number] [-sleep number] [-idle] [-belownormal] [-priorityclass number] [--alert sapi|powershell|wav] [--alert_gap milliseconds] [--alert_wav file.wav] [--alert_value] [--backend winmm|rawinput] [--timer waitable|sleep] [--record file.fpm] [--replay file.fpm] [--sweep file.fpm]... [--sweep_margin lo:hi[:step]] [--sweep_repeat lo:hi[:step]] [--sweep_gate lo:hi[:step]] [--sweep_csv file.csv] [--labels file.csv] [--kernel auto|scalar|sse4|avx2] [--bench] [--fast_sleep milliseconds] [--repeat_ms milliseconds] [--log_flush milliseconds] [--engine closure|stat] [--heatmap file.fph] [--heatmap_decay hours] [--heatmap_margin number] [--trend_store file.fpt] [--trend file.fpt] [--calibrate] [--vjoy device] [--vjoy_filter euro|median|none] [--cores efficient|performance|auto] [--lean] [--games exe,...|fullscreen] [--game_delay milliseconds] [--resources seconds] [--etw]\n\n");
+          puts ("       no_buffer:      Disables standard output buffer, and writes every line as soon as the log thread is free.\n");
+          puts ("       log_flush:      The monitor lines are written by a separate thread, a line waits at most this many\n");
+          puts ("                       milliseconds (or until 64 KB are ready).  Default=100\n");
           puts ("       joystick:       ID of the joystick to monitor.\n");
+          puts ("       watch:          Watch one axis, can be repeated for several axes and joysticks (0-15).  axis and gate are X Y Z R U V.\n");
+          puts ("                       The axis is checked only while the gate axis is at rest (1023), use - for no gate.\n");
+          puts ("                       margin defaults to --margin, repeat to 4, name (what the alert says) to 'Joystick N axis'.\n");
+          puts ("                       Example: --watch 1:R:Y:1:4:Rudder --watch 2:X:-:2:6:Throttle\n");
+          puts ("                       Without --watch: --joystick, axis R, gate Y, --margin, repeat 4, name Rudder.\n");
           puts ("       margin:         +- margin for stickiness.  Value from 0 to 100.  Default=5\n");
           puts ("       iterations:     Number of 1 second-interval iterations.  Use 86400 for 24 hours when sleep=1000.  Default=1\n");    
           puts ("       sleep:          Wait time in milliseconds to wait between intervals.  Default=1000\n");    
+          puts ("       fast_sleep:     winmm: sample every fast_sleep milliseconds while a watched axis is off rest with its gate\n");
+          puts ("                       at rest, and every sleep milliseconds the rest of the time.  Runs for iterations*sleep milliseconds.\n");
+          puts ("       repeat_ms:      Repeat of the watches that don't give one, as a time: the axis has to stay stuck this\n");
+          puts ("                       many milliseconds, whatever the sample rate is.  A --watch repeat can also be written 3000ms.\n");
           puts ("       flags:          dwFlags parameter.  See https://learn.microsoft.com/en-us/previous-versions/ms709358(v=vs.85)\n");
           puts ("                       Use: 266 for JOY_RETURNRAWDATA | JOY_RETURNR | JOY_RETURNY\n");
           puts ("                       Default=JOY_RETURNALL\n");
           puts ("       idle:           Use IDLE priority class.\n");
           puts ("       belownormal:    Use BELOW_NORMAL priority class.\n");
-          puts ("       affinitymask:   Specifies the processor affinity mask as a decimal number.\n");
+          puts ("       affinitymask:   Specifies the processor affinity mask as a decimal number, or hexadecimal with 0x.\n");
+          puts ("       cores:          efficient: run on the efficient cores of a hybrid CPU (Alder Lake and newer) with EcoQoS,\n");
+          puts ("                       the sampling thread keeps its timer precision.  performance: on the performance cores.\n");
+          puts ("                       auto: efficient on a hybrid CPU, only EcoQoS on any other.  Replaces --affinitymask.\n");
+          puts ("       games:          Comma separated exe names (DCS.exe,Il-2.exe), fullscreen matches any exclusive fullscreen\n");
+          puts ("                       Direct3D program.  While one is in the foreground the sampler wakeups can be coalesced,\n");
+          puts ("                       the other threads run at a lower priority, log flushes and heatmap checkpoints wait.\n");
+          puts ("       game_delay:     Milliseconds a sampler wakeup may be late while a game runs.  Default=sleep/10, at most sleep/2\n");
+          puts ("       resources:      Every this many seconds measure the CPU time, cycles per sample, context switches and\n");
+          puts ("                       wakeups per second of the monitor, per thread.  Printed with the report, also in the telemetry.\n");
+          puts ("       etw:            Register the TraceLogging provider FanatecMonitor: Sample, Alert and Stall events for\n");
+          puts ("                       Windows Performance Analyzer, see etw.h.  Near zero cost while no trace session listens.\n");
+          puts ("       lean:           No allocation after startup, alerts with --alert wav, working set trimmed once running.\n");
+          puts ("                       The report prints the working set and checks that the heaps didn't grow.\n");
+          puts ("       alert:          sapi: keep one text-to-speech voice loaded and speak asynchronously.  Default\n");
+          puts ("                       powershell: call sayRudder.ps1 for every alert (the original behavior).\n");
+          puts ("                       wav: say the name of every watch once at startup into memory and play it from there,\n");
+          puts ("                       a few ms per alert and no speech synthesis when the pedal is failing.\n");
+          puts ("       alert_wav:      wav: play this WAV file for every alert instead of the name.\n");
+          puts ("       alert_value:    wav: say the digits of the stuck axis value after the name, like sayRudder.ps1 receives it.\n");
+          puts ("       alert_gap:      Minimum time in milliseconds between two alerts.  Default=0\n");
+          puts ("       backend:        winmm: poll the input this binary was built with every sleep milliseconds.  Default\n");
+          puts ("                       joyGetPosEx(), or DirectInput8 buffered data in a -DFPM_INPUT=FPM_INPUT_DINPUT8 build.\n");
+          puts ("                       rawinput: wake up only when the pedals send a HID report.  A value that doesn't change\n");
+          puts ("                       is checked again after sleep milliseconds.  Runs for iterations*sleep milliseconds.\n");
+          puts ("       timer:          waitable: high resolution waitable timer with fixed deadlines, sleep can go down to 1.  Default\n");
+          puts ("                       sleep: the original Sleep(sleep), tied to the ~15.6 ms system tick.\n");
+          puts ("                       The measured sample period (min, max, p50, p99) is printed at exit.\n");
+          puts ("       record:         Write every sample to a compact binary file (delta encoded, a few MB per day at 100 Hz).\n");
+          puts ("       replay:         Run the detector over a --record file at full speed and print every alert.\n");
+          puts ("                       Uses --watch/--margin like a live run, --joystick defaults to the first recorded device.\n");
+          puts ("       sweep:          Try every margin, repeat and gate value on the first watch over one or more --record files,\n");
+          puts ("                       on all processors.  Prints the 20 best settings and writes all of them to --sweep_csv.\n");
+          puts ("       sweep_margin:   Margins to try, in percentage.  Default=0:20:1\n");
+          puts ("       sweep_repeat:   Repeat counts to try.  Default=2:12:1\n");
+          puts ("       sweep_gate:     Values of the gate axis at rest to try.  Default=the recorded gate rest\n");
+          puts ("       sweep_csv:      Where to write the ranked results.  Default=sweep.csv\n");
+          puts ("       labels:         Segments where the pedal was really failing, lines of start_seconds,end_seconds\n");
+          puts ("                       or trace,start_seconds,end_seconds (trace: 0 for the first --sweep).\n");
+          puts ("       engine:         closure: repeat samples in a row within the margin, the original rule.  Default\n");
+          puts ("                       stat: running mean, variance, drift and direction reversals of the axis while the gate\n");
+          puts ("                       is idle; alerts when it stayed noisy or stuck for the repeat time, not only within the margin.\n");
+          puts ("                       Also for --replay.  --sweep always uses closure.\n");
+          puts ("       heatmap:        Count where in the travel the axis gets stuck, kept in this file across restarts.\n");
+          puts ("                       The hot zones are printed at exit and with Ctrl+Break.  --replay reads it without changes.\n");
+          puts ("       heatmap_decay:  Halve the heatmap every this many hours.  Default=0 (never)\n");
+          puts ("       heatmap_margin: Margin in percentage outside of the hot zones, --margin/--watch stays inside of them.\n");
+          puts ("       trend_store:    Add the alerts, stuck runs, time at rest and hot zones of every day to this file, a fixed\n");
+          puts ("                       68 bytes a day for up to 4 watches.  Written once a minute, old days are never touched.\n");
+          puts ("       trend:          Print the days of a --trend_store file and how fast the stuck runs grow, then exit.\n");
+          puts ("       calibrate:      Follow the lowest and highest values really seen on every watched axis and on its gate.\n");
+          puts ("                       The highest one is taken as the released pedal.  Without it the range comes from\n");
+          puts ("                       joyGetDevCaps(), or is 0..1023 when flags has JOY_RETURNRAWDATA.\n");
+          puts ("       vjoy:           Write every watched axis, de-noised, to the same axis of this vJoy device (R goes to Rz),\n");
+          puts ("                       from the sampling thread, a few microseconds after joyGetPosEx().  Needs vJoy installed.\n");
+          puts ("       vjoy_filter:    euro: one euro filter, smooth while the pedal is still, no lag while it moves.  Default\n");
+          puts ("                       median: median of the last 5 samples.  none: the raw value.\n");
+          puts ("                       With --heatmap_margin the output also holds still inside the hot zones.\n");
+          puts ("       kernel:         Detector used by --replay and --sweep.  auto picks avx2, sse4 or scalar for this CPU.  Default=auto\n");
+          puts ("       bench:          Measure joyGetPosEx/joyGetDevCaps cost, timer periods, alert latency and detector throughput.\n");
+          puts ("                       Prints CSV, use --joystick or --watch to include the devices.  Says Rudder a few times.\n");
+          puts ("Telemetry: the latest values, stuck runs, alerts and sampler health are published in the shared memory\n");
+          puts ("           " TELEMETRY_NAME " for Joystick Gremlin plugins and overlays, see telemetry.h\n");
+          puts ("Control: \\\\.\\pipe\\FanatecMonitorControl changes margin, repeat, engine and sleep, starts or stops --record\n");
+          puts ("         and prints the statistics while running, see control.h.  Launching it again sends the new options there.\n");
+          puts ("Output: microseconds since the start time, AxisValue.  Every alert also prints its local time.\n");
+          puts ("        Ctrl+Break prints the sample interval and stuck run histograms without stopping, they are also printed at exit.\n");
           puts ("Note: Fanatec-ClubSport-Pedals-V2 typically has VendorID=&H0EB7 and ProductID=&H1839\n");
           
           exit(EXIT_SUCCESS);
@@ -104,31 +477,32 @@ HELP:
         case 'n':
           if (verbose_flag) puts ("Disabling buffered standard output.\n");
           setvbuf(stdout, NULL, _IONBF, 0);              
+          cfg->log_Flush = 0;
           break;
 
         case 'm':
           if (verbose_flag) printf ("Margin= '%s'\n", optarg);
-          *margin = atoi(optarg);
+          cfg->margin = atoi(optarg);
           break;
           
         case 'f':
           if (verbose_flag) printf ("Flags= '%s'\n", optarg);
-          *joy_Flags = atoi(optarg);
+          cfg->joy_Flags = atoi(optarg);
           break;
 
         case 's':
           if (verbose_flag) printf ("Sleep= '%s'\n", optarg);
-          *sleep_Time = atoi(optarg);
+          cfg->sleep_Time = atoi(optarg);
           break;
           
         case 'i':
           if (verbose_flag) printf ("Iterations= '%s'\n", optarg);
-          *iterations = atoi(optarg);
+          cfg->iterations = atoi(optarg);
           break;
 
         case 'j':
           if (verbose_flag) printf ("JoystickID= '%s'\n", optarg);
-          *joy_ID = atoi(optarg);
+          cfg->joy_ID = atoi(optarg);
           j = 1;
           break;
           
@@ -144,8 +518,191 @@ HELP:
           
         case 'a':
             if (verbose_flag) printf ("Affinity Mask= '%s'\n", optarg);
-            DWORD_PTR affinityMask = (DWORD_PTR)atoi(optarg);
-            SetProcessAffinityMask(hProcess, affinityMask);            
+            DWORD_PTR affinityMask = (DWORD_PTR)_strtoui64(optarg, NULL, 0); // atoi() overflowed above 31 bits
+            if (affinityMask == 0 || !SetProcessAffinityMask(hProcess, affinityMask))
+                printf ("Could not use --affinitymask '%s', error=[%lu]\n", optarg, GetLastError());
+            break;
+
+        case 'l':
+            if (verbose_flag) printf ("Alert= '%s'\n", optarg);
+            int backend = AlertBackendFromName(optarg);
+            if (backend < 0) { printf ("Unknown alert backend '%s'\n", optarg); goto HELP; }
+            cfg->alert_Backend = (AlertBackend)backend;
+            break;
+
+        case 'W':
+            if (verbose_flag) printf ("Alert wav= '%s'\n", optarg);
+            cfg->alert_Wav = optarg;
+            break;
+
+        case 'V':
+            cfg->alert_Value = 1;
+            break;
+
+        case 'g':
+            if (verbose_flag) printf ("Alert gap= '%s'\n", optarg);
+            cfg->alert_Gap = atoi(optarg);
+            break;
+
+        case 'k':
+            if (verbose_flag) printf ("Backend= '%s'\n", optarg);
+            if (strcmp(optarg, "winmm") == 0) cfg->input_Backend = INPUT_WINMM;
+            else if (strcmp(optarg, "rawinput") == 0) cfg->input_Backend = INPUT_RAWINPUT;
+            else { printf ("Unknown backend '%s'\n", optarg); goto HELP; }
+            break;
+
+        case 't':
+            if (verbose_flag) printf ("Timer= '%s'\n", optarg);
+            if (strcmp(optarg, "waitable") == 0) cfg->timer_Kind = TIMER_WAITABLE;
+            else if (strcmp(optarg, "sleep") == 0) cfg->timer_Kind = TIMER_SLEEP;
+            else { printf ("Unknown timer '%s'\n", optarg); goto HELP; }
+            break;
+
+        case 'w':
+            if (verbose_flag) printf ("Watch= '%s'\n", optarg);
+            if (WatchAdd(&cfg->watches, optarg) != 0) goto HELP;
+            break;
+
+        case 'r':
+            if (verbose_flag) printf ("Record= '%s'\n", optarg);
+            cfg->record_File = optarg;
+            break;
+
+        case 'p':
+            if (verbose_flag) printf ("Replay= '%s'\n", optarg);
+            cfg->replay_File = optarg;
+            break;
+
+        case 'e':
+            if (verbose_flag) printf ("Sweep= '%s'\n", optarg);
+            if (SweepAddTrace(&cfg->sweep, optarg) != 0) goto HELP;
+            break;
+
+        case 'M':
+            if (SweepParseRange(&cfg->sweep.margin, optarg) != 0) goto HELP;
+            break;
+
+        case 'R':
+            if (SweepParseRange(&cfg->sweep.repeat, optarg) != 0) goto HELP;
+            break;
+
+        case 'G':
+            if (SweepParseRange(&cfg->sweep.gate, optarg) != 0) goto HELP;
+            break;
+
+        case 'C':
+            cfg->sweep.csv_File = optarg;
+            break;
+
+        case 'L':
+            cfg->sweep.labels_File = optarg;
+            break;
+
+        case 'K':
+            if (verbose_flag) printf ("Kernel= '%s'\n", optarg);
+            int kernel = DetectorKernelFromName(optarg);
+            if (kernel < 0) { printf ("Unknown kernel '%s'\n", optarg); goto HELP; }
+            cfg->detector_Kernel = (DetectorKernel)kernel;
+            break;
+
+        case 'B':
+            cfg->bench = 1;
+            break;
+
+        case 'F':
+            if (verbose_flag) printf ("Fast sleep= '%s'\n", optarg);
+            if (ParseNumber(optarg, 1, &cfg->fast_Sleep) != 0) { printf ("Wrong --fast_sleep '%s'\n", optarg); goto HELP; }
+            break;
+
+        case 'T':
+            if (verbose_flag) printf ("Repeat ms= '%s'\n", optarg);
+            cfg->watches.default_repeat_ms = atoi(optarg);
+            if (cfg->watches.default_repeat_ms < 1) { printf ("Wrong --repeat_ms '%s'\n", optarg); goto HELP; }
+            break;
+
+        case 'N':
+            if (verbose_flag) printf ("Engine= '%s'\n", optarg);
+            int engine = DetectorEngineFromName(optarg);
+            if (engine < 0) { printf ("Unknown engine '%s'\n", optarg); goto HELP; }
+            cfg->watches.default_engine = engine;
+            break;
+
+        case 'H':
+            if (verbose_flag) printf ("Heatmap= '%s'\n", optarg);
+            cfg->heatmap_File = optarg;
+            break;
+
+        case 'Y':
+            cfg->heatmap_Decay = atoi(optarg);
+            break;
+
+        case 'Z':
+            cfg->heatmap_Margin = atoi(optarg);
+            if (cfg->heatmap_Margin < 0 || cfg->heatmap_Margin > 100) { printf ("Wrong --heatmap_margin '%s'\n", optarg); goto HELP; }
+            break;
+
+        case 'D':
+            if (verbose_flag) printf ("Trend store= '%s'\n", optarg);
+            cfg->trend_Store = optarg;
+            break;
+
+        case 'y':
+            if (verbose_flag) printf ("Trend= '%s'\n", optarg);
+            cfg->trend_File = optarg;
+            break;
+
+        case 'A':
+            cfg->watches.observe = 1;
+            break;
+
+        case 'J':
+            if (verbose_flag) printf ("vJoy= '%s'\n", optarg);
+            cfg->vjoy_ID = atoi(optarg);
+            if (cfg->vjoy_ID < 1 || cfg->vjoy_ID > 16) { printf ("Wrong --vjoy '%s', vJoy devices are 1 to 16\n", optarg); goto HELP; }
+            break;
+
+        case 'c':
+            if (verbose_flag) printf ("Cores= '%s'\n", optarg);
+            int cores = CoreChoiceFromName(optarg);
+            if (cores < 0) { printf ("Unknown --cores '%s'\n", optarg); goto HELP; }
+            cfg->cores = (CoreChoice)cores;
+            break;
+
+        case 'u':
+            if (verbose_flag) printf ("Games= '%s'\n", optarg);
+            cfg->games = optarg;
+            break;
+
+        case 'x':
+            if (verbose_flag) printf ("Game delay= '%s'\n", optarg);
+            cfg->game_Delay = atoi(optarg);
+            break;
+
+        case 'U':
+            if (verbose_flag) printf ("Resources= '%s'\n", optarg);
+            cfg->resources_Interval = atoi(optarg);
+            break;
+
+        case 'P':
+            if (verbose_flag) puts ("ETW provider");
+            cfg->etw = 1;
+            break;
+
+        case 'E':
+            if (verbose_flag) puts ("Lean mode");
+            cfg->lean = 1;
+            break;
+
+        case 'Q':
+            if (verbose_flag) printf ("vJoy filter= '%s'\n", optarg);
+            int filter = FilterKindFromName(optarg);
+            if (filter < 0) { printf ("Unknown filter '%s'\n", optarg); goto HELP; }
+            cfg->vjoy_Filter = (FilterKind)filter;
+            break;
+
+        case 'O':
+            if (verbose_flag) printf ("Log flush= '%s'\n", optarg);
+            if (ParseNumber(optarg, 0, &cfg->log_Flush) != 0) { printf ("Wrong --log_flush '%s', 0 writes every line at once\n", optarg); goto HELP; }
             break;
           
 
@@ -174,123 +731,287 @@ HELP:
       putchar ('\n');
     }
   
-    if (!j) goto HELP;
+    if (!j && cfg->watches.spec_count == 0 && cfg->replay_File == NULL && cfg->sweep.trace_count == 0 && !cfg->bench && cfg->trend_File == NULL) goto HELP;
     
 }
 
-//https://tia.mat.br/posts/2014/06/23/integer_to_string_conversion.html
-#define INT_TO_STR_BUFFER_SIZE (3 * sizeof(int))
-char *lwan_uint32_to_str(uint32_t value, char buffer[static INT_TO_STR_BUFFER_SIZE]) {
-        
-    char *p = buffer + INT_TO_STR_BUFFER_SIZE -1;
-
-   *p = '\0';
-    do {
-        *--p = "0123456789"[value % 10];
-    } while (value /= 10);
-
-    size_t difference = (size_t)(p - buffer);
-    int len = (int)(INT_TO_STR_BUFFER_SIZE - difference - 1);
-
-    p[len++] = ' '; // add a space to clean a possibly longer previous lastAxis value
-    p[len] = '\0';
-
-    return p;
-}
-
-
-
 int main(int argc, char** argv) {
     
+    static MonitorConfig cfg; // static: the watch table is a few KB
+    cfg.joy_ID      = 17; // impossible value
+    cfg.joy_Flags   = JOY_RETURNALL;  
+    cfg.iterations  = 1;  
+    cfg.margin      = 5; // Percentage of closure where the axis values are considered the same
+    cfg.sleep_Time  = 1000;
+    cfg.fast_Sleep  = 0;
+    cfg.log_Flush   = 100;
+    cfg.heatmap_File = NULL;
+    cfg.heatmap_Decay = 0;
+    cfg.heatmap_Margin = -1;
+    cfg.trend_Store = NULL;
+    cfg.trend_File  = NULL;
+    cfg.vjoy_ID     = 0;
+    cfg.vjoy_Filter = FILTER_EURO;
+    cfg.cores       = CORES_ANY;
+    cfg.lean        = 0;
+    cfg.games       = NULL;
+    cfg.game_Delay  = (UINT)-1; // sleep/10 unless --game_delay
+    cfg.resources_Interval = 0;
+    cfg.etw         = 0;
+    cfg.alert_Backend = ALERT_SAPI;
+    cfg.alert_Gap   = 0;
+    cfg.alert_Wav   = NULL;
+    cfg.alert_Value = 0;
+    cfg.input_Backend = INPUT_WINMM;
+    cfg.timer_Kind  = TIMER_WAITABLE;
+    cfg.record_File = NULL;
+    cfg.replay_File = NULL;
+    SweepInit(&cfg.sweep);
+    cfg.detector_Kernel = KERNEL_AUTO;
+    cfg.bench = 0;
+    WatchInit(&cfg.watches);
+        
+    ParseCommandLine(argc, argv, &cfg);
+    
+    if (cfg.replay_File || cfg.sweep.trace_count || cfg.bench) {
+        cfg.detector_Kernel = DetectorSetKernel(cfg.detector_Kernel); // once, before the sweep threads
+        if (verbose_flag) printf("Detector kernel=[%s]\n", DetectorKernelName(cfg.detector_Kernel));
+    }
+    if (cfg.bench) return BenchRun(&cfg);
+    if (cfg.trend_File) return TrendReport(cfg.trend_File); // reads the store, can run next to the monitor
+    if (cfg.replay_File) return ReplayRun(&cfg); // offline, no devices and no alerts: can run next to the monitor
+    if (cfg.sweep.trace_count) return SweepRun(&cfg.sweep, &cfg.watches, cfg.joy_ID, cfg.margin);
+    
     /* Simplified Single Instance Checker */
     HANDLE hMutex = CreateMutex(NULL, TRUE, "fanatec_monitor_single_instance_mutex");
     DWORD waitResult = WaitForSingleObject(hMutex, 0);
     if (waitResult != WAIT_OBJECT_0) {
+        if (ForwardArguments(argc, argv) == 0) { // the options it can change live, the rest waits for a restart
+            CloseHandle(hMutex);
+            exit(EXIT_SUCCESS);
+        }
         system("C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe  .\\sayDuplicateInstance.ps1");
         perror("Another instance is already running. ");
         CloseHandle(hMutex);
         exit(1);
     }
     
+    WatchTable *wt = &cfg.watches;
+    WatchFinish(wt, cfg.joy_ID, cfg.margin);
+    cfg.cores = CoresApply(cfg.cores); // before the alert, log and sampler threads start
     
-
-    UINT joy_ID      = 17; // impossible value
-    DWORD joy_Flags  = JOY_RETURNALL;  
-    UINT iterations  = 1;  
-    UINT margin      = 5; // Percentage of closure where the axis values are considered the same
-    UINT sleep_Time  = 1000;
-        
-    ParseCommandLine(argc, argv, &joy_ID, &joy_Flags, &iterations, &margin, &sleep_Time);
-    
-    char command_line[150];
-    strcpy(command_line, "C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe  .\\sayRudder.ps1 12345678901234567890");
-    char *where = command_line + 75;  // 75 is the fixed position in string where the lastAxis should be copied into command_line 
+    if (cfg.lean && cfg.alert_Backend != ALERT_WAV) {
+        puts("--lean: alerts are played from memory (--alert wav), no speech or powershell.exe while running");
+        cfg.alert_Backend = ALERT_WAV;
+    }
+    if (cfg.resources_Interval && ResourcesInit() != 0) puts("--resources: no NtQuerySystemInformation(), context switches not counted");
+    if (cfg.etw) EtwRegister();
+    for (int w = 0; w < wt->count; w++) AlertSetName(w, wt->specs[w].name);
+    AlertSetWav(cfg.alert_Wav, cfg.alert_Value);
+    cfg.alert_Backend = AlertInit(cfg.alert_Backend, cfg.alert_Gap); // load the voice now, not when the pedal is already failing
+    if (cfg.lean && cfg.alert_Backend != ALERT_WAV) { // the fallback would run powershell.exe after FootprintSettle()
+        puts("--lean: no alert sounds, and no powershell.exe while running.  Check --alert_wav, or run without --lean");
+        AlertShutdown();
+        exit(1);
+    }
+    if (verbose_flag) printf("Alert backend=[%s]\n", AlertBackendName(cfg.alert_Backend));
 
     
     MMRESULT mr;
     JOYCAPS jc;
+    static FpmHeader fh; // what --record writes first
 	
-    mr = joyGetDevCaps(joy_ID, &jc, sizeof(jc));    
-    if (verbose_flag && mr == JOYERR_NOERROR) {
-        printf("Requested Margin=[%u]\n", margin);
-        printf("Requested Joystick ID=[%u]\n", joy_ID);
-        printf("Requested       Flags=[%lu]\n", joy_Flags);
-        
-        printf("Vendor  ID=[%hX]\n", jc.wMid);
-        printf("Product ID=[%hX]\n", jc.wPid);
-        // printf("Querying: [%s]\n", jc.szPname); // Not working: Shows  [Microsoft PC-joystick driver]   
+    if (verbose_flag) {
+        printf("Requested Margin=[%u]\n", cfg.margin);
+        printf("Requested       Flags=[%lu]\n", cfg.joy_Flags);
     }
-
-    JOYINFOEX info;
-    info.dwSize = sizeof(info);
-    info.dwFlags = joy_Flags; // Required: JOY_RETURNRAWDATA | JOY_RETURNR | JOY_RETURNV
+    for (int d = 0; d < wt->device_count; d++) {
+        mr = joyGetDevCaps(wt->joy_ID[d], &jc, sizeof(jc));    
+        fh.devices[d].joy_ID = wt->joy_ID[d];
+        if (mr == JOYERR_NOERROR) {
+            fh.devices[d].vid = jc.wMid;
+            fh.devices[d].pid = jc.wPid;
+        }
+        // raw data doesn't follow JOYCAPS, it keeps 0..1023 unless --calibrate finds better
+        if (mr == JOYERR_NOERROR && !(cfg.joy_Flags & JOY_RETURNRAWDATA)) {
+            uint32_t axis_Min[FPM_AXES] = { jc.wXmin, jc.wYmin, jc.wZmin, jc.wRmin, jc.wUmin, jc.wVmin };
+            uint32_t axis_Max[FPM_AXES] = { jc.wXmax, jc.wYmax, jc.wZmax, jc.wRmax, jc.wUmax, jc.wVmax };
+            WatchCalibrate(wt, d, axis_Min, axis_Max);
+        }
+        if (verbose_flag && mr == JOYERR_NOERROR) {
+            printf("Requested Joystick ID=[%u]\n", wt->joy_ID[d]);
+            printf("Vendor  ID=[%hX]\n", jc.wMid);
+            printf("Product ID=[%hX]\n", jc.wPid);
+            // printf("Querying: [%s]\n", jc.szPname); // Not working: Shows  [Microsoft PC-joystick driver]   
+        }
+    }
+    if (verbose_flag) WatchPrint(wt);
+    if (cfg.heatmap_File && HeatmapOpen(cfg.heatmap_File, wt, cfg.heatmap_Decay, cfg.heatmap_Margin, 0) != 0) cfg.heatmap_File = NULL;
+    if (cfg.trend_Store && TrendOpen(cfg.trend_Store, wt) != 0) cfg.trend_Store = NULL;
+
+    SamplerConfig sc;
+    sc.devices = wt->device_count;
+    memcpy(sc.joy_IDs, wt->joy_ID, sizeof(sc.joy_IDs));
+    for (int d = 0; d < wt->device_count; d++) {
+        sc.vids[d] = fh.devices[d].vid;
+        sc.pids[d] = fh.devices[d].pid;
+    }
+    sc.joy_Flags = cfg.joy_Flags;
+    sc.iterations = cfg.iterations;
+    sc.sleep_Time = cfg.sleep_Time;
+    sc.fast_Sleep = cfg.fast_Sleep;
+    sc.watches = wt;
+    sc.vjoy = cfg.vjoy_ID && VJoyOpen(cfg.vjoy_ID, cfg.vjoy_Filter, wt) == 0;
+    if (sc.vjoy && verbose_flag) printf("vJoy device=[%u] filter=[%s]\n", cfg.vjoy_ID, FilterKindName(cfg.vjoy_Filter));
+    sc.backend = cfg.input_Backend;
+    sc.timer = cfg.timer_Kind;
+    if (verbose_flag && sc.backend == INPUT_WINMM) printf("Polled input=[%s]\n", InputName());
     
-    MMRESULT lastAxis = 0;
-    int isRepeating = 0;
+    if (verbose_flag) printf("Printing microseconds since start, AxisValue every %u milliseconds\n", cfg.sleep_Time);
+    if (verbose_flag && cfg.fast_Sleep) printf("Every %u milliseconds while an axis looks stuck\n", cfg.fast_Sleep);
+    // fixed sample period for --record and the telemetry, 0 when it follows the pedals
+    uint32_t period_us = cfg.input_Backend == INPUT_WINMM && cfg.fast_Sleep == 0 ? cfg.sleep_Time * 1000 : 0;
     
-    if (verbose_flag) printf("Printing GetTickCount, AxisValue every %u milliseconds\n", sleep_Time);
+    StatsInit(&monitor_stats);
+    SetConsoleCtrlHandler(ConsoleHandler, TRUE);
     
-    int closure;
+    if (SamplerStart(&sc) != 0) {
+        puts(cfg.input_Backend == INPUT_RAWINPUT ? "Could not start the rawinput backend" : "Could not start the sampler thread or open the input");
+        exit(1);
+    }
     printf("Fanatec Monitoring is active.\n");
-    margin = 1023 * margin / 100; // re-expresar el margin de puntos porentuales a significancia sobre 1023
-
+    if (cfg.resources_Interval) {
+        ResourcesAddThread("alert", AlertThreadHandle());
+        ResourcesAddThread("sampler", SamplerThreadHandle());
+    }
     
-    for (int i=1; i<=iterations; i++) {
-        //info.dwSize = sizeof(info);
-        //info.dwFlags = JOY_RETURNRAWDATA | JOY_RETURNR | JOY_RETURNY; 
-        
-        mr = joyGetPosEx(joy_ID, &info);        
-        if (verbose_flag) {
-            if (mr != JOYERR_NOERROR) { puts("Error result in joyGetPosEx()\n"); MessageBeep(MB_ICONERROR); }
-            printf("%lu, %lu\n", GetTickCount(), info.dwRpos);
+    char when[48];
+    FormatUnixMicroseconds(SamplerStartUnixMicroseconds(), when, sizeof(when));
+    printf("Start time=[%s], timestamps are microseconds since then.  Ctrl+Break prints the statistics.\n", when);
+    
+    sample_Timer = cfg.input_Backend == INPUT_WINMM ? SamplerTimer() : NULL;
+    if (TelemetryOpen(wt, SamplerStartUnixMicroseconds(), period_us) == 0 && verbose_flag)
+        printf("Telemetry=[%s] size=[%u]\n", TELEMETRY_NAME, (unsigned)sizeof(TelemetryBlock));
+    
+    if (cfg.record_File) {
+        FillHeader(&fh, &cfg, period_us);
+        if (RecorderOpen(cfg.record_File, &fh) != 0) {
+            printf("Could not create '%s'\n", cfg.record_File);
+            cfg.record_File = NULL;
         }
-        //printf("%lu\n", info.dwYpos  );
-        
+    }
+    
+    int64_t next_Report = 60000000; // verbose: sampler report once a minute
+    int64_t next_Checkpoint = 60000000; // heatmap
+    static FpmSample batch[PIPE_BATCH];
+    FpmSample s;
+    int r;
+    char line[LOG_LINE_MAX];
+    int device_Gone[FPM_MAX_DEVICES] = { 0 };
+    DWORD wait_ms = cfg.log_Flush > 0 && cfg.log_Flush < 1000 ? cfg.log_Flush : 1000; // LogPoll() at least once per log_Flush
+    LogInit(cfg.log_Flush);
+    alert_Watches = wt;
+    Monitor monitor = { wt, &monitor_stats, SamplerStartUnixMicroseconds(), LogText, LogSample, MonitorAlert, FormatUnixMicroseconds };
+    int game_Active = 0;
+    if (cfg.games && GameInit(cfg.games) == 0) cfg.games = NULL;
+    if (cfg.game_Delay == (UINT)-1) cfg.game_Delay = cfg.sleep_Time / 10;
+    if (cfg.resources_Interval) ResourcesAddThread("log", LogThreadHandle());
+    int64_t next_Resources = (int64_t)cfg.resources_Interval * 1000000;
+    ControlStart(wt); // the monitor keeps running without it
+    // the outputs that may be slow get threads of their own: never lose a recorded sample, drop telemetry instead
+    sink_Recorder = PipelineAddSink("recorder", RecorderSink, NULL, SINK_BLOCK, THREAD_PRIORITY_BELOW_NORMAL, 1000);
+    // an overlay draws about every 16 ms: one wakeup per frame at most, not one per sample at winmm rates
+    sink_Telemetry = PipelineAddSink("telemetry", TelemetrySink, wt, SINK_DROP, THREAD_PRIORITY_NORMAL, 16);
+    if (PipelineStart(wt) != 0) exit(1);
+    PipelineSetActive(sink_Recorder, cfg.record_File != NULL);
+    if (cfg.resources_Interval) {
+        ResourcesAddThread(PipelineSinkName(sink_Recorder), PipelineThreadHandle(sink_Recorder));
+        ResourcesAddThread(PipelineSinkName(sink_Telemetry), PipelineThreadHandle(sink_Telemetry));
+    }
+    if (cfg.lean) FootprintSettle(); // every thread, buffer and clip exists now
+    
+    while ((r = SamplerNextBatch(batch, PIPE_BATCH, wait_ms)) >= 0) {
+        LogPoll();
+        if (cfg.games && GamePoll() != game_Active) {
+            game_Active = !game_Active;
+            GameMode(&cfg, game_Active);
+        }
+        if (InterlockedExchange(&report_requested, 0)) PrintReport(&cfg);
+        ControlRequest *rq = ControlTake(); // one pointer read, NULL nearly always
+        if (rq) ApplyControl(rq, &cfg, &fh, &period_us);
+        // r == 0: nothing yet, rawinput with quiet pedals
+        for (int b = 0; b < r; b++) {
+            s = batch[b];
+            // winmm pushes one failed sample when a device goes away, and reads it again only once it's back
+            if (s.status != JOYERR_NOERROR && !device_Gone[s.device]) {
+                device_Gone[s.device] = 1;
+                snprintf(line, sizeof(line), "Joystick %u: error %u in joyGetPosEx(), waiting for it to come back", wt->joy_ID[s.device], s.status);
+                LogText(line);
+                if (verbose_flag) MessageBeep(MB_ICONERROR);
+            } else if (s.status == JOYERR_NOERROR && device_Gone[s.device]) {
+                device_Gone[s.device] = 0;
+                UINT id = cfg.input_Backend == INPUT_WINMM ? SamplerJoystickID(s.device) : wt->joy_ID[s.device];
+                snprintf(line, sizeof(line), "Joystick %u is back as joystick %u", wt->joy_ID[s.device], id);
+                LogText(line);
+                wt->joy_ID[s.device] = id;
+            }
         
-        // Determinar si el pedal izquierdo (clutch) esta fallando:
-        // 1. Ver que no estemos usando los pedales (el pedal derecho sin moverse)
-        // 2. Ver si se quedo trabado el pedal izquierdo en alguna posicion                
-        if ( (info.dwYpos==1023) && (info.dwRpos!=1023) ) {            
-            closure = abs(info.dwRpos - lastAxis);
-            if (closure <= margin) isRepeating++; else isRepeating = 0;
-        } else 
-            isRepeating = 0;
+            samples_Seen++;
+            if (cfg.resources_Interval && s.t_us >= next_Resources) {
+                ResourcesMeasure(samples_Seen);
+                ResourcesHandOver(s.t_us);
+                next_Resources = s.t_us + (int64_t)cfg.resources_Interval * 1000000;
+            }
+            if (etw_on && period_us && monitor_stats.last_t[s.device] >= 0 && s.t_us - monitor_stats.last_t[s.device] > 2 * (int64_t)period_us)
+                EtwStall(s.t_us, s.device, s.t_us - monitor_stats.last_t[s.device]);
         
-        lastAxis = info.dwRpos;
+            uint16_t run_Before[MAX_WATCHES];
+            uint32_t alerts = MonitorDetect(&monitor, &s, run_Before);
+            PipelinePush(&s, alerts); // recorder and telemetry, on their own threads
+            if (cfg.heatmap_File) HeatmapUpdate(wt, &s, alerts);
+            if (cfg.trend_Store) TrendSample(wt, &s, run_Before, alerts);
+            if ((cfg.heatmap_File || cfg.trend_Store) && s.t_us >= next_Checkpoint && !game_Active) { // a game in the foreground: wait until it isn't
+                HeatmapCheckpoint(wt);
+                TrendCheckpoint();
+                next_Checkpoint = s.t_us + 60000000; // not +=, after a game it would catch up one sample at a time
+            }
         
-        if (isRepeating && (!verbose_flag)) printf("%lu, %lu\n", GetTickCount(), info.dwRpos); // if haven't printed before, print it here 
+            MonitorOutput(&monitor, &s, alerts); // stuck values, alerts
         
-        if (isRepeating >= 4) { 
-            char num_str[30]; // big enough for sizeof(lastAxis)
-                
-            strcpy(where, lwan_uint32_to_str(lastAxis, num_str)); // where is the fixed position in command_line where the lastAxis should be copied into command_line
-            if (verbose_flag) printf("calling [%s]\n", command_line);
-            system(command_line); // tell the user that the pedal is failing
-            
-            isRepeating = 0; // reset count           
+            if (verbose_flag && s.t_us >= next_Report) {
+                PrintReport(&cfg);
+                next_Report += 60000000;
+            }
         }
-        
-        Sleep(sleep_Time);
+        PipelinePoll(); // the sinks get at most one batch per batch of samples
+    }
+    
+    ControlStop();
+    SamplerStop();
+    PipelineStop(); // the last batches are written before the files close
+    EtwUnregister();
+    VJoyClose();
+    TelemetryClose();
+    LogShutdown();
+    if (LogDropped()) printf("Log lines dropped=[%llu]\n", LogDropped());
+    HeatmapCheckpoint(wt);
+    PrintReport(&cfg);
+    HeatmapClose();
+    TrendClose();
+    if (cfg.record_File) {
+        RecorderClose();
+        RecordingStopped(cfg.record_File);
+    }
+    AlertShutdown();
+    ResourcesClose();
+    
+    if (verbose_flag) {
+        AlertStats as;
+        AlertGetStats(&as);
+        printf("Alerts: queued=[%ld] spoken=[%ld] coalesced=[%ld] dropped=[%ld]\n", as.queued, as.spoken, as.coalesced, as.dropped);
+        static Histogram latency;
+        AlertGetLatency(&latency);
+        HistPrint(&latency, "Alert latency", "us");
     }
     
     /* This is almost just for style, since windows releases,closes them if the program dies/crashes */
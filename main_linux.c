@@ -0,0 +1,434 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   main_linux.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The monitor for Linux, built with make linux.  Same detector, watches, --record files and statistics
+ * as main.c, on one thread: EvdevWait() sleeps until the pedals report, and a device that stays quiet
+ * for --sleep milliseconds is checked again with its last values, so a stuck pedal that sends nothing
+ * still gets its repeats.  The speech, telemetry, heatmap, trend and control pipe parts are Windows only.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <signal.h>
+#include <sys/resource.h>
+
+#include "platform.h"
+#include "sample.h"
+#include "watch.h"
+#include "detector.h"
+#include "recorder.h"
+#include "stats.h"
+#include "cores.h"
+#include "evdev.h"
+#include "monitor.h"
+
+int verbose_flag = 0;
+
+typedef struct {
+    UINT joy_ID;
+    UINT iterations;
+    UINT margin;
+    UINT sleep_Time;
+    UINT alert_Gap;
+    const char *alert_Command;
+    int alert_Value;
+    CoreChoice cores;
+    const char *record_File;
+    int device_Count;                       // --device paths, joystick 0, 1, ...
+    char device_Paths[FPM_MAX_DEVICES][MAX_PATH];
+    WatchTable watches;
+} LinuxConfig;
+
+static MonitorStats monitor_stats;
+static volatile sig_atomic_t stop_requested = 0;
+static volatile sig_atomic_t report_requested = 0;
+
+
+/* Ctrl+\ prints the report and keeps monitoring, Ctrl+C ends the program */
+static void SignalHandler(int sig) {
+    if (sig == SIGQUIT) report_requested = 1;
+    else stop_requested = 1;
+}
+
+
+static void PrintReport(const LinuxConfig *cfg) {
+    long spoken, coalesced, dropped;
+    fflush(stdout);
+    StatsPrint(&monitor_stats, &cfg->watches);
+    PlatformAlertStats(&spoken, &coalesced, &dropped);
+    printf("Alerts started=[%ld] coalesced=[%ld] dropped=[%ld]\n", spoken, coalesced, dropped);
+    fflush(stdout);
+}
+
+
+/* The outputs of the shared per-sample step, see monitor.h: stdout and the --alert command */
+static const LinuxConfig *alert_Config = NULL;
+
+static void PrintLine(const char *line) {
+    puts(line);
+}
+
+
+static void PrintValue(int64_t t_us, const char *name, uint32_t value) {
+    if (name) printf("%lld, %s, %lu\n", (long long)t_us, name, (unsigned long)value);
+    else printf("%lld, %lu\n", (long long)t_us, (unsigned long)value);
+}
+
+
+static void MonitorAlert(int w, uint32_t value, int64_t t_us) {
+    const LinuxConfig *cfg = alert_Config;
+    (void)t_us;
+    PlatformAlert(cfg->alert_Command, w, cfg->watches.specs[w].name, value, cfg->alert_Value, cfg->alert_Gap);
+}
+
+
+void ParseCommandLine(int argc, char ** argv, LinuxConfig *cfg) {
+  int c;
+  int j=0;
+
+  while (1)
+    {
+      static struct option long_options[] =
+        {
+          /* These options set a flag. */
+          {"verbose", no_argument,       &verbose_flag, 1},
+          {"brief",   no_argument,       &verbose_flag, 0},
+          /* These options don't set a flag.
+             We distinguish them by their indices. */
+          {"help",     no_argument,       0, 'h'},
+          {"no_buffer",  no_argument,       0, 'n'},
+          {"iterations",  required_argument, 0, 'i'},
+          {"margin",  required_argument, 0, 'm'},
+          {"sleep",  required_argument, 0, 's'},
+          {"joystick",    required_argument, 0, 'j'},
+          {"device",    required_argument, 0, 'I'},
+          {"idle",  no_argument, 0, 'd'},
+          {"belownormal",  no_argument, 0, 'b'},
+          {"alert",  required_argument, 0, 'l'},
+          {"alert_gap",  required_argument, 0, 'g'},
+          {"alert_value",  no_argument, 0, 'V'},
+          {"watch",  required_argument, 0, 'w'},
+          {"record",  required_argument, 0, 'r'},
+          {"repeat_ms",  required_argument, 0, 'T'},
+          {"engine",  required_argument, 0, 'N'},
+          {"calibrate",  no_argument, 0, 'A'},
+          {"cores",  required_argument, 0, 'c'},
+          {0, 0, 0, 0}
+        };
+      /* getopt_long stores the option index here. */
+      int option_index = 0;
+
+      c = getopt_long (argc, argv, "hni:j:m:s:",
+                       long_options, &option_index);
+
+      /* Detect the end of the options. */
+      if (c == -1)
+        break;
+
+      switch (c)
+        {
+        case 0:
+          /* If this option set a flag, do nothing else now. */
+          if (long_options[option_index].flag != 0)
+            break;
+          printf ("option %s", long_options[option_index].name);
+          if (optarg)
+            printf (" with arg %s", optarg);
+          printf ("\n");
+          break;
+
+        case 'h':
+HELP:
+          puts ("Usage: fanatecmonitor [--help] [--verbose] [--brief] [--no_buffer] --joystick 0-15 [--device /dev/input/...]... [--watch joystick:axis[:gate[:margin[:repeat[:name]]]]]... [--margin number] [--iterations number] [--sleep number] [--idle] [--belownormal] [--alert command] [--alert_gap milliseconds] [--alert_value] [--record file.fpm] [--repeat_ms milliseconds] [--engine closure|stat] [--calibrate] [--cores efficient|performance|auto]\n\n");
+          puts ("       no_buffer:      Disables standard output buffer.\n");
+          puts ("       joystick:       ID of the joystick to monitor, read from /dev/input/eventN.\n");
+          puts ("       device:         Input node of the next joystick ID, from 0: --device /dev/input/by-id/...-event-joystick\n");
+          puts ("                       is joystick 0, a second --device is joystick 1.  Without it joystick N is /dev/input/eventN.\n");
+          puts ("       watch:          Watch one axis, can be repeated for several axes and joysticks (0-15).  axis and gate are X Y Z R U V\n");
+          puts ("                       (ABS_X ABS_Y ABS_Z ABS_RZ ABS_RX ABS_RY).  The axis is checked only while the gate axis is at rest.\n");
+          puts ("                       Without --watch: --joystick, axis R, gate Y, --margin, repeat 4*sleep ms, name Rudder.\n");
+          puts ("                       A repeat without ms counts reports, and a pedal can send hundreds per second: use ms.\n");
+          puts ("       margin:         +- margin for stickiness.  Value from 0 to 100.  Default=5\n");
+          puts ("       iterations:     Runs for iterations*sleep milliseconds.  Use 86400 for 24 hours when sleep=1000.  Default=1\n");
+          puts ("       sleep:          A device that sent nothing for this many milliseconds is checked again with its last values.  Default=1000\n");
+          puts ("       repeat_ms:      Repeat of the watches that don't give one, as a time.  Default=4*sleep, the 4 samples\n");
+          puts ("                       of the Windows build: the input is event driven here, 4 reports can take a few ms.\n");
+          puts ("       idle:           nice 19.\n");
+          puts ("       belownormal:    nice 10.\n");
+          puts ("       alert:          Command run with the name of the watch, without waiting for it.  Default=spd-say\n");
+          puts ("       alert_gap:      Minimum time in milliseconds between two alerts.  Default=0\n");
+          puts ("       alert_value:    Also pass the value of the axis to the alert command.\n");
+          puts ("       record:         Write every sample to a binary file, --replay and --sweep of the Windows build read it.\n");
+          puts ("       engine:         closure: repeat samples in a row within the margin, the original rule.  Default\n");
+          puts ("                       stat: running mean, variance, drift and direction reversals of the axis while the gate is idle.\n");
+          puts ("       calibrate:      Follow the lowest and highest values really seen on every watched axis and on its gate.\n");
+          puts ("       cores:          efficient: run on the E-cores of a hybrid CPU.  performance: on the P-cores.\n");
+          puts ("                       auto: efficient on a hybrid CPU, nothing on any other.  With sched_setaffinity().\n");
+          puts ("Output: microseconds since the start time, AxisValue.  Every alert also prints its local time.\n");
+          puts ("        Ctrl+\\ (SIGQUIT) prints the sample interval and stuck run histograms, they are also printed at exit.\n");
+
+          exit(EXIT_SUCCESS);
+          break;
+
+        case 'n':
+          if (verbose_flag) puts ("Disabling buffered standard output.\n");
+          setvbuf(stdout, NULL, _IONBF, 0);
+          break;
+
+        case 'm':
+          if (verbose_flag) printf ("Margin= '%s'\n", optarg);
+          cfg->margin = atoi(optarg);
+          break;
+
+        case 's':
+          if (verbose_flag) printf ("Sleep= '%s'\n", optarg);
+          cfg->sleep_Time = atoi(optarg);
+          if (cfg->sleep_Time < 1) { printf ("Wrong --sleep '%s'\n", optarg); goto HELP; }
+          break;
+
+        case 'i':
+          if (verbose_flag) printf ("Iterations= '%s'\n", optarg);
+          cfg->iterations = atoi(optarg);
+          break;
+
+        case 'j':
+          if (verbose_flag) printf ("JoystickID= '%s'\n", optarg);
+          cfg->joy_ID = atoi(optarg);
+          j = 1;
+          break;
+
+        case 'I':
+          if (verbose_flag) printf ("Device= '%s'\n", optarg);
+          if (cfg->device_Count >= FPM_MAX_DEVICES) { printf ("Too many --device, the joystick IDs go to %d\n", FPM_MAX_DEVICES - 1); goto HELP; }
+          snprintf(cfg->device_Paths[cfg->device_Count++], MAX_PATH, "%s", optarg);
+          break;
+
+        case 'd':
+            if (verbose_flag) printf ("Priority set to nice 19\n");
+            setpriority(PRIO_PROCESS, 0, 19);
+          break;
+
+        case 'b':
+            if (verbose_flag) printf ("Priority set to nice 10\n");
+            setpriority(PRIO_PROCESS, 0, 10);
+          break;
+
+        case 'l':
+            if (verbose_flag) printf ("Alert= '%s'\n", optarg);
+            cfg->alert_Command = optarg;
+            break;
+
+        case 'V':
+            cfg->alert_Value = 1;
+            break;
+
+        case 'g':
+            if (verbose_flag) printf ("Alert gap= '%s'\n", optarg);
+            cfg->alert_Gap = atoi(optarg);
+            break;
+
+        case 'w':
+            if (verbose_flag) printf ("Watch= '%s'\n", optarg);
+            if (WatchAdd(&cfg->watches, optarg) != 0) goto HELP;
+            break;
+
+        case 'r':
+            if (verbose_flag) printf ("Record= '%s'\n", optarg);
+            cfg->record_File = optarg;
+            break;
+
+        case 'T':
+            if (verbose_flag) printf ("Repeat ms= '%s'\n", optarg);
+            cfg->watches.default_repeat_ms = atoi(optarg);
+            if (cfg->watches.default_repeat_ms < 1) { printf ("Wrong --repeat_ms '%s'\n", optarg); goto HELP; }
+            break;
+
+        case 'N':
+            if (verbose_flag) printf ("Engine= '%s'\n", optarg);
+            int engine = DetectorEngineFromName(optarg);
+            if (engine < 0) { printf ("Unknown engine '%s'\n", optarg); goto HELP; }
+            cfg->watches.default_engine = engine;
+            break;
+
+        case 'A':
+            cfg->watches.observe = 1;
+            break;
+
+        case 'c':
+            if (verbose_flag) printf ("Cores= '%s'\n", optarg);
+            int cores = CoreChoiceFromName(optarg);
+            if (cores < 0) { printf ("Unknown --cores '%s'\n", optarg); goto HELP; }
+            cfg->cores = (CoreChoice)cores;
+            break;
+
+        case '?':
+          /* getopt_long already printed an error message. */
+          break;
+
+        default:
+          abort ();
+        }
+
+    }
+
+  if (verbose_flag)
+    puts ("Verbose flag is set");
+
+  /* Print any remaining command line arguments (not options). */
+  if (verbose_flag && optind < argc)
+    {
+      puts ("non-option ARGV-elements: ");
+      while (optind < argc)
+        printf ("%s ", argv[optind++]);
+      putchar ('\n');
+    }
+
+    if (!j && cfg->watches.spec_count == 0) goto HELP;
+
+}
+
+int main(int argc, char** argv) {
+
+    static LinuxConfig cfg; // static: the watch table is a few KB
+    cfg.joy_ID      = 17; // impossible value
+    cfg.iterations  = 1;
+    cfg.margin      = 5; // Percentage of closure where the axis values are considered the same
+    cfg.sleep_Time  = 1000;
+    cfg.alert_Gap   = 0;
+    cfg.alert_Command = "spd-say";
+    cfg.alert_Value = 0;
+    cfg.cores       = CORES_ANY;
+    cfg.record_File = NULL;
+    cfg.device_Count = 0;
+    WatchInit(&cfg.watches);
+
+    ParseCommandLine(argc, argv, &cfg);
+    // every report is a sample: the 4 samples of winmm (4 * sleep) become a time
+    if (cfg.watches.default_repeat_ms == 0) cfg.watches.default_repeat_ms = 4 * (int)cfg.sleep_Time;
+
+    /* Simplified Single Instance Checker */
+    if (PlatformSingleInstance() != 0) {
+        puts("Another instance is already running.");
+        exit(1);
+    }
+
+    WatchTable *wt = &cfg.watches;
+    WatchFinish(wt, cfg.joy_ID, cfg.margin);
+    cfg.cores = CoresApply(cfg.cores);
+
+    static char paths[FPM_MAX_DEVICES][MAX_PATH];
+    static uint32_t axis_Min[FPM_MAX_DEVICES][FPM_AXES], axis_Max[FPM_MAX_DEVICES][FPM_AXES];
+    for (int d = 0; d < wt->device_count; d++) {
+        if ((int)wt->joy_ID[d] < cfg.device_Count) snprintf(paths[d], MAX_PATH, "%s", cfg.device_Paths[wt->joy_ID[d]]);
+        else snprintf(paths[d], MAX_PATH, "/dev/input/event%u", wt->joy_ID[d]);
+        if (verbose_flag) printf("Requested Joystick ID=[%u] device=[%s]\n", wt->joy_ID[d], paths[d]);
+    }
+
+    if (verbose_flag) printf("Requested Margin=[%u]\n", cfg.margin);
+    int64_t start_Unix = PlatformUnixMicroseconds();
+    if (EvdevOpen(paths, wt->device_count, axis_Min, axis_Max) != 0) {
+        puts("Could not open the input devices, is the user in the input group?");
+        exit(1);
+    }
+    for (int d = 0; d < wt->device_count; d++)
+        WatchCalibrate(wt, d, axis_Min[d], axis_Max[d]);
+    if (verbose_flag) WatchPrint(wt);
+
+    static FpmHeader fh; // what --record writes first
+    if (cfg.record_File) {
+        MonitorFillHeader(&fh, wt, cfg.margin, 0, 0, start_Unix); // period 0: follows the pedals
+        for (int d = 0; d < wt->device_count; d++) fh.devices[d].joy_ID = wt->joy_ID[d];
+        if (RecorderOpen(cfg.record_File, &fh) != 0) {
+            printf("Could not create the recording [%s]\n", cfg.record_File);
+            cfg.record_File = NULL;
+        }
+    }
+
+    StatsInit(&monitor_stats);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SignalHandler; // no SA_RESTART: epoll_wait() returns at once
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGQUIT, &sa, NULL);
+
+    printf("Fanatec Monitoring is active.\n");
+    char when[48];
+    PlatformFormatTime(start_Unix, when, sizeof(when));
+    printf("Start time=[%s], timestamps are microseconds since then.  Ctrl+\\ prints the statistics.\n", when);
+
+    const int64_t sleep_us = (int64_t)cfg.sleep_Time * 1000;
+    const int64_t stop_Time = (int64_t)cfg.iterations * sleep_us;
+    int64_t last_Seen[FPM_MAX_DEVICES]; // t_us of the last sample of every device, for the repeat
+    int device_Gone[FPM_MAX_DEVICES];
+    for (int d = 0; d < wt->device_count; d++) {
+        last_Seen[d] = 0;
+        device_Gone[d] = 0;
+    }
+
+    alert_Config = &cfg;
+    Monitor monitor = { wt, &monitor_stats, start_Unix, PrintLine, PrintValue, MonitorAlert, PlatformFormatTime };
+    FpmSample s;
+    int repeat_Device = 0;
+    while (!stop_requested) {
+        if (report_requested) {
+            report_requested = 0;
+            PrintReport(&cfg);
+        }
+
+        int64_t now = EvdevNow();
+        if (now >= stop_Time) break;
+        int r = 0;
+        for (; repeat_Device < wt->device_count; repeat_Device++) // quiet devices first, one sample per turn
+            if (now - last_Seen[repeat_Device] >= sleep_us) {
+                EvdevLast(repeat_Device++, &s);
+                r = 1;
+                break;
+            }
+        if (r == 0) {
+            repeat_Device = 0;
+            int64_t wake = stop_Time;
+            for (int d = 0; d < wt->device_count; d++)
+                if (last_Seen[d] + sleep_us < wake) wake = last_Seen[d] + sleep_us;
+            int timeout_ms = wake > now ? (int)((wake - now + 999) / 1000) : 0;
+            r = EvdevWait(&s, timeout_ms);
+            if (r < 0) {
+                perror("epoll_wait");
+                break;
+            }
+            if (r == 0) continue; // timeout or a signal
+        }
+        last_Seen[s.device] = s.t_us;
+
+        if (s.status != JOYERR_NOERROR && !device_Gone[s.device]) {
+            device_Gone[s.device] = 1;
+            printf("Joystick %u: %s is gone, waiting for it to come back\n", wt->joy_ID[s.device], paths[s.device]);
+        } else if (s.status == JOYERR_NOERROR && device_Gone[s.device]) {
+            device_Gone[s.device] = 0;
+            printf("Joystick %u is back\n", wt->joy_ID[s.device]);
+        }
+
+        uint16_t run_Before[MAX_WATCHES];
+        uint32_t alerts = MonitorDetect(&monitor, &s, run_Before);
+        if (cfg.record_File) RecorderWrite(&s);
+        MonitorOutput(&monitor, &s, alerts); // stuck values, alerts
+    }
+
+    EvdevClose();
+    PrintReport(&cfg);
+    if (cfg.record_File) {
+        RecorderClose();
+        printf("Recorded samples=[%llu] bytes=[%llu] file=[%s]\n", (unsigned long long)RecorderSamples(), (unsigned long long)RecorderBytes(), cfg.record_File);
+    }
+
+    return (EXIT_SUCCESS);
+}
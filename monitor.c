@@ -0,0 +1,80 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   monitor.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "monitor.h"
+#include "detector.h"
+
+extern int verbose_flag; /* main.c */
+
+
+uint32_t MonitorDetect(Monitor *m, const FpmSample *s, uint16_t *run_before) {
+    WatchTable *wt = m->watches;
+    char line[MONITOR_LINE];
+
+    memcpy(run_before + wt->first[s->device], wt->run + wt->first[s->device], wt->n[s->device] * sizeof(run_before[0]));
+    StatsSample(m->stats, s);
+    uint32_t alerts = DetectorFeed(wt, s);
+    if (wt->observe && WatchObserve(wt, s) && verbose_flag) {
+        int w_Last = wt->first[s->device] + wt->n[s->device];
+        for (int w = wt->first[s->device]; w < w_Last; w++) {
+            snprintf(line, sizeof(line), "Calibrated %s: range=[%lu..%lu] gate rest=[%lu] margin=[%ld]", wt->specs[w].name,
+                     (unsigned long)wt->axis_min[w], (unsigned long)wt->rest[w], (unsigned long)wt->gate_rest[w], (long)wt->margin[w]);
+            m->text(line);
+        }
+    }
+    StatsRuns(m->stats, wt, s->device, run_before, alerts);
+    return alerts;
+}
+
+
+void MonitorOutput(Monitor *m, const FpmSample *s, uint32_t alerts) {
+    const WatchTable *wt = m->watches;
+    char line[MONITOR_LINE], when[48];
+
+    int w_End = wt->first[s->device] + wt->n[s->device];
+    for (int w = wt->first[s->device]; w < w_End; w++) {
+        uint32_t axis = s->axes[wt->axis[w]];
+
+        // verbose prints every value, otherwise only the ones that look stuck
+        if (verbose_flag || wt->run[w] || (alerts & (1u << w)))
+            m->value(s->t_us, wt->count == 1 ? NULL : wt->specs[w].name, axis);
+
+        if (alerts & (1u << w)) {
+            m->alert(w, axis, s->t_us); // tell the user that the pedal is failing
+            m->format_time(m->start_unix_us + s->t_us, when, sizeof(when));
+            snprintf(line, sizeof(line), "Alert time=[%s] t=[%lld] %s=[%lu]", when, (long long)s->t_us, wt->specs[w].name, (unsigned long)axis);
+            m->text(line);
+        }
+    }
+}
+
+
+void MonitorFillHeader(FpmHeader *fh, const WatchTable *wt, UINT default_margin_pct, uint32_t flags, uint32_t period_us, int64_t start_unix_us) {
+    fh->flags = flags;
+    fh->period_us = period_us;
+    fh->start_unix_us = start_unix_us;
+    fh->device_count = wt->device_count;
+    fh->watch_count = wt->count;
+    for (int w = 0; w < wt->count; w++) {
+        FpmWatchInfo *fw = &fh->watches[w];
+        fw->device = wt->device[w];
+        fw->axis = wt->axis[w];
+        fw->gate_axis = wt->gate_axis[w];
+        fw->margin_pct = (uint8_t)(wt->specs[w].margin_pct >= 0 ? wt->specs[w].margin_pct : (int)default_margin_pct);
+        fw->repeat = wt->repeat[w];
+        fw->gate_rest = wt->gate_rest[w];
+        fw->rest = wt->rest[w];
+        strncpy(fw->name, wt->specs[w].name, FPM_NAME_SIZE - 1);
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   monitor.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * What the live monitor does with every sample, the same in main.c and main_linux.c: statistics, the
+ * detector, --calibrate, then the value lines and the alerts of the watches of the device.  How a line
+ * is written and how an alert is said is up to the main of each system (the log thread and SAPI on
+ * Windows, stdout and a command on Linux).  What a main does with the sample in between (recorder,
+ * telemetry, heatmap, trend) goes between MonitorDetect() and MonitorOutput().
+ */
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+#include "sample.h"
+#include "watch.h"
+#include "stats.h"
+#include "recorder.h"
+
+#define MONITOR_LINE 128   // LOG_LINE_MAX
+
+typedef struct {
+    WatchTable *watches;
+    MonitorStats *stats;
+    int64_t start_unix_us;  // wall clock of t_us == 0, for the alert lines
+    void (*text)(const char *line);                                 // '\n' is added
+    void (*value)(int64_t t_us, const char *name, uint32_t value);  // name NULL with a single watch
+    void (*alert)(int w, uint32_t value, int64_t t_us);             // returns immediately
+    void (*format_time)(int64_t unix_us, char *out, size_t size);
+} Monitor;
+
+/* Statistics, DetectorFeed() and --calibrate.  Fills run_before for the watches of s->device with the runs
+ * before the sample, returns the alert mask of DetectorFeed() */
+uint32_t MonitorDetect(Monitor *m, const FpmSample *s, uint16_t *run_before);
+
+/* The values that look stuck (every value with --verbose), then the alerts with their local time */
+void MonitorOutput(Monitor *m, const FpmSample *s, uint32_t alerts);
+
+/* What --record writes first */
+void MonitorFillHeader(FpmHeader *fh, const WatchTable *wt, UINT default_margin_pct, uint32_t flags, uint32_t period_us, int64_t start_unix_us);
+
+#endif /* MONITOR_H */
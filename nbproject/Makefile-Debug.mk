@@ -35,7 +35,36 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
-	${OBJECTDIR}/main.o
+	${OBJECTDIR}/alert.o \
+	${OBJECTDIR}/bench.o \
+	${OBJECTDIR}/control.o \
+	${OBJECTDIR}/cores.o \
+	${OBJECTDIR}/detector.o \
+	${OBJECTDIR}/etw.o \
+	${OBJECTDIR}/footprint.o \
+	${OBJECTDIR}/game.o \
+	${OBJECTDIR}/heatmap.o \
+	${OBJECTDIR}/hist.o \
+	${OBJECTDIR}/hotplug.o \
+	${OBJECTDIR}/input_dinput8.o \
+	${OBJECTDIR}/input_winmm.o \
+	${OBJECTDIR}/log.o \
+	${OBJECTDIR}/main.o \
+	${OBJECTDIR}/monitor.o \
+	${OBJECTDIR}/noise.o \
+	${OBJECTDIR}/pipeline.o \
+	${OBJECTDIR}/rawinput.o \
+	${OBJECTDIR}/recorder.o \
+	${OBJECTDIR}/replay.o \
+	${OBJECTDIR}/resources.o \
+	${OBJECTDIR}/sampler.o \
+	${OBJECTDIR}/stats.o \
+	${OBJECTDIR}/sweep.o \
+	${OBJECTDIR}/telemetry.o \
+	${OBJECTDIR}/timer.o \
+	${OBJECTDIR}/trend.o \
+	${OBJECTDIR}/vjoy.o \
+	${OBJECTDIR}/watch.o
 
 
 # C Compiler Flags
@@ -52,7 +81,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=../../../../../Windows/System32/winmm.dll
+LDLIBSOPTIONS=../../../../../Windows/System32/winmm.dll -lole32 -lhid -ldinput8 -lpsapi
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -64,12 +93,157 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/fanatecmonitor.exe: ${OBJECTFILES}
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
 	${LINK.c} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/fanatecmonitor ${OBJECTFILES} ${LDLIBSOPTIONS}
 
+${OBJECTDIR}/alert.o: alert.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/alert.o alert.c
+
+${OBJECTDIR}/bench.o: bench.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench.o bench.c
+
+${OBJECTDIR}/control.o: control.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/control.o control.c
+
+${OBJECTDIR}/cores.o: cores.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/cores.o cores.c
+
+${OBJECTDIR}/detector.o: detector.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/detector.o detector.c
+
+${OBJECTDIR}/etw.o: etw.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/etw.o etw.c
+
+${OBJECTDIR}/footprint.o: footprint.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/footprint.o footprint.c
+
+${OBJECTDIR}/game.o: game.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/game.o game.c
+
+${OBJECTDIR}/heatmap.o: heatmap.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/heatmap.o heatmap.c
+
+${OBJECTDIR}/hist.o: hist.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/hist.o hist.c
+
+${OBJECTDIR}/hotplug.o: hotplug.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/hotplug.o hotplug.c
+
+${OBJECTDIR}/input_dinput8.o: input_dinput8.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/input_dinput8.o input_dinput8.c
+
+${OBJECTDIR}/input_winmm.o: input_winmm.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/input_winmm.o input_winmm.c
+
+${OBJECTDIR}/log.o: log.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/log.o log.c
+
 ${OBJECTDIR}/main.o: main.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/main.o main.c
 
 # Subprojects
+${OBJECTDIR}/monitor.o: monitor.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/monitor.o monitor.c
+
+${OBJECTDIR}/noise.o: noise.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/noise.o noise.c
+
+${OBJECTDIR}/pipeline.o: pipeline.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/pipeline.o pipeline.c
+
+${OBJECTDIR}/rawinput.o: rawinput.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/rawinput.o rawinput.c
+
+${OBJECTDIR}/recorder.o: recorder.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/recorder.o recorder.c
+
+${OBJECTDIR}/replay.o: replay.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/replay.o replay.c
+
+${OBJECTDIR}/resources.o: resources.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/resources.o resources.c
+
+${OBJECTDIR}/sampler.o: sampler.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/sampler.o sampler.c
+
+${OBJECTDIR}/stats.o: stats.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/stats.o stats.c
+
+${OBJECTDIR}/sweep.o: sweep.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/sweep.o sweep.c
+
+${OBJECTDIR}/telemetry.o: telemetry.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/telemetry.o telemetry.c
+
+${OBJECTDIR}/timer.o: timer.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/timer.o timer.c
+
+${OBJECTDIR}/trend.o: trend.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/trend.o trend.c
+
+${OBJECTDIR}/vjoy.o: vjoy.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/vjoy.o vjoy.c
+
+${OBJECTDIR}/watch.o: watch.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -g -std=c11 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/watch.o watch.c
+
 .build-subprojects:
 
 # Clean Targets
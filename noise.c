@@ -0,0 +1,87 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   noise.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * float on purpose: the estimates only need a few significant digits and it keeps NoiseState small.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "noise.h"
+
+
+static float Clamp01(float v) {
+    return v < 0 ? 0 : v > 1 ? 1 : v;
+}
+
+
+void NoiseReset(NoiseState *n) {
+    memset(n, 0, sizeof(*n));
+}
+
+
+int NoiseStep(NoiseState *n, uint32_t axis, int active, int64_t t_us, int32_t margin, uint32_t repeat, uint32_t repeat_us) {
+    if (n->last_t && t_us > n->last_t) {
+        float dt = (float)(t_us - n->last_t);
+        n->interval_us = n->interval_us > 0 ? n->interval_us + NOISE_ALPHA * (dt - n->interval_us) : dt;
+    }
+    n->last_t = t_us;
+
+    if (!active) {
+        n->active = 0;
+        n->score = 0;
+        n->last = axis;
+        return 0;
+    }
+    if (!n->active) { // starts over from this value
+        n->active = 1;
+        n->mean = (float)axis;
+        n->var = n->drift = n->reversals = 0;
+        n->direction = 0;
+        n->since_us = t_us;
+        n->last = axis;
+        n->score = 0;
+        return 0;
+    }
+
+    float x = (float)axis;
+    float delta = x - (float)n->last;
+    n->last = axis;
+
+    // Welford style EWMA: the variance uses the distance to the mean before and after the update
+    float diff = x - n->mean;
+    n->mean += NOISE_ALPHA * diff;
+    n->var = (1 - NOISE_ALPHA) * (n->var + NOISE_ALPHA * diff * diff);
+    n->drift += NOISE_ALPHA * (delta - n->drift);
+
+    int8_t dir = delta > 0 ? 1 : delta < 0 ? -1 : 0;
+    float reversal = (dir != 0 && n->direction != 0 && dir != n->direction) ? 1.0f : 0.0f;
+    n->reversals += NOISE_REVERSAL_ALPHA * (reversal - n->reversals);
+    if (dir != 0) n->direction = dir;
+
+    float target_us = repeat_us ? (float)repeat_us : (float)repeat * (n->interval_us > 0 ? n->interval_us : 1000.0f);
+    float samples = n->interval_us > 0 ? target_us / n->interval_us : (float)repeat;
+    float m = margin > 0 ? (float)margin : 1.0f;
+
+    float sd = sqrtf(n->var);
+    float still = sd <= m ? 1.0f : Clamp01((4 * m - sd) / (3 * m)); // within the margin, fading out up to 4 margins
+    float drift = Clamp01(fabsf(n->drift) * samples / (2 * m));     // would move more than 2 margins over the target
+    float noisy = still * (1 - drift);
+    if (n->reversals > noisy) noisy = n->reversals;
+    float dwell = Clamp01((float)(t_us - n->since_us) / target_us);
+    n->score = dwell * noisy;
+
+    if (dwell >= 1 && noisy >= NOISE_THRESHOLD) {
+        n->since_us = t_us;
+        n->score = 0;
+        return 1;
+    }
+    return 0;
+}
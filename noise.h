@@ -0,0 +1,55 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   noise.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The "stat" detector engine (--engine stat).  The closure rule only looks at the last two samples:
+ * a sensor that jitters a little more than the margin never fills the run, and a slow deliberate press
+ * that moves less than the margin per sample fills it.  This engine keeps, for every watch, streaming
+ * estimates over the samples where the gate is idle and the axis is off rest:
+ *      EWMA mean and variance of the value          a stuck or noisy sensor stays in a narrow band
+ *      EWMA of the signed delta (drift)             a press keeps going in one direction
+ *      EWMA rate of direction reversals             noise goes back and forth
+ *      dwell time off rest                          how long it has been like this
+ * The score is min(1, dwell / target) * max(still * (1 - drift), reversals), and it alerts when the dwell
+ * reached the target with max(...) at NOISE_THRESHOLD or more: a score of NOISE_THRESHOLD..1.
+ * target is the repeat in ms, or repeat times the measured sample interval.
+ * Constant memory, a few multiplications per sample, no allocation.
+ */
+
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <stdint.h>
+
+#define NOISE_THRESHOLD 0.6f
+#define NOISE_ALPHA (1.0f / 16)      // mean, variance and drift
+#define NOISE_REVERSAL_ALPHA (1.0f / 8)
+
+typedef struct {
+    float mean, var;
+    float drift;                     // EWMA of axis - previous axis
+    float reversals;                 // EWMA of 1 per reversal, 0 otherwise
+    float interval_us;               // EWMA of the sample interval, 0: unknown yet
+    float score;                     // of the latest sample, for --verbose and the telemetry
+    int8_t direction;                // sign of the last delta that was not 0
+    uint8_t active;                  // the previous sample was gate idle and off rest
+    uint32_t last;
+    int64_t last_t;
+    int64_t since_us;                // t_us when it became active, or of the last alert
+} NoiseState;
+
+void NoiseReset(NoiseState *n);
+
+/*
+ * One sample.  active: the gate is idle and the axis is off rest.  margin in axis units, repeat in samples,
+ * repeat_us > 0 replaces repeat.  Returns 1 on alert, the dwell starts again then.
+ */
+int NoiseStep(NoiseState *n, uint32_t axis, int active, int64_t t_us, int32_t margin, uint32_t repeat, uint32_t repeat_us);
+
+#endif /* NOISE_H */
@@ -0,0 +1,227 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   pipeline.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "windows.h"
+
+#include "pipeline.h"
+#include "ring.h"
+
+#define PIPE_MASK (PIPE_DEPTH - 1)
+#define PIPE_BLOCK_WAIT_MS 100   // a blocked detector looks again this often, in case the sink misses a wake up
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_uint head;    // batch being filled, written by the detect thread
+    _Alignas(CACHE_LINE) atomic_uint tail;    // next batch to consume, written by the sink thread
+    _Alignas(CACHE_LINE) atomic_int sink_waiting;
+    atomic_int detect_waiting;
+    atomic_int stop;
+    const char *name;
+    SinkFn consume;
+    void *context;
+    SinkPolicy policy;
+    int priority;
+    UINT max_delay_ms;
+    int active;
+    HANDLE thread;
+    HANDLE data_event;       // auto-reset, a batch was handed over
+    HANDLE space_event;      // auto-reset, a batch was consumed
+    ULONGLONG batches, samples, dropped, blocked;   // detect thread
+    _Alignas(CACHE_LINE) PipeBatch slots[PIPE_DEPTH];
+} Sink;
+
+static Sink sinks[PIPE_MAX_SINKS];
+static int sink_count = 0;
+static const WatchTable *watches = NULL;
+
+
+static DWORD WINAPI SinkThread(LPVOID param) {
+    Sink *k = (Sink *)param;
+    for (;;) {
+        unsigned tail = atomic_load_explicit(&k->tail, memory_order_relaxed);
+        while (tail != atomic_load_explicit(&k->head, memory_order_acquire)) {
+            k->consume(&k->slots[tail & PIPE_MASK], k->context);
+            atomic_store_explicit(&k->tail, ++tail, memory_order_release);
+            atomic_thread_fence(memory_order_seq_cst);
+            if (atomic_exchange(&k->detect_waiting, 0)) SetEvent(k->space_event);
+        }
+        if (atomic_load(&k->stop)) break;
+
+        atomic_store(&k->sink_waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (tail == atomic_load(&k->head) && !atomic_load(&k->stop)) WaitForSingleObject(k->data_event, INFINITE);
+        atomic_store(&k->sink_waiting, 0);
+    }
+    return 0;
+}
+
+
+int PipelineAddSink(const char *name, SinkFn consume, void *context, SinkPolicy policy, int priority, UINT max_delay_ms) {
+    if (sink_count == PIPE_MAX_SINKS) return -1;
+    Sink *k = &sinks[sink_count];
+    k->name = name;
+    k->consume = consume;
+    k->context = context;
+    k->policy = policy;
+    k->priority = priority;
+    k->max_delay_ms = max_delay_ms;
+    k->active = 1;
+    return sink_count++;
+}
+
+
+int PipelineStart(const WatchTable *wt) {
+    watches = wt;
+    for (int i = 0; i < sink_count; i++) {
+        Sink *k = &sinks[i];
+        atomic_init(&k->head, 0);
+        atomic_init(&k->tail, 0);
+        atomic_init(&k->sink_waiting, 0);
+        atomic_init(&k->detect_waiting, 0);
+        atomic_init(&k->stop, 0);
+        k->slots[0].count = 0;
+        k->batches = k->samples = k->dropped = k->blocked = 0;
+        k->data_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+        k->space_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+        k->thread = CreateThread(NULL, 0, SinkThread, k, 0, NULL);
+        if (k->thread == NULL) {
+            printf("Could not create the %s thread\n", k->name);
+            sink_count = i; // the ones before keep running, PipelineStop() ends them
+            return -1;
+        }
+        SetThreadPriority(k->thread, k->priority);
+    }
+    return 0;
+}
+
+
+/* The batch being filled goes to the sink, unless its queue is full and it may be dropped */
+static void Publish(Sink *k) {
+    unsigned head = atomic_load_explicit(&k->head, memory_order_relaxed);
+    PipeBatch *b = &k->slots[head & PIPE_MASK];
+    if (b->count == 0) return;
+
+    // head + 1 must stay free: it is the next batch to fill
+    while (head + 1 - atomic_load_explicit(&k->tail, memory_order_acquire) >= PIPE_DEPTH) {
+        if (k->policy == SINK_DROP) {
+            k->dropped += b->count;
+            b->count = 0;
+            return;
+        }
+        k->blocked++;
+        atomic_store(&k->detect_waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (head + 1 - atomic_load(&k->tail) >= PIPE_DEPTH) WaitForSingleObject(k->space_event, PIPE_BLOCK_WAIT_MS);
+        atomic_store(&k->detect_waiting, 0);
+    }
+    k->batches++;
+    k->samples += b->count;
+    k->slots[(head + 1) & PIPE_MASK].count = 0;
+    atomic_store_explicit(&k->head, head + 1, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst); // the batch must be visible before we look at sink_waiting
+    if (atomic_exchange(&k->sink_waiting, 0)) SetEvent(k->data_event);
+}
+
+
+void PipelineSetActive(int sink, int active) {
+    if (sink < 0 || sink >= sink_count) return;
+    PipelineSync(sink);
+    sinks[sink].active = active;
+}
+
+
+void PipelinePush(const FpmSample *s, uint32_t alerts) {
+    int first = watches->first[s->device], n = watches->n[s->device];
+    for (int i = 0; i < sink_count; i++) {
+        Sink *k = &sinks[i];
+        if (!k->active) continue;
+        PipeBatch *b = &k->slots[atomic_load_explicit(&k->head, memory_order_relaxed) & PIPE_MASK];
+        if (b->count == 0) b->started = GetTickCount64();
+        PipeItem *it = &b->items[b->count++];
+        it->s = *s;
+        it->alerts = alerts;
+        memcpy(it->run + first, watches->run + first, n * sizeof(it->run[0]));
+        if (b->count == PIPE_BATCH) Publish(k);
+    }
+}
+
+
+void PipelinePoll(void) {
+    ULONGLONG now = 0;
+    for (int i = 0; i < sink_count; i++) {
+        Sink *k = &sinks[i];
+        const PipeBatch *b = &k->slots[atomic_load_explicit(&k->head, memory_order_relaxed) & PIPE_MASK];
+        if (b->count == 0) continue;
+        if (k->max_delay_ms && now == 0) now = GetTickCount64();
+        if (k->max_delay_ms == 0 || now - b->started >= k->max_delay_ms) Publish(k);
+    }
+}
+
+
+void PipelineSync(int sink) {
+    if (sink < 0 || sink >= sink_count) return;
+    Sink *k = &sinks[sink];
+    SinkPolicy policy = k->policy;
+    k->policy = SINK_BLOCK; // what is pending is handed over, whatever the policy is
+    Publish(k);
+    k->policy = policy;
+    while (atomic_load_explicit(&k->tail, memory_order_acquire) != atomic_load_explicit(&k->head, memory_order_relaxed)) {
+        atomic_store(&k->detect_waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load(&k->tail) != atomic_load(&k->head)) WaitForSingleObject(k->space_event, PIPE_BLOCK_WAIT_MS);
+        atomic_store(&k->detect_waiting, 0);
+    }
+}
+
+
+void PipelineLower(int lower) {
+    for (int i = 0; i < sink_count; i++) {
+        const Sink *k = &sinks[i];
+        SetThreadPriority(k->thread, lower && k->priority > THREAD_PRIORITY_LOWEST ? k->priority - 1 : k->priority);
+    }
+}
+
+
+HANDLE PipelineThreadHandle(int sink) {
+    return sink >= 0 && sink < sink_count ? sinks[sink].thread : NULL;
+}
+
+
+const char *PipelineSinkName(int sink) {
+    return sink >= 0 && sink < sink_count ? sinks[sink].name : "";
+}
+
+
+void PipelineReport(void) {
+    for (int i = 0; i < sink_count; i++) {
+        const Sink *k = &sinks[i];
+        printf("Sink %s: batches=[%llu] samples=[%llu] samples/batch=[%.1f] dropped=[%llu] detector waits=[%llu]\n", k->name,
+               k->batches, k->samples, k->batches ? (double)k->samples / k->batches : 0.0, k->dropped, k->blocked);
+    }
+}
+
+
+void PipelineStop(void) {
+    for (int i = 0; i < sink_count; i++) {
+        Sink *k = &sinks[i];
+        PipelineSync(i);
+        atomic_store(&k->stop, 1);
+        SetEvent(k->data_event);
+        WaitForSingleObject(k->thread, INFINITE);
+        CloseHandle(k->thread);
+        CloseHandle(k->data_event);
+        CloseHandle(k->space_event);
+        k->thread = NULL;
+    }
+    sink_count = 0;
+}
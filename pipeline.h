@@ -0,0 +1,90 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   pipeline.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The live monitor as stages, every one on its own thread:
+ *      acquire     sampler.c, reads and stamps the samples.  SPSC ring, drops and counts when full
+ *      detect      the main thread: calibration, detector, statistics, heatmap, trend, log lines and alert
+ *                  posts, over the batch SamplerNextBatch() returns instead of one sample at a time
+ *      sinks       the expensive outputs, fed from here: the recorder and the shared memory telemetry
+ *      (console)   log.c and the alert thread already were stages of their own, with their own queues
+ *
+ * A sink gets batches of up to PIPE_BATCH samples, each with the alert mask and the stuck runs the
+ * detector had for it, through a queue of PIPE_DEPTH batches of its own (one of them is the batch being
+ * filled).  A batch is handed over when it is full or when it is max_delay_ms old, so a sink thread
+ * wakes up once per batch and finds it in cache next to the previous one.  The policy says what happens
+ * when a sink falls behind and its queue is full:
+ *      SINK_DROP   the batch is dropped and counted, the detector never waits (telemetry)
+ *      SINK_BLOCK  the detector waits for a free batch, nothing is lost (recorder); the acquire ring
+ *                  keeps the sampling cadence meanwhile
+ * Every sink has a thread priority, and with --cores the process placement and its EcoQoS like every
+ * thread but the sampler.  Only the detect thread calls these, except what the sink callbacks do.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include "windows.h"
+#include "sample.h"
+#include "watch.h"
+
+#define PIPE_BATCH 64
+#define PIPE_DEPTH 8          // batches per sink, power of two
+#define PIPE_MAX_SINKS 4
+
+typedef enum {
+    SINK_DROP = 0,
+    SINK_BLOCK
+} SinkPolicy;
+
+typedef struct {
+    FpmSample s;
+    uint32_t alerts;               // DetectorFeed() of this sample
+    uint16_t run[MAX_WATCHES];     // wt->run after it, only the watches of s.device
+} PipeItem;
+
+typedef struct {
+    int count;
+    ULONGLONG started;             // GetTickCount64() of the first item
+    PipeItem items[PIPE_BATCH];
+} PipeBatch;
+
+/* On the thread of the sink, one batch at a time */
+typedef void (*SinkFn)(const PipeBatch *batch, void *context);
+
+/* Before PipelineStart().  Returns the sink number, -1 if there are PIPE_MAX_SINKS already */
+int  PipelineAddSink(const char *name, SinkFn consume, void *context, SinkPolicy policy, int priority, UINT max_delay_ms);
+
+/* Returns 0 when every sink thread runs */
+int  PipelineStart(const WatchTable *wt);
+
+/* An inactive sink gets nothing, it starts and stops after what was handed over is consumed */
+void PipelineSetActive(int sink, int active);
+
+/* After DetectorFeed(), alerts is the mask it returned */
+void PipelinePush(const FpmSample *s, uint32_t alerts);
+
+/* Hands over the batches older than the delay of their sink, once after every batch of samples */
+void PipelinePoll(void);
+
+/* Hands over and waits until the sink consumed everything: the detect thread can touch its state then */
+void PipelineSync(int sink);
+
+/* --games: every sink thread one step below its own priority (lower), or back to it */
+void PipelineLower(int lower);
+
+HANDLE PipelineThreadHandle(int sink);        // for --resources
+const char *PipelineSinkName(int sink);
+void PipelineReport(void);
+
+/* Hands over what is left and waits for every sink to finish it */
+void PipelineStop(void);
+
+#endif /* PIPELINE_H */
@@ -0,0 +1,62 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   platform.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * What the portable core (detector, noise, watch, recorder, hist, stats) needs from the system: the
+ * Win32 integer types it was written with.  On Windows this is windows.h, anywhere else the few types
+ * and constants are defined here, and the Linux build (make linux, main_linux.c) gets the calls that
+ * replace CreateMutex(), system() and SetPriorityClass() from platform_linux.c.
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#ifdef _WIN32
+
+#include "windows.h"
+
+#else
+
+#include <stddef.h>
+#include <stdint.h>
+#include <strings.h>
+
+typedef unsigned int UINT;
+typedef uint32_t DWORD;
+typedef uint16_t WORD;
+typedef int32_t LONG;
+typedef int BOOL;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+
+#define MAX_PATH 4096
+#define _stricmp strcasecmp
+#define JOYERR_NOERROR 0
+#define JOYERR_UNPLUGGED 167
+
+/* Monotonic microseconds, the clock of FpmSample.t_us before the start is subtracted */
+int64_t PlatformMicroseconds(void);
+int64_t PlatformUnixMicroseconds(void);
+void PlatformFormatTime(int64_t unix_us, char *out, size_t size);
+
+/* Abstract socket @fanatec_monitor_single_instance, freed by the kernel when the process ends.
+ * Returns 0 when no other monitor runs */
+int  PlatformSingleInstance(void);
+
+/* Runs command with the name (and the value) as arguments, without waiting.  An alert of an id whose
+ * command still runs is coalesced, one closer than gap_ms to the previous alert is dropped.
+ * Returns 1 when the command was started */
+int  PlatformAlert(const char *command, int id, const char *name, uint32_t value, int with_value, UINT gap_ms);
+
+/* Alerts started, coalesced and dropped so far */
+void PlatformAlertStats(long *spoken, long *coalesced, long *dropped);
+
+#endif /* _WIN32 */
+
+#endif /* PLATFORM_H */
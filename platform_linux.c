@@ -0,0 +1,122 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   platform_linux.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "platform.h"
+#include "watch.h"
+
+#define ALERT_MAX_IDS MAX_WATCHES
+
+extern char **environ;
+
+static pid_t alert_pid[ALERT_MAX_IDS];   // 0: nothing running for that id
+static int64_t last_alert_us = 0;
+static long spoken = 0, coalesced = 0, dropped = 0;
+
+
+int64_t PlatformMicroseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+int64_t PlatformUnixMicroseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+void PlatformFormatTime(int64_t unix_us, char *out, size_t size) {
+    time_t secs = (time_t)(unix_us / 1000000);
+    struct tm lt;
+    char when[32];
+
+    if (localtime_r(&secs, &lt) == NULL || strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &lt) == 0) {
+        snprintf(out, size, "%lld us", (long long)unix_us);
+        return;
+    }
+    snprintf(out, size, "%s.%06d", when, (int)(unix_us % 1000000));
+}
+
+
+int PlatformSingleInstance(void) {
+    static int fd = -1; // kept open until exit, it is the lock
+    static const char name[] = "\0fanatec_monitor_single_instance";
+    struct sockaddr_un addr;
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return 0; // no sockets: don't stop the monitor because of the check
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, name, sizeof(name) - 1);
+    if (bind(fd, (struct sockaddr *)&addr, (socklen_t)(offsetof(struct sockaddr_un, sun_path) + sizeof(name) - 1)) != 0) {
+        close(fd);
+        fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+
+static void Reap(void) {
+    pid_t pid;
+    int status;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+        for (int i = 0; i < ALERT_MAX_IDS; i++)
+            if (alert_pid[i] == pid) alert_pid[i] = 0;
+}
+
+
+int PlatformAlert(const char *command, int id, const char *name, uint32_t value, int with_value, UINT gap_ms) {
+    Reap();
+    if (id < 0 || id >= ALERT_MAX_IDS) id = 0;
+    if (alert_pid[id]) {
+        coalesced++;
+        return 0;
+    }
+    int64_t now = PlatformMicroseconds();
+    if (gap_ms && last_alert_us && now - last_alert_us < (int64_t)gap_ms * 1000) {
+        dropped++;
+        return 0;
+    }
+
+    char digits[16];
+    snprintf(digits, sizeof(digits), "%u", value);
+    char *argv[] = { (char *)command, (char *)name, with_value ? digits : NULL, NULL };
+    pid_t pid;
+    if (posix_spawnp(&pid, command, NULL, NULL, argv, environ) != 0) {
+        dropped++;
+        return 0;
+    }
+    alert_pid[id] = pid;
+    last_alert_us = now;
+    spoken++;
+    return 1;
+}
+
+
+void PlatformAlertStats(long *s, long *c, long *d) {
+    Reap();
+    *s = spoken;
+    *c = coalesced;
+    *d = dropped;
+}
@@ -0,0 +1,304 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   rawinput.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * WM_INPUT backend.  The HID report is decoded with HidP_GetUsageValue() and copied into the same
+ * JOYINFOEX fields that joyGetPosEx() fills, so the stickiness detector in main() doesn't know the
+ * difference.  HID usages are mapped like winmm does for a plain joystick:
+ *      X->dwXpos  Y->dwYpos  Z->dwZpos  Rz->dwRpos  Rx->dwUpos  Ry->dwVpos  buttons 1-32->dwButtons
+ *
+ * I had to add hid in
+ * Run->Set-Project-Configuration->Customize->Build->Linker->Libraries->Add-Library
+ * for HidP_GetUsageValue()
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "windows.h"
+#include <hidusage.h>
+#include <hidpi.h>
+
+#include "rawinput.h"
+
+extern int verbose_flag; /* main.c */
+
+#define RAW_AXES 6
+#define MAX_VALUE_CAPS 32
+#define MAX_KNOWN_DEVICES 32
+#define MAX_RAW_DEVICES 16
+
+static const USAGE axis_usage[RAW_AXES] = { 0x30, 0x31, 0x32, 0x35, 0x33, 0x34 }; // X Y Z Rz Rx Ry, in JOYINFOEX order
+
+typedef struct {
+    HANDLE hDevice;
+    int device;          // index in the joy_IDs given to RawInputOpen(), -1 if it's not one of ours
+} KnownDevice;
+
+typedef struct {
+    WORD vid, pid;
+    HANDLE hDevice;      // handle the preparsed data belongs to
+    PHIDP_PREPARSED_DATA preparsed;
+    UINT preparsed_capacity;    // kept across reconnects, only grows
+    int has_axis[RAW_AXES];
+    LONG axis_min[RAW_AXES], axis_max[RAW_AXES];
+    USHORT axis_bits[RAW_AXES];
+    DWORD last_axes[RAW_AXES];
+    DWORD last_buttons;
+} RawDevice;
+
+static HWND hwnd = NULL;
+static DWORD flags;
+
+static RawDevice devices[MAX_RAW_DEVICES];
+static int device_count = 0;
+
+static KnownDevice known[MAX_KNOWN_DEVICES];
+static int known_count = 0;
+
+static BYTE raw_buffer[1024]; // one WM_INPUT packet; HID reports of pedals are a few bytes
+
+
+static LRESULT CALLBACK RawInputWndProc(HWND h, UINT msg, WPARAM wParam, LPARAM lParam) {
+    return DefWindowProc(h, msg, wParam, lParam);
+}
+
+
+/* The handle of a device that was unplugged is no good anymore */
+static int Connected(HANDLE hDevice) {
+    RID_DEVICE_INFO di;
+    UINT size = sizeof(di);
+    di.cbSize = sizeof(di);
+    return GetRawInputDeviceInfo(hDevice, RIDI_DEVICEINFO, &di, &size) != (UINT)-1;
+}
+
+
+static int DeviceOf(HANDLE hDevice) {
+    for (int i = 0; i < known_count; i++)
+        if (known[i].hDevice == hDevice) return known[i].device;
+
+    RID_DEVICE_INFO di;
+    UINT size = sizeof(di);
+    di.cbSize = sizeof(di);
+    int device = -1;
+    if (GetRawInputDeviceInfo(hDevice, RIDI_DEVICEINFO, &di, &size) != (UINT)-1 && di.dwType == RIM_TYPEHID) {
+        for (int d = 0; d < device_count; d++) { // two identical devices: the first one not taken yet
+            if (di.hid.dwVendorId != devices[d].vid || di.hid.dwProductId != devices[d].pid) continue;
+            if (device < 0) device = d; // a reconnect of the only one: its old handle is gone
+            if (devices[d].hDevice == NULL || !Connected(devices[d].hDevice)) { device = d; break; }
+        }
+    }
+
+    if (known_count == MAX_KNOWN_DEVICES) known_count = 0; // a handful of devices at most, just start over
+    known[known_count].hDevice = hDevice;
+    known[known_count].device = device;
+    known_count++;
+    return device;
+}
+
+
+/* Reads the report descriptor of the device once.  Called again if Windows gives it a new handle (reconnect) */
+static int LoadPreparsedData(RawDevice *dev, HANDLE hDevice) {
+    UINT size = 0;
+
+    dev->hDevice = NULL;
+
+    if (GetRawInputDeviceInfo(hDevice, RIDI_PREPARSEDDATA, NULL, &size) != 0 || size == 0) return 0;
+    if (size > dev->preparsed_capacity) { // the same device comes back with the same descriptor: no allocation
+        free(dev->preparsed);
+        dev->preparsed_capacity = 0;
+        dev->preparsed = (PHIDP_PREPARSED_DATA)malloc(size);
+        if (dev->preparsed == NULL) return 0;
+        dev->preparsed_capacity = size;
+    }
+    if (GetRawInputDeviceInfo(hDevice, RIDI_PREPARSEDDATA, dev->preparsed, &size) == (UINT)-1) return 0;
+
+    HIDP_VALUE_CAPS vcaps[MAX_VALUE_CAPS];
+    USHORT count = MAX_VALUE_CAPS;
+    memset(dev->has_axis, 0, sizeof(dev->has_axis));
+    if (HidP_GetValueCaps(HidP_Input, vcaps, &count, dev->preparsed) == HIDP_STATUS_SUCCESS) {
+        for (int c = 0; c < count; c++) {
+            if (vcaps[c].UsagePage != 0x01) continue; // HID_USAGE_PAGE_GENERIC
+            USAGE lo = vcaps[c].IsRange ? vcaps[c].Range.UsageMin : vcaps[c].NotRange.Usage;
+            USAGE hi = vcaps[c].IsRange ? vcaps[c].Range.UsageMax : vcaps[c].NotRange.Usage;
+            for (int a = 0; a < RAW_AXES; a++) {
+                if (axis_usage[a] < lo || axis_usage[a] > hi) continue;
+                dev->has_axis[a] = 1;
+                dev->axis_min[a] = vcaps[c].LogicalMin;
+                dev->axis_max[a] = vcaps[c].LogicalMax;
+                dev->axis_bits[a] = vcaps[c].BitSize;
+            }
+        }
+    }
+
+    if (verbose_flag) {
+        printf("Raw input device %p axes:", hDevice);
+        for (int a = 0; a < RAW_AXES; a++)
+            if (dev->has_axis[a]) printf(" %c[%ld..%ld]", "XYZRUV"[a], dev->axis_min[a], dev->axis_max[a]);
+        putchar('\n');
+    }
+
+    dev->hDevice = hDevice;
+    return 1;
+}
+
+
+static DWORD AxisValue(const RawDevice *dev, int a, ULONG value) {
+    LONG v = (LONG)value;
+    LONG lmin = dev->axis_min[a], lmax = dev->axis_max[a];
+    USHORT bits = dev->axis_bits[a];
+
+    if (lmin < 0 && bits > 0 && bits < 32 && (value & (1UL << (bits - 1))))
+        v = (LONG)(value | ~((1UL << bits) - 1)); // sign extend
+    if (lmin < 0) v -= lmin;                      // keep raw values positive like winmm
+
+    if (!(flags & JOY_RETURNRAWDATA) && lmax > lmin) {
+        LONG lo = lmin < 0 ? 0 : lmin;
+        LONG range = lmax - lmin;
+        if (v < lo) v = lo;
+        return (DWORD)((ULONGLONG)(v - lo) * 65535 / (ULONGLONG)range);
+    }
+    return (DWORD)v;
+}
+
+
+/* Returns 1 if the report changed an axis or a button of one of our devices, and which one */
+static int HandleInput(HRAWINPUT hRaw, JOYINFOEX *infos, int *device) {
+    UINT size = sizeof(raw_buffer);
+    if (GetRawInputData(hRaw, RID_INPUT, raw_buffer, &size, sizeof(RAWINPUTHEADER)) == (UINT)-1) return 0;
+
+    RAWINPUT *raw = (RAWINPUT *)raw_buffer;
+    if (raw->header.dwType != RIM_TYPEHID) return 0;
+    int d = DeviceOf(raw->header.hDevice);
+    if (d < 0) return 0;
+    RawDevice *dev = &devices[d];
+    if (raw->header.hDevice != dev->hDevice && !LoadPreparsedData(dev, raw->header.hDevice)) return 0;
+
+    int changed = 0;
+    for (DWORD r = 0; r < raw->data.hid.dwCount; r++) {
+        char *report = (char *)raw->data.hid.bRawData + r * raw->data.hid.dwSizeHid;
+        ULONG len = raw->data.hid.dwSizeHid;
+
+        for (int a = 0; a < RAW_AXES; a++) {
+            ULONG value;
+            if (!dev->has_axis[a]) continue;
+            if (HidP_GetUsageValue(HidP_Input, 0x01, 0, axis_usage[a], &value, dev->preparsed, report, len) != HIDP_STATUS_SUCCESS) continue;
+            DWORD v = AxisValue(dev, a, value);
+            if (v != dev->last_axes[a]) { dev->last_axes[a] = v; changed = 1; }
+        }
+
+        USAGE usages[32];
+        ULONG n = 32;
+        if (HidP_GetUsages(HidP_Input, 0x09, 0, usages, &n, dev->preparsed, report, len) == HIDP_STATUS_SUCCESS) { // HID_USAGE_PAGE_BUTTON
+            DWORD buttons = 0;
+            for (ULONG b = 0; b < n; b++)
+                if (usages[b] >= 1 && usages[b] <= 32) buttons |= 1UL << (usages[b] - 1);
+            if (buttons != dev->last_buttons) { dev->last_buttons = buttons; changed = 1; }
+        }
+    }
+
+    JOYINFOEX *info = &infos[d];
+    info->dwXpos = dev->last_axes[0];
+    info->dwYpos = dev->last_axes[1];
+    info->dwZpos = dev->last_axes[2];
+    info->dwRpos = dev->last_axes[3];
+    info->dwUpos = dev->last_axes[4];
+    info->dwVpos = dev->last_axes[5];
+    info->dwButtons = dev->last_buttons;
+    *device = d;
+    return changed;
+}
+
+
+static void RegisterUsages(DWORD dwFlags, HWND target) {
+    // Joystick, Game Pad and Multi-axis Controller
+    RAWINPUTDEVICE rid[3];
+    const USHORT usages[3] = { 0x04, 0x05, 0x08 };
+    for (int i = 0; i < 3; i++) {
+        rid[i].usUsagePage = 0x01;
+        rid[i].usUsage = usages[i];
+        rid[i].dwFlags = dwFlags;
+        rid[i].hwndTarget = target;
+    }
+    if (!RegisterRawInputDevices(rid, 3, sizeof(rid[0])) && dwFlags != RIDEV_REMOVE)
+        printf("Raw input: RegisterRawInputDevices() failed, error=[%lu]\n", GetLastError());
+}
+
+
+int RawInputOpen(const UINT *joy_IDs, int count, DWORD joy_Flags) {
+    flags = joy_Flags;
+    device_count = 0;
+    known_count = 0;
+
+    for (int d = 0; d < count && d < MAX_RAW_DEVICES; d++) {
+        JOYCAPS jc;
+        if (joyGetDevCaps(joy_IDs[d], &jc, sizeof(jc)) != JOYERR_NOERROR) {
+            printf("Raw input: joyGetDevCaps(%u) failed, can't find the VendorID/ProductID of the joystick\n", joy_IDs[d]);
+            return -1;
+        }
+        memset(&devices[d], 0, sizeof(devices[d]));
+        devices[d].vid = jc.wMid;
+        devices[d].pid = jc.wPid;
+        device_count++;
+        if (verbose_flag) printf("Raw input: waiting for reports from Vendor ID=[%hX] Product ID=[%hX]\n", jc.wMid, jc.wPid);
+    }
+
+    HINSTANCE hInstance = GetModuleHandle(NULL);
+    WNDCLASSEX wc;
+    memset(&wc, 0, sizeof(wc));
+    wc.cbSize = sizeof(wc);
+    wc.lpfnWndProc = RawInputWndProc;
+    wc.hInstance = hInstance;
+    wc.lpszClassName = "FanatecMonitorRawInput";
+    RegisterClassEx(&wc);
+
+    hwnd = CreateWindowEx(0, wc.lpszClassName, "", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, hInstance, NULL);
+    if (hwnd == NULL) {
+        puts("Raw input: could not create the message-only window");
+        return -1;
+    }
+
+    RegisterUsages(RIDEV_INPUTSINK, hwnd); // RIDEV_INPUTSINK: keep receiving input when the sim has the focus
+    return 0;
+}
+
+
+int RawInputWait(JOYINFOEX *infos, int *device, DWORD timeout_ms) {
+    ULONGLONG deadline = GetTickCount64() + timeout_ms;
+    MSG msg;
+
+    for (;;) {
+        // One message at a time: return on the first report that changes something, the rest stay queued
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            int changed = (msg.message == WM_INPUT) && HandleInput((HRAWINPUT)msg.lParam, infos, device);
+            DispatchMessage(&msg); // DefWindowProc() does the WM_INPUT cleanup
+            if (changed) return 1;
+        }
+
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline) return 0;
+
+        if (MsgWaitForMultipleObjects(0, NULL, FALSE, (DWORD)(deadline - now), QS_RAWINPUT) == WAIT_FAILED) return -1;
+    }
+}
+
+
+void RawInputClose(void) {
+    if (hwnd) {
+        RegisterUsages(RIDEV_REMOVE, NULL);
+        DestroyWindow(hwnd);
+        hwnd = NULL;
+    }
+    for (int d = 0; d < device_count; d++) {
+        free(devices[d].preparsed);
+        devices[d].preparsed = NULL;
+        devices[d].preparsed_capacity = 0;
+        devices[d].hDevice = NULL;
+    }
+}
@@ -0,0 +1,32 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   rawinput.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Event driven acquisition (--backend rawinput).
+ * The pedals are registered with RegisterRawInputDevices() on a message-only window, and the thread
+ * only wakes up when the device sends a HID report, instead of polling joyGetPosEx() every sleep_Time.
+ */
+
+#ifndef RAWINPUT_H
+#define RAWINPUT_H
+
+#include "windows.h"
+
+/* joy_IDs are only used to find the VendorID/ProductID of every device with joyGetDevCaps().
+ * joy_Flags: if JOY_RETURNRAWDATA is not set the values are scaled to 0-65535 like winmm does.
+ * Returns 0 on success. */
+int RawInputOpen(const UINT *joy_IDs, int count, DWORD joy_Flags);
+
+/* Waits up to timeout_ms for a HID report that changes an axis or a button.
+ * Returns 1 if infos[*device] was updated, 0 on timeout (infos keep the last values), -1 on error. */
+int RawInputWait(JOYINFOEX *infos, int *device, DWORD timeout_ms);
+
+void RawInputClose(void);
+
+#endif /* RAWINPUT_H */
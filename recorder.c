@@ -0,0 +1,335 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   recorder.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * RecorderWrite() runs on the thread of the recorder sink (pipeline.h), or on the main thread of the
+ * Linux build, and only appends a few bytes to write_buffer.  fwrite() is called when the buffer is
+ * full, about every 256 KB.  One thread at a time: the main thread syncs the sink before it opens or
+ * closes a recording.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "recorder.h"
+
+#define WRITE_BUFFER (256 * 1024)
+#define MAX_RECORD 64          // tag + device + dt + 6 axes + buttons + status, all varints
+#define RUN_FLUSH 1024         // write a 0x80 record at least every 1024 identical samples
+#define TAG_RUN 0x80
+#define TAG_EXTRA 0x40
+
+typedef struct {
+    int have;                  // a sample of this device was written already
+    int64_t last_t;
+    FpmSample last;
+    uint64_t run;              // identical samples not written yet
+    int64_t run_t;             // t_us of the last of them
+    int64_t run_dt;            // dt_us of every one of them, a different period starts a new run
+} DeviceState;
+
+static FILE *out = NULL;
+static unsigned char write_buffer[WRITE_BUFFER];
+static size_t write_len = 0;
+static uint64_t bytes = 0, samples = 0;
+static int multi_device = 0;
+static DeviceState dev[FPM_MAX_DEVICES];
+
+
+static void Drain(void) {
+    if (write_len) {
+        fwrite(write_buffer, 1, write_len, out);
+        bytes += write_len;
+        write_len = 0;
+    }
+}
+
+
+static void Ensure(size_t n) {
+    if (write_len + n > WRITE_BUFFER) Drain();
+}
+
+
+static void PutVarint(uint64_t v) {
+    while (v >= 0x80) {
+        write_buffer[write_len++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    write_buffer[write_len++] = (unsigned char)v;
+}
+
+
+static void PutLE(uint64_t v, int size) {
+    for (int i = 0; i < size; i++) write_buffer[write_len++] = (unsigned char)(v >> (8 * i));
+}
+
+
+static uint64_t ZigZag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+
+static void FlushRun(int device) {
+    DeviceState *d = &dev[device];
+    if (d->run == 0) return;
+
+    Ensure(MAX_RECORD);
+    write_buffer[write_len++] = TAG_RUN;
+    if (multi_device) PutVarint((uint64_t)device);
+    PutVarint(d->run);
+    PutVarint((uint64_t)(d->run_t - d->last_t));
+    d->last_t = d->run_t;
+    d->run = 0;
+}
+
+
+int RecorderOpen(const char *path, const FpmHeader *h) {
+    out = fopen(path, "wb");
+    if (out == NULL) return -1;
+    setvbuf(out, NULL, _IONBF, 0); // write_buffer is the buffer, and the CRT doesn't allocate one at the first fwrite()
+
+    memset(dev, 0, sizeof(dev));
+    write_len = 0;
+    bytes = samples = 0;
+    multi_device = h->device_count > 1;
+
+    size_t header_size = 32 + 8 * (size_t)h->device_count + 40 * (size_t)h->watch_count;
+    memcpy(write_buffer, "FPM1", 4);
+    write_len = 4;
+    PutLE(FPM_VERSION, 2);
+    PutLE(header_size, 2);
+    PutLE(h->flags, 4);
+    PutLE(h->period_us, 4);
+    PutLE((uint64_t)h->start_unix_us, 8);
+    PutLE((uint64_t)h->device_count, 1);
+    PutLE((uint64_t)h->watch_count, 1);
+    PutLE(0, 2);
+    PutLE(0, 4);
+    for (int i = 0; i < h->device_count; i++) {
+        PutLE(h->devices[i].vid, 2);
+        PutLE(h->devices[i].pid, 2);
+        PutLE(h->devices[i].joy_ID, 4);
+    }
+    for (int i = 0; i < h->watch_count; i++) {
+        const FpmWatchInfo *w = &h->watches[i];
+        PutLE(w->device, 1);
+        PutLE(w->axis, 1);
+        PutLE((uint8_t)w->gate_axis, 1);
+        PutLE(w->margin_pct, 1);
+        PutLE(w->repeat, 2);
+        PutLE(0, 2);
+        PutLE(w->gate_rest, 4);
+        PutLE(w->rest, 4);
+        memcpy(write_buffer + write_len, w->name, FPM_NAME_SIZE);
+        write_len += FPM_NAME_SIZE;
+    }
+    return 0;
+}
+
+
+void RecorderWrite(const FpmSample *s) {
+    if (out == NULL || s->device >= FPM_MAX_DEVICES) return;
+    samples++;
+
+    DeviceState *d = &dev[s->device];
+    int mask = 0;
+    for (int a = 0; a < FPM_AXES; a++)
+        if (s->axes[a] != d->last.axes[a]) mask |= 1 << a;
+    int extra = (s->buttons != d->last.buttons) || (s->status != d->last.status);
+
+    if (d->have && mask == 0 && !extra) {
+        int64_t dt = s->t_us - (d->run ? d->run_t : d->last_t);
+        if (d->run && dt != d->run_dt) FlushRun(s->device);
+        if (d->run == 0) d->run_dt = dt;
+        d->run++;
+        d->run_t = s->t_us;
+        if (d->run >= RUN_FLUSH) FlushRun(s->device);
+        return;
+    }
+    FlushRun(s->device);
+
+    Ensure(MAX_RECORD);
+    write_buffer[write_len++] = (unsigned char)(mask | (extra ? TAG_EXTRA : 0));
+    if (multi_device) PutVarint(s->device);
+    PutVarint((uint64_t)(s->t_us - d->last_t));
+    for (int a = 0; a < FPM_AXES; a++)
+        if (mask & (1 << a)) PutVarint(ZigZag((int64_t)s->axes[a] - (int64_t)d->last.axes[a]));
+    if (extra) {
+        PutVarint(s->buttons);
+        PutVarint(s->status);
+    }
+
+    d->last = *s;
+    d->last_t = s->t_us;
+    d->have = 1;
+}
+
+
+void RecorderClose(void) {
+    if (out == NULL) return;
+    for (int i = 0; i < FPM_MAX_DEVICES; i++) FlushRun(i);
+    Drain();
+    fclose(out);
+    out = NULL;
+}
+
+
+uint64_t RecorderBytes(void) {
+    return bytes + write_len;
+}
+
+
+uint64_t RecorderSamples(void) {
+    return samples;
+}
+
+
+/* ---- Reader ---- */
+
+static void Refill(FpmReader *r) {
+    if (r->eof || r->len - r->pos >= MAX_RECORD) return;
+
+    memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+    r->len -= r->pos;
+    r->pos = 0;
+    size_t n = fread(r->buf + r->len, 1, FPM_READ_BUFFER - r->len, r->f);
+    r->len += n;
+    if (n == 0) r->eof = 1;
+}
+
+
+/* Returns 0 if the record was cut at the end of the file */
+static int GetVarint(FpmReader *r, uint64_t *v) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->len) return 0;
+        unsigned char b = r->buf[r->pos++];
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) { *v = result; return 1; }
+    }
+    return 0;
+}
+
+
+static uint64_t GetLE(const unsigned char *p, int size) {
+    uint64_t v = 0;
+    for (int i = 0; i < size; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+
+int FpmReaderOpen(FpmReader *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    r->f = fopen(path, "rb");
+    if (r->f == NULL) return -1;
+    r->buf = (unsigned char *)malloc(FPM_READ_BUFFER);
+    if (r->buf == NULL) goto BAD;
+    r->len = fread(r->buf, 1, FPM_READ_BUFFER, r->f);
+
+    const unsigned char *p = r->buf;
+    if (r->len < 32 || memcmp(p, "FPM1", 4) != 0 || GetLE(p + 4, 2) != FPM_VERSION) goto BAD;
+    size_t header_size = (size_t)GetLE(p + 6, 2);
+    FpmHeader *h = &r->header;
+    h->flags = (uint32_t)GetLE(p + 8, 4);
+    h->period_us = (uint32_t)GetLE(p + 12, 4);
+    h->start_unix_us = (int64_t)GetLE(p + 16, 8);
+    h->device_count = p[24];
+    h->watch_count = p[25];
+    if (h->device_count == 0 || h->device_count > FPM_MAX_DEVICES || h->watch_count > FPM_MAX_WATCHES) goto BAD;
+    if (header_size != 32 + 8 * (size_t)h->device_count + 40 * (size_t)h->watch_count || r->len < header_size) goto BAD;
+
+    p += 32;
+    for (int i = 0; i < h->device_count; i++, p += 8) {
+        h->devices[i].vid = (uint16_t)GetLE(p, 2);
+        h->devices[i].pid = (uint16_t)GetLE(p + 2, 2);
+        h->devices[i].joy_ID = (uint32_t)GetLE(p + 4, 4);
+    }
+    for (int i = 0; i < h->watch_count; i++, p += 40) {
+        FpmWatchInfo *w = &h->watches[i];
+        w->device = p[0];
+        w->axis = p[1];
+        w->gate_axis = (int8_t)p[2];
+        w->margin_pct = p[3];
+        w->repeat = (uint16_t)GetLE(p + 4, 2);
+        w->gate_rest = (uint32_t)GetLE(p + 8, 4);
+        w->rest = (uint32_t)GetLE(p + 12, 4);
+        memcpy(w->name, p + 16, FPM_NAME_SIZE);
+        w->name[FPM_NAME_SIZE - 1] = '\0';
+        if (w->device >= h->device_count || w->axis >= FPM_AXES || w->gate_axis >= FPM_AXES) goto BAD;
+    }
+    r->pos = header_size;
+    for (int i = 0; i < FPM_MAX_DEVICES; i++) r->last[i].device = (uint16_t)i;
+    return 0;
+
+BAD:
+    FpmReaderClose(r);
+    return -1;
+}
+
+
+int FpmReaderNext(FpmReader *r, FpmSample *s) {
+    for (;;) {
+        if (r->run_left) {
+            uint64_t k = r->run_count - r->run_left + 1;
+            FpmSample *last = &r->last[r->run_device];
+            last->t_us = r->run_t0 + (int64_t)((uint64_t)r->run_dt * k / r->run_count);
+            if (--r->run_left == 0) r->last_t[r->run_device] = r->run_t0 + r->run_dt;
+            *s = *last;
+            return 1;
+        }
+
+        Refill(r);
+        if (r->pos >= r->len) return 0;
+
+        unsigned tag = r->buf[r->pos++];
+        uint64_t device = 0, dt, v;
+        if (r->header.device_count > 1 && !GetVarint(r, &device)) return 0;
+        if (device >= (uint64_t)r->header.device_count) return -1;
+
+        if (tag == TAG_RUN) {
+            uint64_t count;
+            if (!GetVarint(r, &count) || !GetVarint(r, &dt)) return 0;
+            if (count == 0) continue;
+            r->run_device = (int)device;
+            r->run_count = r->run_left = count;
+            r->run_t0 = r->last_t[device];
+            r->run_dt = (int64_t)dt;
+            continue;
+        }
+        if (tag & TAG_RUN) return -1;
+
+        FpmSample *last = &r->last[device];
+        if (!GetVarint(r, &dt)) return 0;
+        for (int a = 0; a < FPM_AXES; a++) {
+            if (!(tag & (1u << a))) continue;
+            if (!GetVarint(r, &v)) return 0;
+            int64_t delta = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+            last->axes[a] = (uint32_t)((int64_t)last->axes[a] + delta);
+        }
+        if (tag & TAG_EXTRA) {
+            if (!GetVarint(r, &v)) return 0;
+            last->buttons = (uint32_t)v;
+            if (!GetVarint(r, &v)) return 0;
+            last->status = (uint16_t)v;
+        }
+        r->last_t[device] += (int64_t)dt;
+        last->t_us = r->last_t[device];
+        *s = *last;
+        return 1;
+    }
+}
+
+
+void FpmReaderClose(FpmReader *r) {
+    if (r->f) fclose(r->f);
+    free(r->buf);
+    r->f = NULL;
+    r->buf = NULL;
+}
@@ -0,0 +1,98 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   recorder.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Binary telemetry recording (--record file.fpm).  Little endian:
+ *
+ *   header:  "FPM1", u16 version, u16 header size, u32 joy_Flags, u32 sample period in us (0: event driven),
+ *            i64 wall clock of t_us == 0 in microseconds since 1970, u8 devices, u8 watches, u16 0, u32 0,
+ *            devices * { u16 VendorID, u16 ProductID, u32 joystick ID },
+ *            watches * { u8 device, u8 axis, i8 gate axis, u8 margin %, u16 repeat, u16 0, u32 gate rest, u32 rest, char name[24] }
+ *
+ *   records: tag 0x00-0x7F  sample.  bits 0-5: axes that changed, bit 6: buttons/status follow
+ *                           [varint device if devices > 1] varint dt_us, zigzag varint delta of every changed axis,
+ *                           [varint buttons, varint status]
+ *            tag 0x80       run of identical samples: [varint device] varint count, varint dt_us of the whole run.
+ *                           Every sample of a run has the same period, so spreading them evenly over
+ *                           dt_us when read back gives their original t_us.
+ *
+ * dt_us is always relative to the previous sample of the same device.  A pedal at rest produces no
+ * change at all, so a whole day at a steady 100 Hz is mostly 0x80 records and fits in a few hundred KB.
+ * The writer is portable C, it only uses stdio.
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "sample.h"
+
+#define FPM_VERSION 1
+#define FPM_NAME_SIZE 24
+
+typedef struct {
+    uint16_t vid, pid;
+    uint32_t joy_ID;
+} FpmDeviceInfo;
+
+typedef struct {
+    uint8_t device, axis;
+    int8_t gate_axis;         // -1: no gate
+    uint8_t margin_pct;
+    uint16_t repeat;
+    uint32_t gate_rest, rest;
+    char name[FPM_NAME_SIZE];
+} FpmWatchInfo;
+
+typedef struct {
+    uint32_t flags;
+    uint32_t period_us;
+    int64_t start_unix_us;
+    int device_count;
+    FpmDeviceInfo devices[FPM_MAX_DEVICES];
+    int watch_count;
+    FpmWatchInfo watches[FPM_MAX_WATCHES];
+} FpmHeader;
+
+/* Writer, one per process.  Returns 0 on success */
+int  RecorderOpen(const char *path, const FpmHeader *h);
+void RecorderWrite(const FpmSample *s);
+void RecorderClose(void);
+uint64_t RecorderBytes(void);   // written so far, header included
+uint64_t RecorderSamples(void);
+
+/* Reader */
+#define FPM_READ_BUFFER (1 << 20)
+
+typedef struct {
+    FILE *f;
+    FpmHeader header;
+    unsigned char *buf;
+    size_t len, pos;
+    int eof;
+    // per device decoder state
+    int64_t last_t[FPM_MAX_DEVICES];
+    FpmSample last[FPM_MAX_DEVICES];
+    // a 0x80 run being expanded
+    int run_device;
+    uint64_t run_left, run_count;
+    int64_t run_t0, run_dt;
+} FpmReader;
+
+/* Returns 0 on success, -1 if the file can't be read or is not a .fpm */
+int  FpmReaderOpen(FpmReader *r, const char *path);
+
+/* Returns 1 with a sample, 0 at the end of the file, -1 if the file is corrupt */
+int  FpmReaderNext(FpmReader *r, FpmSample *s);
+
+void FpmReaderClose(FpmReader *r);
+
+#endif /* RECORDER_H */
@@ -0,0 +1,202 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   replay.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "replay.h"
+#include "recorder.h"
+#include "detector.h"
+#include "heatmap.h"
+
+#define REPLAY_BATCH 4096
+
+extern int verbose_flag; /* main.c */
+
+/* The samples are decoded into one batch per device and the detector runs over a whole batch, see DetectorScan() */
+typedef struct {
+    size_t n;
+    int64_t t_us[REPLAY_BATCH];
+    uint16_t axes[FPM_AXES][REPLAY_BATCH];
+} DeviceBatch;
+
+typedef struct {
+    int64_t t_us;
+    uint32_t value;
+    int w;
+} ReplayAlert;
+
+static DeviceBatch batch[FPM_MAX_DEVICES];
+static ReplayAlert *alerts = NULL; // REPLAY_BATCH per watch, the most one flush can give
+
+
+static void PrintAlert(const FpmHeader *h, const WatchTable *wt, const ReplayAlert *a) {
+    char when[48];
+    FormatUnixMicroseconds(h->start_unix_us + a->t_us, when, sizeof(when));
+    printf("%s, %lld, %s, %lu\n", when, (long long)a->t_us, wt->specs[a->w].name, (unsigned long)a->value);
+}
+
+
+static int CompareAlerts(const void *a, const void *b) {
+    const ReplayAlert *x = (const ReplayAlert *)a, *y = (const ReplayAlert *)b;
+    if (x->t_us != y->t_us) return x->t_us < y->t_us ? -1 : 1;
+    return x->w - y->w;
+}
+
+
+/* Runs every watch over the batch of its device and prints the alerts in time order */
+static unsigned long long Flush(const FpmHeader *h, WatchTable *wt) {
+    uint32_t alert_at[REPLAY_BATCH];
+    int alert_n = 0;
+
+    for (int d = 0; d < wt->device_count; d++) {
+        DeviceBatch *b = &batch[d];
+        int w_End = wt->first[d] + wt->n[d];
+        for (int w = wt->first[d]; w < w_End; w++) {
+            DetectorRule rule = { wt->margin[w], wt->rest[w], wt->gate_rest[w], wt->repeat[w] };
+            DetectorState st = { wt->last[w], wt->run[w] };
+            const uint16_t *axis = b->axes[wt->axis[w]];
+            const uint16_t *gate = wt->gate_axis[w] < 0 ? NULL : b->axes[(int)wt->gate_axis[w]];
+
+            if (wt->repeat_us[w] || wt->engine[w] != ENGINE_CLOSURE || wt->zoned[w]) { // the batch kernels only do the plain closure rule
+                for (size_t k = 0; k < b->n; k++) {
+                    if (!DetectorStep(wt, w, axis[k], gate == NULL || gate[k] == wt->gate_rest[w], b->t_us[k])) continue;
+                    ReplayAlert *a = &alerts[alert_n++];
+                    a->t_us = b->t_us[k];
+                    a->value = axis[k];
+                    a->w = w;
+                }
+                continue;
+            }
+
+            for (size_t pos = 0; pos < b->n; ) {
+                int count;
+                size_t used = DetectorScan(&rule, &st, axis + pos, gate ? gate + pos : NULL, b->n - pos,
+                                           alert_at, REPLAY_BATCH, &count);
+                for (int i = 0; i < count; i++) {
+                    size_t k = pos + alert_at[i];
+                    ReplayAlert *a = &alerts[alert_n++];
+                    a->t_us = b->t_us[k];
+                    a->value = axis[k];
+                    a->w = w;
+                }
+                pos += used;
+            }
+            wt->last[w] = st.last;
+            wt->run[w] = (uint16_t)st.run;
+        }
+        b->n = 0;
+    }
+
+    if (alert_n > 1) qsort(alerts, alert_n, sizeof(alerts[0]), CompareAlerts);
+    for (int i = 0; i < alert_n; i++) PrintAlert(h, wt, &alerts[i]);
+    return (unsigned long long)alert_n;
+}
+
+
+void ReplayCalibrate(const FpmHeader *h, WatchTable *wt) {
+    for (int k = 0; k < wt->device_count; k++) {
+        uint32_t axis_min[FPM_AXES] = { 0 }, axis_max[FPM_AXES] = { 0 };
+        for (int w = 0; w < h->watch_count; w++) {
+            const FpmWatchInfo *fw = &h->watches[w];
+            if (h->devices[fw->device].joy_ID != wt->joy_ID[k]) continue;
+            axis_max[fw->axis] = fw->rest;
+            if (fw->gate_axis >= 0) axis_max[fw->gate_axis] = fw->gate_rest;
+        }
+        WatchCalibrate(wt, k, axis_min, axis_max);
+    }
+}
+
+
+int ReplayRun(MonitorConfig *cfg) {
+    static FpmReader rd;
+
+    if (FpmReaderOpen(&rd, cfg->replay_File) != 0) {
+        printf("Could not read '%s', or it is not a --record file\n", cfg->replay_File);
+        return EXIT_FAILURE;
+    }
+    const FpmHeader *h = &rd.header;
+
+    WatchTable *wt = &cfg->watches;
+    WatchFinish(wt, cfg->joy_ID < FPM_MAX_DEVICES ? cfg->joy_ID : h->devices[0].joy_ID, cfg->margin);
+    ReplayCalibrate(h, wt);
+    DetectorReset(wt);
+    if (cfg->heatmap_File && HeatmapOpen(cfg->heatmap_File, wt, 0, cfg->heatmap_Margin, 1) != 0) {
+        FpmReaderClose(&rd);
+        return EXIT_FAILURE;
+    }
+
+    // device index in the file -> device index in the watch table
+    int map[FPM_MAX_DEVICES];
+    for (int d = 0; d < h->device_count; d++) {
+        map[d] = -1;
+        for (int k = 0; k < wt->device_count; k++)
+            if (wt->joy_ID[k] == h->devices[d].joy_ID) map[d] = k;
+    }
+    for (int k = 0; k < wt->device_count; k++) {
+        int found = 0;
+        for (int d = 0; d < h->device_count; d++) found |= map[d] == k;
+        if (!found) printf("Joystick %u is not in '%s', its watches never fire\n", wt->joy_ID[k], cfg->replay_File);
+    }
+
+    if (verbose_flag) {
+        printf("Recording: flags=[%u] period=[%u us] devices=[%d] watches=[%d]\n",
+               h->flags, h->period_us, h->device_count, h->watch_count);
+        for (int d = 0; d < h->device_count; d++)
+            printf("Recorded joystick=[%u] Vendor ID=[%hX] Product ID=[%hX]\n",
+                   h->devices[d].joy_ID, h->devices[d].vid, h->devices[d].pid);
+        for (int w = 0; w < h->watch_count; w++)
+            printf("Recorded watch %d: axis=[%c] margin=[%u%%] repeat=[%u] name=[%s]\n", w,
+                   "XYZRUV"[h->watches[w].axis], h->watches[w].margin_pct, h->watches[w].repeat, h->watches[w].name);
+        WatchPrint(wt);
+        HeatmapReport(wt);
+    }
+
+    alerts = (ReplayAlert *)malloc(sizeof(ReplayAlert) * REPLAY_BATCH * MAX_WATCHES);
+    if (alerts == NULL) {
+        puts("Not enough memory for the replay");
+        FpmReaderClose(&rd);
+        return EXIT_FAILURE;
+    }
+
+    LONGLONG start = QpcNow();
+    unsigned long long samples = 0, alert_count = 0;
+    FpmSample s;
+    int r;
+
+    while ((r = FpmReaderNext(&rd, &s)) == 1) {
+        samples++;
+        int d = map[s.device];
+        if (d < 0) continue;
+        if (s.status != 0) { // as DetectorFeed(): the runs before the failed read are checked, then start again
+            alert_count += Flush(h, wt);
+            DetectorResetDevice(wt, d);
+            continue;
+        }
+
+        DeviceBatch *b = &batch[d];
+        b->t_us[b->n] = s.t_us;
+        for (int a = 0; a < FPM_AXES; a++) b->axes[a][b->n] = (uint16_t)s.axes[a]; // joyGetPosEx() values are 0..65535
+        if (++b->n == REPLAY_BATCH) alert_count += Flush(h, wt);
+    }
+    alert_count += Flush(h, wt);
+
+    double seconds = QpcToMicroseconds(QpcNow() - start) / 1e6;
+    if (r < 0) printf("'%s' is corrupt after %llu samples\n", cfg->replay_File, samples);
+    printf("Replay: samples=[%llu] alerts=[%llu] seconds=[%.3f] samples/s=[%.0f]\n",
+           samples, alert_count, seconds, seconds > 0 ? samples / seconds : 0.0);
+
+    free(alerts);
+    HeatmapClose();
+    FpmReaderClose(&rd);
+    return r < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,30 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   replay.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --replay file.fpm  runs the detector over a --record trace as fast as the file can be decoded.
+ * The watches come from the command line exactly like a live run (--watch, or --joystick/--margin for the
+ * original rule), so --margin and the repeat count can be tuned without sitting in the sim.
+ * Without --joystick the first device of the recording is used.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "config.h"
+#include "recorder.h"
+
+/* Prints every alert with its time and axis value.  Returns the exit code of the program */
+int ReplayRun(MonitorConfig *cfg);
+
+/* Takes the rest values the recording was made with (the JOYCAPS or --calibrate range of that run)
+   for the watches on the same joystick and axes.  Also used by --sweep */
+void ReplayCalibrate(const FpmHeader *h, WatchTable *wt);
+
+#endif /* REPLAY_H */
@@ -0,0 +1,241 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   resources.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * SystemProcessInformation returns every process of the machine, a few hundred KB.  The buffer is
+ * VirtualAlloc()ed once at ResourcesInit() and only grows, so --lean doesn't see it in the heaps.
+ * The structures are the documented beginning of SYSTEM_PROCESS_INFORMATION (winternl.h leaves most of
+ * it Reserved) and SYSTEM_THREAD_INFORMATION, which follows it once per thread.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "windows.h"
+
+#include "resources.h"
+#include "timer.h"
+
+#define STATUS_INFO_LENGTH_MISMATCH ((LONG)0xC0000004)
+#define SYSTEM_PROCESS_INFORMATION_CLASS 5
+#define PROCESS_BUFFER (512 * 1024)
+
+typedef struct {
+    LARGE_INTEGER KernelTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER CreateTime;
+    ULONG WaitTime;
+    PVOID StartAddress;
+    HANDLE UniqueProcess;        // CLIENT_ID
+    HANDLE UniqueThread;
+    LONG Priority;
+    LONG BasePriority;
+    ULONG ContextSwitches;
+    ULONG ThreadState;
+    ULONG WaitReason;
+} ThreadInformation;
+
+typedef struct {
+    ULONG NextEntryOffset;
+    ULONG NumberOfThreads;
+    LARGE_INTEGER WorkingSetPrivateSize;
+    ULONG HardFaultCount;
+    ULONG NumberOfThreadsHighWatermark;
+    ULONGLONG CycleTime;
+    LARGE_INTEGER CreateTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER KernelTime;
+    USHORT ImageNameLength;      // UNICODE_STRING
+    USHORT ImageNameMaximumLength;
+    PWSTR ImageNameBuffer;
+    LONG BasePriority;
+    HANDLE UniqueProcessId;
+    HANDLE InheritedFromUniqueProcessId;
+    ULONG HandleCount;
+    ULONG SessionId;
+    ULONG_PTR UniqueProcessKey;
+    SIZE_T PeakVirtualSize;
+    SIZE_T VirtualSize;
+    ULONG PageFaultCount;
+    SIZE_T PeakWorkingSetSize;
+    SIZE_T WorkingSetSize;
+    SIZE_T QuotaPeakPagedPoolUsage;
+    SIZE_T QuotaPagedPoolUsage;
+    SIZE_T QuotaPeakNonPagedPoolUsage;
+    SIZE_T QuotaNonPagedPoolUsage;
+    SIZE_T PagefileUsage;
+    SIZE_T PeakPagefileUsage;
+    SIZE_T PrivatePageCount;
+    LARGE_INTEGER ReadOperationCount;
+    LARGE_INTEGER WriteOperationCount;
+    LARGE_INTEGER OtherOperationCount;
+    LARGE_INTEGER ReadTransferCount;
+    LARGE_INTEGER WriteTransferCount;
+    LARGE_INTEGER OtherTransferCount;
+} ProcessInformation;
+
+typedef LONG (WINAPI *NtQuerySystemInformationFn)(ULONG, PVOID, ULONG, PULONG);
+
+static NtQuerySystemInformationFn query_system = NULL;
+static unsigned char *process_buffer = NULL;
+static ULONG process_buffer_size = 0;
+
+static const char *thread_names[RES_MAX_THREADS];
+static HANDLE threads[RES_MAX_THREADS];
+static DWORD thread_IDs[RES_MAX_THREADS];
+static int thread_count = 0;
+
+static ResourceSnapshot first, previous, latest;
+static ResourceRates rates;
+static int measured = 0;         // latest is newer than first
+static LONGLONG start_qpc;
+
+
+/* Context switches of every thread of this process, and its private working set */
+static void ReadSwitches(ResourceSnapshot *snap) {
+    ULONG needed = 0;
+    LONG status;
+
+    snap->switches = 0;
+    snap->private_bytes = 0;
+    if (query_system == NULL) return;
+    while ((status = query_system(SYSTEM_PROCESS_INFORMATION_CLASS, process_buffer, process_buffer_size, &needed)) == STATUS_INFO_LENGTH_MISMATCH) {
+        VirtualFree(process_buffer, 0, MEM_RELEASE);
+        process_buffer_size = needed + 64 * 1024; // processes come and go
+        process_buffer = (unsigned char *)VirtualAlloc(NULL, process_buffer_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (process_buffer == NULL) {
+            process_buffer_size = 0;
+            return;
+        }
+    }
+    if (status < 0) return;
+
+    HANDLE me = (HANDLE)(ULONG_PTR)GetCurrentProcessId();
+    const unsigned char *p = process_buffer;
+    for (;;) {
+        const ProcessInformation *pi = (const ProcessInformation *)p;
+        if (pi->UniqueProcessId == me) {
+            const ThreadInformation *ti = (const ThreadInformation *)(pi + 1);
+            snap->private_bytes = (ULONGLONG)pi->WorkingSetPrivateSize.QuadPart;
+            for (ULONG t = 0; t < pi->NumberOfThreads; t++) {
+                snap->switches += ti[t].ContextSwitches;
+                for (int k = 0; k < thread_count; k++)
+                    if ((DWORD)(ULONG_PTR)ti[t].UniqueThread == thread_IDs[k]) snap->thread_switches[k] = ti[t].ContextSwitches;
+            }
+            return;
+        }
+        if (pi->NextEntryOffset == 0) return;
+        p += pi->NextEntryOffset;
+    }
+}
+
+
+static void Snapshot(ResourceSnapshot *snap, ULONGLONG samples) {
+    FILETIME created, exited, kernel, user;
+    memset(snap, 0, sizeof(*snap));
+    snap->t_us = QpcToMicroseconds(QpcNow() - start_qpc);
+    snap->samples = samples;
+    if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        ULONGLONG k = ((ULONGLONG)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+        ULONGLONG u = ((ULONGLONG)user.dwHighDateTime << 32) | user.dwLowDateTime;
+        snap->cpu_us = (k + u) / 10;
+    }
+    QueryProcessCycleTime(GetCurrentProcess(), &snap->cycles);
+    for (int k = 0; k < thread_count; k++) QueryThreadCycleTime(threads[k], &snap->thread_cycles[k]);
+    ReadSwitches(snap);
+}
+
+
+int ResourcesInit(void) {
+    HMODULE ntdll = GetModuleHandle("ntdll.dll");
+    query_system = ntdll ? (NtQuerySystemInformationFn)(void (*)(void))GetProcAddress(ntdll, "NtQuerySystemInformation") : NULL;
+    process_buffer_size = PROCESS_BUFFER;
+    process_buffer = (unsigned char *)VirtualAlloc(NULL, process_buffer_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (process_buffer == NULL) process_buffer_size = 0;
+
+    thread_count = 0;               // the ones added later start from 0 in first
+    measured = 0;
+    memset(&rates, 0, sizeof(rates));
+    ResourcesAddThread("main", GetCurrentThread());
+    start_qpc = QpcNow();
+    Snapshot(&first, 0);
+    previous = latest = first;
+    return query_system ? 0 : -1;
+}
+
+
+void ResourcesAddThread(const char *name, HANDLE thread) {
+    HANDLE copy;
+    if (thread == NULL || thread_count == RES_MAX_THREADS) return;
+    if (!DuplicateHandle(GetCurrentProcess(), thread, GetCurrentProcess(), &copy, THREAD_QUERY_LIMITED_INFORMATION, FALSE, 0)) return;
+    thread_names[thread_count] = name;
+    threads[thread_count] = copy;
+    thread_IDs[thread_count] = GetThreadId(copy);
+    thread_count++;
+}
+
+
+void ResourcesMeasure(ULONGLONG samples) {
+    previous = latest;
+    Snapshot(&latest, samples);
+    measured = 1;
+
+    double seconds = (double)(latest.t_us - previous.t_us) / 1e6;
+    ULONGLONG n = latest.samples - previous.samples;
+    rates.cpu_percent = seconds > 0 ? (double)(latest.cpu_us - previous.cpu_us) / (seconds * 1e4) : 0;
+    rates.cycles_per_sample = n ? (double)(latest.cycles - previous.cycles) / (double)n : 0;
+    rates.wakeups_per_s = seconds > 0 && latest.switches ? (double)(latest.switches - previous.switches) / seconds : 0;
+}
+
+
+const ResourceSnapshot *ResourcesFirst(void) {
+    return &first;
+}
+
+
+const ResourceSnapshot *ResourcesLatest(void) {
+    return &latest;
+}
+
+
+const ResourceRates *ResourcesRates(void) {
+    return &rates;
+}
+
+
+void ResourcesPrint(void) {
+    if (!measured) return;
+    const ResourceSnapshot *a = &first, *b = &latest;
+    double seconds = (double)(b->t_us - a->t_us) / 1e6;
+    ULONGLONG n = b->samples - a->samples;
+
+    printf("Resources over %.0f s: cpu=[%.3f s] (%.4f%% of one processor) cycles=[%llu] cycles/sample=[%.0f] context switches=[%llu] wakeups/s=[%.2f] private working set=[%llu KB]\n",
+           seconds, (double)(b->cpu_us - a->cpu_us) / 1e6, seconds > 0 ? (double)(b->cpu_us - a->cpu_us) / (seconds * 1e4) : 0,
+           b->cycles - a->cycles, n ? (double)(b->cycles - a->cycles) / (double)n : 0, b->switches - a->switches,
+           seconds > 0 ? (double)(b->switches - a->switches) / seconds : 0, b->private_bytes / 1024);
+
+    ULONGLONG listed = 0;
+    for (int k = 0; k < thread_count; k++) {
+        ULONGLONG cycles = b->thread_cycles[k] - a->thread_cycles[k];
+        listed += cycles;
+        printf("    thread %-8s cycles=[%llu] cycles/sample=[%.0f] context switches=[%llu]\n", thread_names[k], cycles,
+               n ? (double)cycles / (double)n : 0, b->thread_switches[k] - a->thread_switches[k]);
+    }
+    ULONGLONG all = b->cycles - a->cycles;
+    printf("    other threads (winmm, SAPI, hot-plug) cycles=[%llu]\n", all > listed ? all - listed : 0);
+    printf("    last interval: cpu=[%.4f%%] cycles/sample=[%.0f] wakeups/s=[%.2f]\n", rates.cpu_percent, rates.cycles_per_sample, rates.wakeups_per_s);
+}
+
+
+void ResourcesClose(void) {
+    for (int k = 0; k < thread_count; k++) CloseHandle(threads[k]);
+    thread_count = 0;
+    if (process_buffer) VirtualFree(process_buffer, 0, MEM_RELEASE);
+    process_buffer = NULL;
+    process_buffer_size = 0;
+}
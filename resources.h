@@ -0,0 +1,64 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   resources.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --resources seconds: what the monitor itself costs.  Every that many seconds the consumer thread reads
+ * GetProcessTimes(), QueryProcessCycleTime(), QueryThreadCycleTime() of the monitor threads and the context
+ * switches of every thread of the process (NtQuerySystemInformation, the only place Windows has them).
+ * A context switch is a thread of the monitor getting the CPU, so they are the wakeups counted here.
+ * Printed with the report (every minute with --verbose, Ctrl+Break and at exit) and published in the
+ * telemetry block.
+ *
+ * Without --resources none of it runs: nothing per sample, ResourcesMeasure() is never called.
+ */
+
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <stdint.h>
+#include "windows.h"
+
+#define RES_MAX_THREADS 6
+
+typedef struct {
+    int64_t   t_us;               // when it was measured, microseconds since ResourcesInit()
+    ULONGLONG samples;            // consumed by then
+    ULONGLONG cpu_us;             // user + kernel of the process
+    ULONGLONG cycles;             // of the process
+    ULONGLONG switches;           // context switches of every thread of the process, 0 if unknown
+    ULONGLONG private_bytes;      // private working set, 0 if unknown
+    ULONGLONG thread_cycles[RES_MAX_THREADS];
+    ULONGLONG thread_switches[RES_MAX_THREADS];
+} ResourceSnapshot;
+
+typedef struct {                  // over the last interval
+    double cpu_percent;           // of one logical processor
+    double cycles_per_sample;
+    double wakeups_per_s;
+} ResourceRates;
+
+/* On the main thread, before the others start, it is registered as "main".  Returns 0 when it works */
+int  ResourcesInit(void);
+
+/* The handle is duplicated, the caller may close its own.  name is not copied */
+void ResourcesAddThread(const char *name, HANDLE thread);
+
+/* Takes a new snapshot, the previous one is kept for the rates.  samples: consumed so far */
+void ResourcesMeasure(ULONGLONG samples);
+
+const ResourceSnapshot *ResourcesFirst(void);   // of ResourcesInit()
+const ResourceSnapshot *ResourcesLatest(void);
+const ResourceRates *ResourcesRates(void);
+
+/* Since ResourcesInit(), per thread and over the last interval */
+void ResourcesPrint(void);
+
+void ResourcesClose(void);
+
+#endif /* RESOURCES_H */
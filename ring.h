@@ -0,0 +1,90 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   ring.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Lock-free single-producer/single-consumer ring of FpmSample.
+ * The sampler thread is the only one calling RingPush() and the detector thread the only one calling
+ * RingPop().  head and tail live on their own cache lines so the two threads don't keep stealing the
+ * line from each other.  RingPush() never blocks: when the ring is full the sample is dropped and counted.
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "sample.h"
+
+#define RING_CAPACITY 4096  // power of two; 40 s of samples at 100 Hz
+#define RING_MASK (RING_CAPACITY - 1)
+#define CACHE_LINE 64
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_uint_fast32_t head;   // next slot to write, owned by the producer
+    _Alignas(CACHE_LINE) atomic_uint_fast32_t tail;   // next slot to read, owned by the consumer
+    _Alignas(CACHE_LINE) atomic_uint_fast64_t dropped; // written by the producer, read by anybody
+    _Alignas(CACHE_LINE) FpmSample slots[RING_CAPACITY];
+} SampleRing;
+
+
+static inline void RingInit(SampleRing *r) {
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->dropped, 0);
+}
+
+
+static inline int RingPush(SampleRing *r, const FpmSample *s) {
+    uint_fast32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+
+    if (head - tail >= RING_CAPACITY) {
+        atomic_store_explicit(&r->dropped, atomic_load_explicit(&r->dropped, memory_order_relaxed) + 1, memory_order_relaxed);
+        return 0;
+    }
+    r->slots[head & RING_MASK] = *s;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return 1;
+}
+
+
+static inline int RingPop(SampleRing *r, FpmSample *s) {
+    uint_fast32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint_fast32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    if (head == tail) return 0;
+    *s = r->slots[tail & RING_MASK];
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+
+/* Up to max samples in one go, the tail is published once for all of them */
+static inline int RingPopBatch(SampleRing *r, FpmSample *s, int max) {
+    uint_fast32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint_fast32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    int n = head - tail < (uint_fast32_t)max ? (int)(head - tail) : max;
+
+    for (int i = 0; i < n; i++) s[i] = r->slots[(tail + i) & RING_MASK];
+    if (n) atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+    return n;
+}
+
+
+static inline int RingEmpty(SampleRing *r) {
+    return atomic_load_explicit(&r->head, memory_order_acquire) == atomic_load_explicit(&r->tail, memory_order_relaxed);
+}
+
+
+static inline uint64_t RingDropped(SampleRing *r) {
+    return atomic_load_explicit(&r->dropped, memory_order_relaxed);
+}
+
+#endif /* RING_H */
@@ -0,0 +1,33 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   sample.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * One reading of a device, the record that travels from the sampler thread to the detector.
+ * Axes are in JOYINFOEX order.
+ */
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdint.h>
+
+enum { FPM_X = 0, FPM_Y, FPM_Z, FPM_R, FPM_U, FPM_V, FPM_AXES };
+
+#define FPM_MAX_DEVICES 16  // winmm joystick IDs go from 0 to 15
+#define FPM_MAX_WATCHES 32
+
+typedef struct {
+    int64_t  t_us;             // microseconds since the sampler started, from QueryPerformanceCounter
+    uint32_t axes[FPM_AXES];   // dwXpos, dwYpos, dwZpos, dwRpos, dwUpos, dwVpos
+    uint32_t buttons;
+    uint16_t device;           // index in the device list, not the joystick ID
+    uint16_t status;           // JOYERR_NOERROR or the error returned by the backend
+} FpmSample;
+
+#endif /* SAMPLE_H */
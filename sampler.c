@@ -0,0 +1,319 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   sampler.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The consumer only gets an event when it said it is about to sleep (consumer_waiting), so the
+ * sampler normally doesn't make any extra system call per sample.
+ *
+ * With fast_Sleep the winmm loop idles at sleep_Time while every watched axis is at rest or its gate is
+ * in use, and switches to fast_Sleep as soon as one leaves rest with the gate idle: what the detector looks
+ * for.  It stays fast for FAST_HOLD_MS after that, then goes back to the idle rate.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "windows.h"
+
+#include "sampler.h"
+#include "ring.h"
+#include "rawinput.h"
+#include "vjoy.h"
+#include "cores.h"
+#include "hotplug.h"
+#include "input.h"
+#include "etw.h"
+
+static SampleRing ring;
+static SamplerConfig cfg;
+static SampleTimer timer;
+
+static HANDLE thread = NULL;
+static HANDLE data_event = NULL;   // auto-reset, consumer sleeps on it
+static HANDLE ready_event = NULL;  // the thread finished opening the backend
+static atomic_int consumer_waiting;
+static atomic_int done;
+static atomic_int stop;
+static atomic_uint tolerance;      // SamplerSetTolerance(), applied by the sampler thread before its next wait
+static atomic_uint sleep_request;  // SamplerSetSleep(), 0: none
+static int start_failed = 0;
+
+#define FAST_HOLD_MS 2000
+#define REFIND_MS 3000      // after an arrival, a device can take a moment to show up in winmm
+#define REFIND_GAP_MS 50    // between two tries, a winmm try is up to 16 joyGetDevCaps()
+#define REFIND_NO_NOTIFY_MS 1000 // without hot-plug notifications, look for a missing device this often
+
+static LONGLONG start_qpc;
+static int64_t start_unix_us;
+
+static int missing[FPM_MAX_DEVICES];      // sampler thread only
+static int missing_count = 0;
+static volatile LONG joy_ID_now[FPM_MAX_DEVICES];
+
+
+static void WakeConsumer(void) {
+    atomic_thread_fence(memory_order_seq_cst); // the push must be visible before we look at consumer_waiting
+    if (atomic_exchange(&consumer_waiting, 0)) SetEvent(data_event);
+}
+
+
+/* s has the values just read, the sample gets its time stamp here */
+static void Push(FpmSample *s, int device) {
+    s->t_us = QpcToMicroseconds(QpcNow() - start_qpc);
+    s->device = (uint16_t)device;
+
+    if (cfg.vjoy) VJoyUpdate(s); // the filtered value is out before the consumer even wakes up
+    if (etw_on) EtwSample(s);
+    RingPush(&ring, s); // never blocks, counts the sample as lost if the consumer is too far behind
+}
+
+
+static void PushInfo(const JOYINFOEX *info, int device, MMRESULT mr) {
+    FpmSample s;
+    s.axes[FPM_X] = info->dwXpos;
+    s.axes[FPM_Y] = info->dwYpos;
+    s.axes[FPM_Z] = info->dwZpos;
+    s.axes[FPM_R] = info->dwRpos;
+    s.axes[FPM_U] = info->dwUpos;
+    s.axes[FPM_V] = info->dwVpos;
+    s.buttons = info->dwButtons;
+    s.status = (uint16_t)mr;
+    Push(&s, device);
+}
+
+
+/* Same gate and rest test as DetectorStep(), on the values just read.  rest and gate_rest come from the
+ * published rules, --calibrate and the control pipe change them on the main thread */
+static int LooksStuck(const FpmSample *polled) {
+    const WatchTable *wt = cfg.watches;
+    for (int w = 0; w < wt->count; w++) {
+        const FpmSample *s = &polled[wt->device[w]];
+        WatchRule rule;
+        WatchRuleRead(wt, w, &rule);
+        if (wt->gate_axis[w] >= 0 && s->axes[wt->gate_axis[w]] != rule.gate_rest) continue;
+        if (s->axes[wt->axis[w]] != rule.rest) return 1;
+    }
+    return 0;
+}
+
+
+static int Refind(int d) {
+    UINT id;
+    if (!InputRefind(d, &id)) return 0;
+    cfg.joy_IDs[d] = id;
+    InterlockedExchange(&joy_ID_now[d], (LONG)id);
+    return 1;
+}
+
+
+static DWORD WINAPI SamplerThread(LPVOID param) {
+    (void)param;
+    static JOYINFOEX info[FPM_MAX_DEVICES];
+    static FpmSample polled[FPM_MAX_DEVICES];
+    CoresSamplerThread(); // E-cores and no EcoQoS with --cores
+
+    for (int d = 0; d < cfg.devices; d++) {
+        memset(&info[d], 0, sizeof(info[d]));
+        info[d].dwSize = sizeof(info[d]);
+        info[d].dwFlags = cfg.joy_Flags; // Required: JOY_RETURNRAWDATA | JOY_RETURNR | JOY_RETURNV
+    }
+
+    // The windows of rawinput and DirectInput belong to the thread that creates them, so they're opened here
+    if (cfg.backend == INPUT_RAWINPUT ? RawInputOpen(cfg.joy_IDs, cfg.devices, cfg.joy_Flags) != 0
+            : InputOpen(cfg.joy_IDs, cfg.vids, cfg.pids, cfg.devices, cfg.joy_Flags) != 0) {
+        start_failed = 1;
+        SetEvent(ready_event);
+        return 1;
+    }
+    if (cfg.backend == INPUT_WINMM && SampleTimerStart(&timer, cfg.timer, cfg.sleep_Time) != 0) {
+        puts("Could not create the waitable timer, using Sleep()");
+        SampleTimerStart(&timer, TIMER_SLEEP, cfg.sleep_Time);
+    }
+    SetEvent(ready_event);
+
+    ULONGLONG stop_Tick = GetTickCount64() + (ULONGLONG)cfg.iterations * cfg.sleep_Time; // rawinput and fast_Sleep run for the same time as the winmm loop
+    ULONGLONG fast_Until = 0;
+    int adaptive = cfg.backend == INPUT_WINMM && cfg.fast_Sleep > 0 && cfg.watches != NULL;
+    HANDLE plug_Event = HotplugEvent();
+    LONG plug_Seen = HotplugChanges();
+    ULONGLONG refind_Until = 0, next_Refind = 0;
+
+    for (UINT i=1; !atomic_load_explicit(&stop, memory_order_relaxed); i++) {
+        if (cfg.backend == INPUT_WINMM) {
+            if (adaptive ? GetTickCount64() >= stop_Tick : i > cfg.iterations) break;
+            if (missing_count) {
+                ULONGLONG now = GetTickCount64();
+                LONG changes = HotplugChanges();
+                if (changes != plug_Seen) {
+                    plug_Seen = changes;
+                    joyConfigChanged(0); // winmm keeps its own list of joysticks
+                    refind_Until = now + REFIND_MS;
+                    next_Refind = now;
+                }
+                int look = plug_Event ? now < refind_Until : 1;
+                if (look && now >= next_Refind) {
+                    next_Refind = now + (plug_Event ? REFIND_GAP_MS : REFIND_NO_NOTIFY_MS);
+                    for (int d = 0; d < cfg.devices; d++)
+                        if (missing[d] && Refind(d)) { missing[d] = 0; missing_count--; }
+                }
+            }
+            for (int d = 0; d < cfg.devices; d++) {
+                if (missing[d]) continue;
+                InputRead(d, &polled[d]);
+                if (polled[d].status != JOYERR_NOERROR) { missing[d] = 1; missing_count++; } // pushed once with its error, then left alone
+                Push(&polled[d], d);
+            }
+            if (adaptive) {
+                ULONGLONG now = GetTickCount64();
+                if (LooksStuck(polled)) fast_Until = now + FAST_HOLD_MS;
+                SampleTimerSetPeriod(&timer, now < fast_Until ? cfg.fast_Sleep : cfg.sleep_Time);
+            }
+        } else {
+            ULONGLONG now = GetTickCount64();
+            if (now >= stop_Tick) break;
+            ULONGLONG left = stop_Tick - now;
+            // returns as soon as the pedals report a change, or after sleep_Time with the last values
+            int device;
+            int r = RawInputWait(info, &device, left < cfg.sleep_Time ? (DWORD)left : cfg.sleep_Time);
+            if (r == 1)
+                PushInfo(&info[device], device, JOYERR_NOERROR);
+            else // nothing changed for sleep_Time: every device is checked again with its last values
+                for (int d = 0; d < cfg.devices; d++) PushInfo(&info[d], d, r < 0 ? JOYERR_UNPLUGGED : JOYERR_NOERROR);
+        }
+        WakeConsumer();
+
+        if (cfg.backend == INPUT_WINMM && (adaptive || i < cfg.iterations)) {
+            if (missing_count == cfg.devices && plug_Event) { // nothing to read: wake up on the arrival instead
+                int refinding = GetTickCount64() < refind_Until;
+                // only a whole sleep_Time is an iteration, the short waits of a refind don't shorten --iterations
+                if (WaitForSingleObject(plug_Event, refinding ? REFIND_GAP_MS : cfg.sleep_Time) != WAIT_TIMEOUT || refinding) i--;
+            } else {
+                UINT sleep_Time = atomic_exchange_explicit(&sleep_request, 0, memory_order_relaxed);
+                if (sleep_Time) {
+                    cfg.sleep_Time = sleep_Time;
+                    if (!adaptive) SampleTimerSetPeriod(&timer, sleep_Time); // adaptive picks it up on the next sample
+                }
+                SampleTimerSetTolerance(&timer, atomic_load_explicit(&tolerance, memory_order_relaxed));
+                SampleTimerWait(&timer);
+            }
+        }
+    }
+
+    if (cfg.backend == INPUT_RAWINPUT) RawInputClose();
+    else InputClose();
+
+    atomic_store(&done, 1);
+    SetEvent(data_event);
+    return 0;
+}
+
+
+int SamplerStart(const SamplerConfig *config) {
+    cfg = *config;
+    RingInit(&ring);
+    atomic_init(&consumer_waiting, 0);
+    atomic_init(&done, 0);
+    atomic_init(&stop, 0);
+    atomic_init(&tolerance, 0);
+    atomic_init(&sleep_request, 0);
+    missing_count = 0;
+    for (int d = 0; d < FPM_MAX_DEVICES; d++) {
+        missing[d] = 0;
+        joy_ID_now[d] = (LONG)cfg.joy_IDs[d];
+    }
+    if (cfg.backend == INPUT_WINMM) HotplugStart(); // without it a missing device is looked for once a second
+
+    data_event  = CreateEvent(NULL, FALSE, FALSE, NULL);
+    ready_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+    start_unix_us = UnixMicrosecondsNow();
+    start_qpc  = QpcNow();
+
+    thread = CreateThread(NULL, 0, SamplerThread, NULL, 0, NULL);
+    if (thread == NULL) return -1;
+
+    WaitForSingleObject(ready_event, INFINITE);
+    if (start_failed) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+        thread = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+
+int SamplerNextBatch(FpmSample *s, int max, DWORD timeout_ms) {
+    int n = RingPopBatch(&ring, s, max);
+    if (n) return n;
+    if (atomic_load(&done)) return (n = RingPopBatch(&ring, s, max)) ? n : -1;
+
+    atomic_store(&consumer_waiting, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (RingEmpty(&ring) && !atomic_load(&done)) WaitForSingleObject(data_event, timeout_ms);
+    atomic_store(&consumer_waiting, 0);
+
+    if ((n = RingPopBatch(&ring, s, max))) return n;
+    return atomic_load(&done) && RingEmpty(&ring) ? -1 : 0;
+}
+
+
+int SamplerNext(FpmSample *s, DWORD timeout_ms) {
+    return SamplerNextBatch(s, 1, timeout_ms);
+}
+
+
+int64_t SamplerStartUnixMicroseconds(void) {
+    return start_unix_us;
+}
+
+
+UINT SamplerJoystickID(int device) {
+    return (UINT)joy_ID_now[device];
+}
+
+
+HANDLE SamplerThreadHandle(void) {
+    return thread;
+}
+
+
+ULONGLONG SamplerLost(void) {
+    return RingDropped(&ring);
+}
+
+
+void SamplerSetSleep(UINT sleep_ms) {
+    if (sleep_ms) atomic_store_explicit(&sleep_request, sleep_ms, memory_order_relaxed);
+}
+
+
+void SamplerSetTolerance(UINT tolerance_ms) {
+    atomic_store_explicit(&tolerance, tolerance_ms, memory_order_relaxed);
+}
+
+
+const SampleTimer *SamplerTimer(void) {
+    return &timer;
+}
+
+
+void SamplerStop(void) {
+    if (thread == NULL) return;
+    atomic_store(&stop, 1);
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    thread = NULL;
+    if (cfg.backend == INPUT_WINMM) {
+        SampleTimerStop(&timer);
+        HotplugStop();
+    }
+    CloseHandle(data_event);
+    CloseHandle(ready_event);
+}
@@ -0,0 +1,81 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   sampler.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Acquisition thread.  It only reads the devices, stamps the sample and pushes it into the SPSC ring;
+ * detection, printf() and alerts run on the consumer (main) thread, so a slow console or a redirected
+ * stdout can't slow down the sampling anymore.
+ *
+ * winmm: a device whose InputRead() fails is pushed once with the error and then not read anymore.
+ * After a hot-plug arrival (hotplug.h) it is looked for again by VendorID/ProductID under every joystick
+ * ID, Windows often gives a reconnected device a different one.
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "windows.h"
+#include "sample.h"
+#include "timer.h"
+#include "watch.h"
+
+typedef enum {
+    INPUT_WINMM = 0,  // poll the input built in (input.h) every sleep_Time, joyGetPosEx() by default
+    INPUT_RAWINPUT    // wait for WM_INPUT reports, see rawinput.c
+} InputBackend;
+
+typedef struct {
+    int devices;
+    UINT joy_IDs[FPM_MAX_DEVICES];  // sample.device is the index in this array
+    WORD vids[FPM_MAX_DEVICES];     // from joyGetDevCaps() at start, 0 and 0: only the same ID comes back
+    WORD pids[FPM_MAX_DEVICES];
+    DWORD joy_Flags;
+    UINT iterations;
+    UINT sleep_Time;
+    UINT fast_Sleep;                // winmm: > 0 samples every fast_Sleep ms while a watch looks stuck, sleep_Time otherwise
+    const WatchTable *watches;      // for fast_Sleep, only the rules are read, with WatchRuleRead()
+    int vjoy;                       // 1: every sample goes through VJoyUpdate() before the ring, see vjoy.h
+    InputBackend backend;
+    TimerKind timer;
+} SamplerConfig;
+
+/* Returns 0 when the thread is running */
+int SamplerStart(const SamplerConfig *config);
+
+/* Consumer side.  SamplerNext() waits up to timeout_ms for a sample.
+ * Returns 1 with a sample, 0 on timeout, -1 when the sampler finished and every sample was consumed */
+int SamplerNext(FpmSample *s, DWORD timeout_ms);
+
+/* The same for up to max samples, whatever the ring has: returns how many, 0 on timeout, -1 at the end */
+int SamplerNextBatch(FpmSample *s, int max, DWORD timeout_ms);
+
+/* Wall clock of t_us == 0, microseconds since 1970 */
+int64_t SamplerStartUnixMicroseconds(void);
+
+/* Joystick ID device is read from now, it changes when the device comes back under another ID */
+UINT SamplerJoystickID(int device);
+
+/* For --resources.  NULL when it isn't running */
+HANDLE SamplerThreadHandle(void);
+
+/* Samples dropped because the ring was full */
+ULONGLONG SamplerLost(void);
+
+/* winmm with the waitable timer: the sampler may wake up to tolerance_ms late, 0 goes back to exact deadlines */
+void SamplerSetTolerance(UINT tolerance_ms);
+
+/* winmm: the idle sample period from the next wait on, for the control pipe */
+void SamplerSetSleep(UINT sleep_ms);
+
+/* Read only.  The consumer may print it while the sampler updates it, the counters are 64-bit aligned */
+const SampleTimer *SamplerTimer(void);
+
+void SamplerStop(void);
+
+#endif /* SAMPLER_H */
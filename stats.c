@@ -0,0 +1,52 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   stats.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+
+#include "stats.h"
+
+
+void StatsInit(MonitorStats *st) {
+    for (int d = 0; d < FPM_MAX_DEVICES; d++) {
+        st->last_t[d] = -1;
+        HistReset(&st->interval_us[d]);
+    }
+    for (int w = 0; w < MAX_WATCHES; w++) HistReset(&st->run_length[w]);
+}
+
+
+void StatsSample(MonitorStats *st, const FpmSample *s) {
+    if (st->last_t[s->device] >= 0) HistAdd(&st->interval_us[s->device], (uint64_t)(s->t_us - st->last_t[s->device]));
+    st->last_t[s->device] = s->t_us;
+}
+
+
+void StatsRuns(MonitorStats *st, const WatchTable *wt, int device, const uint16_t *run_before, uint32_t alerts) {
+    int w_End = wt->first[device] + wt->n[device];
+    for (int w = wt->first[device]; w < w_End; w++) {
+        if (alerts & (1u << w)) HistAdd(&st->run_length[w], run_before[w] + 1u);  // reached repeat, counting starts again
+        else if (run_before[w] && wt->run[w] == 0) HistAdd(&st->run_length[w], run_before[w]);
+    }
+}
+
+
+void StatsPrint(const MonitorStats *st, const WatchTable *wt) {
+    char name[64];
+
+    for (int d = 0; d < wt->device_count; d++) {
+        snprintf(name, sizeof(name), "Sample interval joystick %u", wt->joy_ID[d]);
+        HistPrint(&st->interval_us[d], name, "us");
+    }
+    for (int w = 0; w < wt->count; w++) {
+        snprintf(name, sizeof(name), "Stuck run %s", wt->specs[w].name);
+        HistPrint(&st->run_length[w], name, "samples");
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   stats.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * What the live loop measures while it runs: the interval between two samples of the same device and the
+ * length of every stuck run (consecutive samples counted by the detector until it resets or alerts).
+ * Fixed memory, the histograms are part of MonitorStats; O(1) per sample.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include "hist.h"
+#include "sample.h"
+#include "watch.h"
+
+typedef struct {
+    int64_t last_t[FPM_MAX_DEVICES];     // -1: no sample yet
+    Histogram interval_us[FPM_MAX_DEVICES];
+    Histogram run_length[MAX_WATCHES];   // in samples
+} MonitorStats;
+
+void StatsInit(MonitorStats *st);
+
+/* Call with every sample, before DetectorFeed() */
+void StatsSample(MonitorStats *st, const FpmSample *s);
+
+/* Call after DetectorFeed() with the runs of the device before it, and the alert mask it returned */
+void StatsRuns(MonitorStats *st, const WatchTable *wt, int device, const uint16_t *run_before, uint32_t alerts);
+
+void StatsPrint(const MonitorStats *st, const WatchTable *wt);
+
+#endif /* STATS_H */
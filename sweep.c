@@ -0,0 +1,401 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   sweep.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The traces are decoded once into plain arrays (time, axis, gate axis of the swept watch) and shared
+ * read only by all the workers, every worker runs DetectorScan() over them for one combination at a time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sweep.h"
+#include "detector.h"
+#include "recorder.h"
+#include "replay.h"
+#include "timer.h"
+
+#define SWEEP_MAX_THREADS MAXIMUM_WAIT_OBJECTS
+#define SWEEP_MAX_SEGMENTS 4096
+#define SWEEP_MAX_COMBINATIONS 1000000
+#define SWEEP_TOP 20
+#define ALERT_CHUNK 4096
+
+extern int verbose_flag; /* main.c */
+
+typedef struct {
+    size_t n, cap;
+    int64_t *t_us;
+    uint16_t *axis;
+    uint16_t *gate;             // NULL: the watch has no gate
+    int gated;
+    size_t *breaks;             // a failed read came before these samples, the run starts again there
+    size_t break_n, break_cap;
+} Trace;
+
+typedef struct {
+    int trace;
+    int64_t start_us, end_us;
+} Segment;
+
+typedef struct {
+    int margin_pct, repeat, gate_rest;
+    unsigned long long alerts, false_positives;
+    int detected;               // labeled segments with at least one alert
+    double first_s;             // first alert from the start of its trace, -1: none
+    double latency_s;           // mean time from the start of a detected segment to its first alert
+} SweepResult;
+
+static Trace traces[SWEEP_MAX_TRACES];
+static int trace_count = 0;
+static Segment segments[SWEEP_MAX_SEGMENTS];
+static int segment_count = 0;
+static int segment_first[SWEEP_MAX_TRACES + 1]; // segments of trace k: segment_first[k] .. segment_first[k+1]-1
+static uint32_t axis_rest, axis_min;
+
+static SweepResult *results = NULL;
+static volatile LONG next_job = 0;
+static LONG job_count = 0;
+
+
+void SweepInit(SweepConfig *sc) {
+    memset(sc, 0, sizeof(*sc));
+    sc->margin = (SweepRange){ 0, 20, 1 };
+    sc->repeat = (SweepRange){ 2, 12, 1 };
+    sc->gate = (SweepRange){ AXIS_REST, AXIS_REST, 1 };
+    sc->csv_File = "sweep.csv";
+}
+
+
+int SweepAddTrace(SweepConfig *sc, const char *path) {
+    if (sc->trace_count == SWEEP_MAX_TRACES) {
+        printf("Too many --sweep, the maximum is %d\n", SWEEP_MAX_TRACES);
+        return -1;
+    }
+    sc->traces[sc->trace_count++] = path;
+    return 0;
+}
+
+
+int SweepParseRange(SweepRange *range, const char *text) {
+    int lo, hi, step = 1;
+    int fields = sscanf(text, "%d:%d:%d", &lo, &hi, &step);
+
+    if (fields == 1) hi = lo;
+    if (fields < 1 || lo > hi || step < 1) {
+        printf("Wrong range '%s', use lo:hi[:step] or a single value\n", text);
+        return -1;
+    }
+    range->lo = lo;
+    range->hi = hi;
+    range->step = step;
+    return 0;
+}
+
+
+static int Grow(Trace *t) {
+    size_t cap = t->cap ? t->cap * 2 : 1 << 16;
+    int64_t *tt = (int64_t *)realloc(t->t_us, cap * sizeof(*tt));
+    if (tt) t->t_us = tt;
+    uint16_t *a = (uint16_t *)realloc(t->axis, cap * sizeof(*a));
+    if (a) t->axis = a;
+    uint16_t *g = t->gated ? (uint16_t *)realloc(t->gate, cap * sizeof(*g)) : NULL;
+    if (g) t->gate = g;
+    if (!tt || !a || (t->gated && !g)) return -1;
+    t->cap = cap;
+    return 0;
+}
+
+
+/* Keeps only the device, axis and gate axis of watch 0 */
+static int LoadTrace(FpmReader *rd, const char *path, const WatchTable *wt, Trace *t) {
+    const FpmHeader *h = &rd->header;
+    int device = -1;
+    for (int d = 0; d < h->device_count; d++)
+        if (h->devices[d].joy_ID == wt->joy_ID[wt->device[0]]) device = d;
+    if (device < 0) {
+        printf("Joystick %u is not in '%s', skipped\n", wt->joy_ID[wt->device[0]], path);
+        return -1;
+    }
+
+    int axis = wt->axis[0], gate_axis = wt->gate_axis[0];
+    t->gated = gate_axis >= 0;
+    FpmSample s;
+    int r;
+    while ((r = FpmReaderNext(rd, &s)) == 1) {
+        if (s.device != device) continue;
+        if (s.status != 0) { // as DetectorFeed(), the sample itself is not part of the trace
+            if (t->break_n && t->breaks[t->break_n - 1] == t->n) continue;
+            if (t->break_n == t->break_cap) {
+                size_t cap = t->break_cap ? t->break_cap * 2 : 64;
+                size_t *b = (size_t *)realloc(t->breaks, cap * sizeof(*b));
+                if (b == NULL) {
+                    puts("Not enough memory for the sweep");
+                    return -1;
+                }
+                t->breaks = b;
+                t->break_cap = cap;
+            }
+            t->breaks[t->break_n++] = t->n;
+            continue;
+        }
+        if (t->n == t->cap && Grow(t) != 0) {
+            puts("Not enough memory for the sweep");
+            return -1;
+        }
+        t->t_us[t->n] = s.t_us;
+        t->axis[t->n] = (uint16_t)s.axes[axis];
+        if (t->gated) t->gate[t->n] = (uint16_t)s.axes[gate_axis];
+        t->n++;
+    }
+    if (r < 0) printf("'%s' is corrupt after %llu samples, using what was read\n", path, (unsigned long long)t->n);
+    return 0;
+}
+
+
+static int CompareSegments(const void *a, const void *b) {
+    const Segment *x = (const Segment *)a, *y = (const Segment *)b;
+    if (x->trace != y->trace) return x->trace - y->trace;
+    return x->start_us < y->start_us ? -1 : x->start_us > y->start_us;
+}
+
+
+static int LoadLabels(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("Could not read '%s'\n", path);
+        return -1;
+    }
+
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        double a, b, c;
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        if (segment_count == SWEEP_MAX_SEGMENTS) {
+            printf("Too many segments in '%s', the maximum is %d\n", path, SWEEP_MAX_SEGMENTS);
+            break;
+        }
+
+        Segment *seg = &segments[segment_count];
+        int fields = sscanf(line, "%lf,%lf,%lf", &a, &b, &c);
+        if (fields == 2) { seg->trace = 0; seg->start_us = (int64_t)(a * 1e6); seg->end_us = (int64_t)(b * 1e6); }
+        else if (fields == 3) { seg->trace = (int)a; seg->start_us = (int64_t)(b * 1e6); seg->end_us = (int64_t)(c * 1e6); }
+        else {
+            printf("Wrong line %d in '%s': %s", line_no, path, line);
+            continue;
+        }
+        if (seg->trace < 0 || seg->trace >= trace_count || seg->end_us < seg->start_us) {
+            printf("Wrong segment in line %d of '%s'\n", line_no, path);
+            continue;
+        }
+        segment_count++;
+    }
+    fclose(f);
+
+    qsort(segments, segment_count, sizeof(segments[0]), CompareSegments);
+    return 0;
+}
+
+
+static void Evaluate(SweepResult *res, uint32_t *alert_at) {
+    DetectorRule rule;
+    rule.margin = (axis_rest - axis_min) * res->margin_pct / 100; // same as WatchCalibrate()
+    rule.rest = axis_rest;
+    rule.gate_rest = (uint32_t)res->gate_rest;
+    rule.repeat = (uint32_t)res->repeat;
+
+    char hit[SWEEP_MAX_SEGMENTS];
+    memset(hit, 0, segment_count);
+    double latency_sum = 0;
+    res->first_s = -1;
+
+    for (int k = 0; k < trace_count; k++) {
+        const Trace *t = &traces[k];
+        DetectorState st = { 0, 0 };
+        int seg = segment_first[k], seg_End = segment_first[k + 1];
+        size_t next_Break = 0;
+
+        for (size_t pos = 0; pos < t->n; ) {
+            while (next_Break < t->break_n && t->breaks[next_Break] <= pos) {
+                if (t->breaks[next_Break++] == pos) st.run = 0;
+            }
+            size_t end = next_Break < t->break_n ? t->breaks[next_Break] : t->n;
+            int count;
+            size_t used = DetectorScan(&rule, &st, t->axis + pos, t->gate ? t->gate + pos : NULL,
+                                       end - pos, alert_at, ALERT_CHUNK, &count);
+            for (int i = 0; i < count; i++) {
+                int64_t when = t->t_us[pos + alert_at[i]];
+                res->alerts++;
+                if (res->first_s < 0) res->first_s = when / 1e6;
+
+                while (seg < seg_End && segments[seg].end_us < when) seg++;
+                if (seg < seg_End && segments[seg].start_us <= when) {
+                    if (!hit[seg]) {
+                        hit[seg] = 1;
+                        res->detected++;
+                        latency_sum += (when - segments[seg].start_us) / 1e6;
+                    }
+                } else
+                    res->false_positives++;
+            }
+            pos += used;
+        }
+    }
+    res->latency_s = res->detected ? latency_sum / res->detected : 0;
+}
+
+
+static DWORD WINAPI SweepWorker(LPVOID arg) {
+    uint32_t alert_at[ALERT_CHUNK];
+    (void)arg;
+
+    for (;;) {
+        LONG job = InterlockedIncrement(&next_job) - 1;
+        if (job >= job_count) break;
+        Evaluate(&results[job], alert_at);
+    }
+    return 0;
+}
+
+
+/* Best first: more segments detected, fewer false positives, faster detection, then the most sensitive setting */
+static int CompareResults(const void *a, const void *b) {
+    const SweepResult *x = (const SweepResult *)a, *y = (const SweepResult *)b;
+    if (x->detected != y->detected) return y->detected - x->detected;
+    if (x->false_positives != y->false_positives) return x->false_positives < y->false_positives ? -1 : 1;
+    if (x->latency_s != y->latency_s) return x->latency_s < y->latency_s ? -1 : 1;
+    if (x->repeat != y->repeat) return x->repeat - y->repeat;
+    if (x->margin_pct != y->margin_pct) return y->margin_pct - x->margin_pct;
+    return x->gate_rest - y->gate_rest;
+}
+
+
+static double FalsePositiveRate(const SweepResult *r) {
+    return r->alerts ? 100.0 * r->false_positives / r->alerts : 0;
+}
+
+
+int SweepRun(const SweepConfig *sc, WatchTable *wt, UINT joy_ID, UINT margin_pct) {
+    static FpmReader rd;
+    unsigned long long samples = 0;
+
+    for (int k = 0; k < sc->trace_count; k++) {
+        if (FpmReaderOpen(&rd, sc->traces[k]) != 0) {
+            printf("Could not read '%s', or it is not a --record file\n", sc->traces[k]);
+            return EXIT_FAILURE;
+        }
+        if (wt->count == 0) { // the first trace decides the default joystick, like --replay
+            WatchFinish(wt, joy_ID < FPM_MAX_DEVICES ? joy_ID : rd.header.devices[0].joy_ID, margin_pct);
+            ReplayCalibrate(&rd.header, wt);
+            axis_rest = wt->rest[0];
+            axis_min = wt->axis_min[0];
+            if (verbose_flag) WatchPrint(wt);
+        }
+        if (LoadTrace(&rd, sc->traces[k], wt, &traces[trace_count]) == 0) {
+            samples += traces[trace_count].n;
+            trace_count++;
+        }
+        FpmReaderClose(&rd);
+    }
+    if (trace_count == 0) return EXIT_FAILURE;
+    if (sc->repeat.lo < 1) {
+        puts("--sweep_repeat must start at 1 or more");
+        return EXIT_FAILURE;
+    }
+
+    if (sc->labels_File && LoadLabels(sc->labels_File) != 0) return EXIT_FAILURE;
+    for (int k = 0, s = 0; k <= trace_count; k++) {
+        while (s < segment_count && segments[s].trace < k) s++;
+        segment_first[k] = s;
+    }
+
+    // the grid, the gate range only matters if the watch has a gate
+    SweepRange gate = sc->gate;
+    if (wt->gate_axis[0] < 0) gate.lo = gate.hi = AXIS_REST;
+    else if (gate.lo == AXIS_REST && gate.hi == AXIS_REST) gate.lo = gate.hi = (int)wt->gate_rest[0]; // the default, rest of the recording
+    long long combinations = (long long)((sc->margin.hi - sc->margin.lo) / sc->margin.step + 1)
+                           * ((sc->repeat.hi - sc->repeat.lo) / sc->repeat.step + 1)
+                           * ((gate.hi - gate.lo) / gate.step + 1);
+    if (combinations > SWEEP_MAX_COMBINATIONS) {
+        printf("%lld combinations, the maximum is %d\n", combinations, SWEEP_MAX_COMBINATIONS);
+        return EXIT_FAILURE;
+    }
+    results = (SweepResult *)calloc((size_t)combinations, sizeof(SweepResult));
+    if (results == NULL) {
+        puts("Not enough memory for the sweep");
+        return EXIT_FAILURE;
+    }
+    job_count = 0;
+    for (int m = sc->margin.lo; m <= sc->margin.hi; m += sc->margin.step)
+        for (int r = sc->repeat.lo; r <= sc->repeat.hi; r += sc->repeat.step)
+            for (int g = gate.lo; g <= gate.hi; g += gate.step) {
+                SweepResult *res = &results[job_count++];
+                res->margin_pct = m;
+                res->repeat = r;
+                res->gate_rest = g;
+            }
+
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    int threads = (int)si.dwNumberOfProcessors;
+    if (threads > SWEEP_MAX_THREADS) threads = SWEEP_MAX_THREADS;
+    if (threads > job_count) threads = (int)job_count;
+    if (threads < 1) threads = 1;
+
+    LONGLONG start = QpcNow();
+    HANDLE pool[SWEEP_MAX_THREADS];
+    int started = 0;
+    next_job = 0;
+    for (int i = 0; i < threads; i++) {
+        pool[started] = CreateThread(NULL, 0, SweepWorker, NULL, 0, NULL);
+        if (pool[started]) started++;
+    }
+    if (started == 0) SweepWorker(NULL);
+    WaitForMultipleObjects(started, pool, TRUE, INFINITE);
+    for (int i = 0; i < started; i++) CloseHandle(pool[i]);
+    double seconds = QpcToMicroseconds(QpcNow() - start) / 1e6;
+
+    qsort(results, (size_t)job_count, sizeof(results[0]), CompareResults);
+
+    printf("Sweep: traces=[%d] samples=[%llu] segments=[%d] combinations=[%ld] threads=[%d] seconds=[%.3f] samples/s=[%.0f]\n",
+           trace_count, samples, segment_count, job_count, started ? started : 1, seconds,
+           seconds > 0 ? samples * (double)job_count / seconds : 0.0);
+    printf("Rank  Margin  Repeat  Gate    Alerts  Detected  False+  False+%%  First alert s  Latency s\n");
+    for (int i = 0; i < job_count && i < SWEEP_TOP; i++) {
+        const SweepResult *r = &results[i];
+        printf("%4d  %6d  %6d  %4d  %8llu  %4d/%-4d %6llu  %6.1f%%  %13.3f  %9.3f\n", i + 1,
+               r->margin_pct, r->repeat, r->gate_rest, r->alerts, r->detected, segment_count,
+               r->false_positives, FalsePositiveRate(r), r->first_s, r->latency_s);
+    }
+
+    FILE *csv = fopen(sc->csv_File, "w");
+    if (csv == NULL) printf("Could not create '%s'\n", sc->csv_File);
+    else {
+        fprintf(csv, "rank,margin,repeat,gate,alerts,detected,segments,false_positives,false_positive_pct,first_alert_s,latency_s\n");
+        for (int i = 0; i < job_count; i++) {
+            const SweepResult *r = &results[i];
+            fprintf(csv, "%d,%d,%d,%d,%llu,%d,%d,%llu,%.2f,%.3f,%.3f\n", i + 1, r->margin_pct, r->repeat, r->gate_rest,
+                    r->alerts, r->detected, segment_count, r->false_positives, FalsePositiveRate(r), r->first_s, r->latency_s);
+        }
+        fclose(csv);
+        printf("All %ld combinations in '%s'\n", job_count, sc->csv_File);
+    }
+
+    free(results);
+    for (int k = 0; k < trace_count; k++) {
+        free(traces[k].t_us);
+        free(traces[k].axis);
+        free(traces[k].gate);
+        free(traces[k].breaks);
+    }
+    return EXIT_SUCCESS;
+}
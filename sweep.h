@@ -0,0 +1,53 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   sweep.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --sweep file.fpm [--sweep file.fpm]... tries every combination of margin, repeat count and gate rest value
+ * on the first watch (the first --watch, or the original rule) over one or more --record traces.
+ * The combinations are independent: a pool with one thread per processor takes them from a shared counter.
+ *
+ * --labels file.csv lists the segments where the pedal really was failing, one per line:
+ *      start_seconds,end_seconds   or   trace,start_seconds,end_seconds   (trace: position of its --sweep, from 0)
+ * An alert inside a segment detects it, an alert outside any segment is a false positive.  Without labels
+ * every alert counts as a false positive, so the best ranked setting is the most sensitive one that stays
+ * quiet on a healthy recording.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "windows.h"
+#include "watch.h"
+
+#define SWEEP_MAX_TRACES 16
+
+typedef struct {
+    int lo, hi, step;
+} SweepRange;
+
+typedef struct {
+    int trace_count;
+    const char *traces[SWEEP_MAX_TRACES];
+    SweepRange margin;          // --sweep_margin, percentage
+    SweepRange repeat;          // --sweep_repeat
+    SweepRange gate;            // --sweep_gate, value of the gate axis at rest
+    const char *labels_File;    // --labels
+    const char *csv_File;       // --sweep_csv, every combination, ranked
+} SweepConfig;
+
+void SweepInit(SweepConfig *sc);
+
+/* Returns 0, or -1 (and prints why) */
+int SweepAddTrace(SweepConfig *sc, const char *path);
+int SweepParseRange(SweepRange *range, const char *text);  // lo:hi[:step] or a single value
+
+/* Prints the best combinations and writes the CSV.  Returns the exit code of the program */
+int SweepRun(const SweepConfig *sc, WatchTable *wt, UINT joy_ID, UINT margin_pct);
+
+#endif /* SWEEP_H */
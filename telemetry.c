@@ -0,0 +1,138 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   telemetry.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Only the consumer thread writes the block, so the seqlock needs no interlocked instruction:
+ * two stores of seq and release fences that keep the compiler and the CPU from moving the data outside of them.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "windows.h"
+#include "telemetry.h"
+
+extern int verbose_flag; /* main.c */
+
+static HANDLE mapping = NULL;
+static TelemetryBlock *block = NULL;
+
+
+static void BeginWrite(void) {
+    block->seq = block->seq + 1;
+    atomic_thread_fence(memory_order_release);
+}
+
+
+static void EndWrite(void) {
+    atomic_thread_fence(memory_order_release);
+    block->seq = block->seq + 1;
+}
+
+
+int TelemetryOpen(const WatchTable *wt, int64_t start_unix_us, uint32_t period_us) {
+    mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(TelemetryBlock), TELEMETRY_NAME);
+    if (mapping == NULL) {
+        if (verbose_flag) printf("CreateFileMapping(%s) failed, error=[%lu]\n", TELEMETRY_NAME, GetLastError());
+        return -1;
+    }
+    block = (TelemetryBlock *)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(TelemetryBlock));
+    if (block == NULL) {
+        if (verbose_flag) printf("MapViewOfFile(%s) failed, error=[%lu]\n", TELEMETRY_NAME, GetLastError());
+        CloseHandle(mapping);
+        mapping = NULL;
+        return -1;
+    }
+
+    // a reader may still have the mapping of a previous run open, keep seq going up
+    BeginWrite();
+    memset((char *)block + offsetof(TelemetryBlock, start_unix_us), 0, sizeof(TelemetryBlock) - offsetof(TelemetryBlock, start_unix_us));
+    block->magic = TELEMETRY_MAGIC;
+    block->version = TELEMETRY_VERSION;
+    block->size = sizeof(TelemetryBlock);
+    block->start_unix_us = start_unix_us;
+    block->last_alert_us = -1;
+    block->state = TELEMETRY_RUNNING;
+    block->period_us = period_us;
+    block->device_count = (uint32_t)wt->device_count;
+    block->watch_count = (uint32_t)wt->count;
+    for (int d = 0; d < wt->device_count; d++) block->devices[d].joy_ID = wt->joy_ID[d];
+    for (int w = 0; w < wt->count; w++) {
+        TelemetryWatch *tw = &block->watches[w];
+        tw->last_alert_us = -1;
+        tw->device = wt->device[w];
+        tw->axis = wt->axis[w];
+        tw->repeat = wt->repeat[w];
+        strncpy(tw->name, wt->specs[w].name, sizeof(tw->name) - 1);
+    }
+    EndWrite();
+    return 0;
+}
+
+
+void TelemetryUpdate(const WatchTable *wt, const FpmSample *s, const uint16_t *run, uint32_t alerts, uint64_t lost, uint64_t timer_missed) {
+    if (block == NULL) return;
+
+    BeginWrite();
+    TelemetryDevice *td = &block->devices[s->device];
+    if (td->t_us) td->interval_us = (uint32_t)(s->t_us - td->t_us);
+    td->t_us = s->t_us;
+    td->status = s->status;
+    memcpy(td->axes, s->axes, sizeof(td->axes));
+    td->buttons = s->buttons;
+
+    int w_End = wt->first[s->device] + wt->n[s->device];
+    for (int w = wt->first[s->device]; w < w_End; w++) {
+        TelemetryWatch *tw = &block->watches[w];
+        tw->value = s->axes[wt->axis[w]];
+        tw->run = run[w];
+        if (alerts & (1u << w)) {
+            tw->alerts++;
+            tw->last_alert_us = s->t_us;
+            block->alerts++;
+            block->last_alert_us = s->t_us;
+        }
+    }
+    block->updated_us = s->t_us;
+    block->samples++;
+    block->lost = lost;
+    block->timer_missed = timer_missed;
+    EndWrite();
+}
+
+
+void TelemetryUpdateResources(int64_t t_us, const ResourceSnapshot *first, const ResourceSnapshot *latest, const ResourceRates *rates) {
+    if (block == NULL) return;
+
+    BeginWrite();
+    TelemetryResources *tr = &block->resources;
+    tr->measured_us = t_us;
+    tr->cpu_us = latest->cpu_us - first->cpu_us;
+    tr->cycles = latest->cycles - first->cycles;
+    tr->context_switches = latest->switches - first->switches;
+    tr->private_bytes = latest->private_bytes;
+    tr->cycles_per_sample = rates->cycles_per_sample;
+    tr->wakeups_per_s = rates->wakeups_per_s;
+    EndWrite();
+}
+
+
+void TelemetryClose(void) {
+    if (block == NULL) return;
+
+    BeginWrite();
+    block->state = TELEMETRY_STOPPED;
+    EndWrite();
+    UnmapViewOfFile(block);
+    CloseHandle(mapping);
+    block = NULL;
+    mapping = NULL;
+}
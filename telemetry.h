@@ -0,0 +1,104 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   telemetry.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Live view of the monitor in the named file mapping Local\FanatecMonitorTelemetry, for Joystick Gremlin
+ * plugins and overlays.  Readers map it read only and poll it, the monitor never waits for them.
+ * The telemetry sink (main.c) gets its samples in batches handed over at most every 16 ms, one
+ * overlay frame, so the block may be up to 16 ms behind the latest sample.
+ *
+ * Layout is TelemetryBlock below, little endian, no padding (every field is naturally aligned).
+ * seq is a seqlock: odd while the monitor is writing.  A reader does
+ *      do { s1 = seq; wait while s1 is odd; copy the block; s2 = seq; } while (s1 != s2);
+ * In Python: mmap.mmap(-1, size, "Local\\FanatecMonitorTelemetry", access=mmap.ACCESS_READ) and struct.unpack_from().
+ * magic, version and size never change while the mapping exists, check them once.
+ * Version 2 added resources at the end, every offset of version 1 is the same.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#include "sample.h"
+#include "watch.h"
+#include "resources.h"
+
+#define TELEMETRY_NAME "Local\\FanatecMonitorTelemetry"
+#define TELEMETRY_MAGIC 0x544D5046    // "FPMT"
+#define TELEMETRY_VERSION 2
+
+enum { TELEMETRY_RUNNING = 1, TELEMETRY_STOPPED = 2 };
+
+typedef struct {                 // 48 bytes
+    int64_t  t_us;               // of the latest sample, microseconds since start_unix_us
+    uint32_t joy_ID;
+    uint32_t status;             // JOYERR_NOERROR or the error of the latest sample
+    uint32_t axes[FPM_AXES];     // X Y Z R U V
+    uint32_t buttons;
+    uint32_t interval_us;        // between the latest two samples
+} TelemetryDevice;
+
+typedef struct {                 // 56 bytes
+    int64_t  last_alert_us;      // -1: never
+    uint32_t device;             // index in devices[]
+    uint32_t axis;               // FPM_X .. FPM_V
+    uint32_t value;              // latest value of the axis
+    uint32_t run;                // stuck samples so far, 0 when it moves
+    uint32_t repeat;             // run that raises an alert
+    uint32_t alerts;
+    char     name[24];
+} TelemetryWatch;
+
+typedef struct {                 // 56 bytes, all 0 without --resources
+    int64_t  measured_us;        // t_us of the latest measurement
+    uint64_t cpu_us;             // user + kernel time of the process since the start
+    uint64_t cycles;             // of the process since the start
+    uint64_t context_switches;   // of every thread of the process since the start
+    uint64_t private_bytes;      // private working set
+    double   cycles_per_sample;  // over the latest interval
+    double   wakeups_per_s;      // context switches per second over the latest interval
+} TelemetryResources;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;               // sizeof(TelemetryBlock)
+    volatile uint32_t seq;
+    int64_t  start_unix_us;      // wall clock of t_us == 0, microseconds since 1970
+    int64_t  updated_us;         // t_us of the latest update
+    uint64_t samples;
+    uint64_t lost;               // dropped because the ring was full
+    uint64_t timer_missed;       // sample deadlines skipped, winmm backend
+    int64_t  last_alert_us;      // -1: never
+    uint32_t alerts;
+    uint32_t state;              // TELEMETRY_RUNNING, TELEMETRY_STOPPED
+    uint32_t period_us;          // requested sample period, 0 for rawinput
+    uint32_t device_count;
+    uint32_t watch_count;
+    uint32_t reserved;
+    TelemetryDevice devices[FPM_MAX_DEVICES];
+    TelemetryWatch watches[MAX_WATCHES];
+    TelemetryResources resources; // version 2
+} TelemetryBlock;
+
+/* Creates the mapping.  Returns 0 on success, the monitor runs without it otherwise */
+int  TelemetryOpen(const WatchTable *wt, int64_t start_unix_us, uint32_t period_us);
+
+/* The telemetry sink (pipeline.h), run[] is wt->run after DetectorFeed().  A few cache lines, no system call.
+ * Only one thread may write, TelemetryUpdateResources() runs on the same one */
+void TelemetryUpdate(const WatchTable *wt, const FpmSample *s, const uint16_t *run, uint32_t alerts, uint64_t lost, uint64_t timer_missed);
+
+/* After ResourcesMeasure(), first is the snapshot of ResourcesInit().  t_us: of the latest sample */
+void TelemetryUpdateResources(int64_t t_us, const ResourceSnapshot *first, const ResourceSnapshot *latest, const ResourceRates *rates);
+
+/* Marks the block TELEMETRY_STOPPED and unmaps it */
+void TelemetryClose(void);
+
+#endif /* TELEMETRY_H */
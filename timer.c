@@ -0,0 +1,166 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   timer.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * SetWaitableTimer() only takes relative times or wall clock times, so the absolute deadline is kept
+ * in QPC units and converted to a relative due time right before every wait.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "windows.h"
+
+#include "timer.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+static LONGLONG qpc_freq = 0;
+
+
+LONGLONG QpcNow(void) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+
+LONGLONG QpcToMicroseconds(LONGLONG ticks) {
+    if (qpc_freq == 0) {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        qpc_freq = f.QuadPart;
+    }
+    // split to avoid the overflow of ticks * 1000000 after a few days
+    return (ticks / qpc_freq) * 1000000 + (ticks % qpc_freq) * 1000000 / qpc_freq;
+}
+
+
+LONGLONG QpcToNanoseconds(LONGLONG ticks) {
+    if (qpc_freq == 0) QpcToMicroseconds(0);
+    return (ticks / qpc_freq) * 1000000000 + (ticks % qpc_freq) * 1000000000 / qpc_freq;
+}
+
+
+int64_t UnixMicrosecondsNow(void) {
+    FILETIME ft;
+    GetSystemTimePreciseAsFileTime(&ft); // 100 ns since 1601
+    ULONGLONG t100 = ((ULONGLONG)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (int64_t)((t100 - 116444736000000000ULL) / 10);
+}
+
+
+void FormatUnixMicroseconds(int64_t unix_us, char *out, size_t size) {
+    time_t secs = (time_t)(unix_us / 1000000);
+    struct tm *lt = localtime(&secs);
+    char when[32];
+
+    if (lt == NULL || strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", lt) == 0) {
+        snprintf(out, size, "%lld us", (long long)unix_us);
+        return;
+    }
+    snprintf(out, size, "%s.%06d", when, (int)(unix_us % 1000000));
+}
+
+
+int SampleTimerStart(SampleTimer *t, TimerKind kind, UINT period_ms) {
+    LARGE_INTEGER f;
+
+    memset(t, 0, sizeof(*t));
+    HistReset(&t->period_us);
+    QueryPerformanceFrequency(&f);
+    qpc_freq = f.QuadPart;
+
+    t->kind = kind;
+    t->period_ms = period_ms;
+    t->period_qpc = qpc_freq * period_ms / 1000;
+
+    if (kind == TIMER_WAITABLE) {
+        t->timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        t->high_resolution = (t->timer != NULL);
+        if (t->timer == NULL) // older than Windows 10 1803, the timer follows the system tick
+            t->timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+        if (t->timer == NULL) return -1;
+    }
+
+    t->last_qpc = QpcNow();
+    t->next_qpc = t->last_qpc + t->period_qpc;
+    return 0;
+}
+
+
+void SampleTimerSetPeriod(SampleTimer *t, UINT period_ms) {
+    if (period_ms == t->period_ms) return;
+    t->period_ms = period_ms;
+    t->period_qpc = qpc_freq * period_ms / 1000;
+    t->next_qpc = t->last_qpc + t->period_qpc;
+    t->rate_changes++;
+}
+
+
+void SampleTimerSetTolerance(SampleTimer *t, UINT tolerance_ms) {
+    t->tolerance_ms = tolerance_ms;
+}
+
+
+LONGLONG SampleTimerWait(SampleTimer *t) {
+    LONGLONG now;
+
+    if (t->kind == TIMER_SLEEP) {
+        Sleep(t->period_ms);
+        now = QpcNow();
+    } else {
+        now = QpcNow();
+        if (now < t->next_qpc) {
+            LARGE_INTEGER due;
+            due.QuadPart = -((t->next_qpc - now) * 10000000 / qpc_freq); // relative, in 100 ns units
+            ULONG tolerance = t->tolerance_ms < t->period_ms / 2 ? t->tolerance_ms : t->period_ms / 2;
+            if (due.QuadPart < 0) {
+                BOOL set;
+                if (tolerance > 0) {
+                    set = SetWaitableTimerEx(t->timer, &due, 0, NULL, NULL, NULL, tolerance);
+                    t->tolerant_waits++;
+                } else
+                    set = SetWaitableTimer(t->timer, &due, 0, NULL, NULL, FALSE);
+                if (set) WaitForSingleObject(t->timer, INFINITE);
+            }
+            now = QpcNow();
+        } else if (t->period_qpc > 0) {
+            // late by more than a whole period: skip the deadlines that already passed instead of bursting
+            LONGLONG behind = (now - t->next_qpc) / t->period_qpc;
+            t->missed += (ULONGLONG)behind;
+            t->next_qpc += behind * t->period_qpc;
+        }
+        t->next_qpc += t->period_qpc;
+    }
+
+    HistAdd(&t->period_us, (uint64_t)QpcToMicroseconds(now - t->last_qpc));
+    t->last_qpc = now;
+    return now;
+}
+
+
+void SampleTimerReport(const SampleTimer *t) {
+    printf("Sample timer: %s%s, requested period=[%u] ms, missed deadlines=[%llu], rate changes=[%llu], coalescable waits=[%llu]\n",
+           t->kind == TIMER_SLEEP ? "Sleep()" : "waitable timer",
+           t->kind == TIMER_WAITABLE && t->high_resolution ? " (high resolution)" : "",
+           t->period_ms, t->missed, t->rate_changes, t->tolerant_waits);
+    HistPrint(&t->period_us, "Sample period", "us");
+}
+
+
+void SampleTimerStop(SampleTimer *t) {
+    if (t->timer) {
+        CancelWaitableTimer(t->timer);
+        CloseHandle(t->timer);
+        t->timer = NULL;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   timer.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * Sampling scheduler.  Sleep() and GetTickCount() follow the ~15.6 ms system tick, so a --sleep below
+ * 16 ms didn't mean much.  TIMER_WAITABLE uses a CREATE_WAITABLE_TIMER_HIGH_RESOLUTION timer and
+ * deadlines measured with QueryPerformanceCounter: every deadline is start + n*period, so the period
+ * doesn't drift with the time spent in the loop.  The actual period of every sample goes to a histogram.
+ *
+ * With a tolerance (--games while a game is in the foreground) the wait is SetWaitableTimerEx() with a
+ * TolerableDelay, Windows may wake the sampler up to that late to batch it with other timers that expire
+ * around the same time.  The deadlines stay start + n*period, a late wakeup doesn't move the next one.
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "windows.h"
+#include "hist.h"
+
+typedef enum {
+    TIMER_WAITABLE = 0,
+    TIMER_SLEEP        // the original Sleep(sleep_Time), kept to compare
+} TimerKind;
+
+typedef struct {
+    TimerKind kind;
+    HANDLE timer;
+    int high_resolution;     // CREATE_WAITABLE_TIMER_HIGH_RESOLUTION was accepted (Windows 10 1803+)
+    UINT period_ms;
+    UINT tolerance_ms;       // 0: exact deadlines.  Used up to period_ms / 2
+    LONGLONG period_qpc;
+    LONGLONG next_qpc;       // next deadline
+    LONGLONG last_qpc;       // when the previous wait returned
+    ULONGLONG missed;        // deadlines skipped because the loop was late by more than one period
+    ULONGLONG rate_changes;  // SampleTimerSetPeriod() calls that changed the period
+    ULONGLONG tolerant_waits; // waits that allowed Windows to coalesce the wakeup
+    Histogram period_us;     // actual period between wakeups
+} SampleTimer;
+
+LONGLONG QpcNow(void);
+LONGLONG QpcToMicroseconds(LONGLONG ticks);
+LONGLONG QpcToNanoseconds(LONGLONG ticks);
+
+/* Wall clock in microseconds since 1970 (GetSystemTimePreciseAsFileTime), and as local time
+ * "2026-10-14 21:03:05.123456" */
+int64_t UnixMicrosecondsNow(void);
+void FormatUnixMicroseconds(int64_t unix_us, char *out, size_t size);
+
+int  SampleTimerStart(SampleTimer *t, TimerKind kind, UINT period_ms);
+
+/* The next deadline becomes the last wakeup + period_ms, so going faster takes effect at once */
+void SampleTimerSetPeriod(SampleTimer *t, UINT period_ms);
+
+/* Waitable timer only, the next waits may wake up to tolerance_ms late */
+void SampleTimerSetTolerance(SampleTimer *t, UINT tolerance_ms);
+
+/* Waits for the next deadline.  Returns the QueryPerformanceCounter value when it woke up */
+LONGLONG SampleTimerWait(SampleTimer *t);
+
+void SampleTimerReport(const SampleTimer *t);
+void SampleTimerStop(SampleTimer *t);
+
+#endif /* TIMER_H */
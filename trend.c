@@ -0,0 +1,420 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   trend.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "windows.h"
+
+#include "trend.h"
+#include "timer.h"
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t slots;
+    uint32_t first_day;
+    uint32_t days;
+    int64_t created_unix_us;
+    int64_t updated_unix_us;
+    uint8_t reserved[24];
+} TrendHeader;
+
+typedef struct {
+    uint32_t used;
+    uint32_t joy_ID;
+    uint8_t axis;
+    uint8_t reserved1;
+    uint16_t reserved2;
+    char name[WATCH_NAME_SIZE];
+} TrendSlot;
+
+typedef struct {
+    uint16_t alerts;
+    uint16_t runs;
+    uint16_t longest_run;
+    uint16_t stuck_s;
+    uint16_t rest_min;
+    uint16_t active_min;
+    uint16_t peak_bin;
+    uint16_t bins_hit;
+} TrendWatchDay;
+
+typedef struct {
+    uint16_t sessions;
+    uint16_t reserved;
+    TrendWatchDay w[TREND_SLOTS];
+} TrendDay;
+
+/* Today so far, in full precision */
+typedef struct {
+    uint32_t alerts, runs, longest_run;
+    int64_t stuck_us, rest_us, active_us;
+    uint8_t shift;
+    uint32_t bins[WATCH_ZONE_BINS];      // stuck samples by position, for the peak
+} TrendAccum;
+
+extern int verbose_flag; /* main.c */
+
+static HANDLE file = INVALID_HANDLE_VALUE;
+static TrendHeader header;
+static TrendSlot slots[TREND_SLOTS];
+static int slot_of[MAX_WATCHES];          // -1: not stored
+static TrendDay base;                     // the record of today as it was found, earlier sessions
+static TrendAccum acc[TREND_SLOTS];
+static uint32_t today;
+static int64_t last_t[FPM_MAX_DEVICES];
+
+
+static uint32_t DayFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (uint32_t)(era * 146097 + (int)doe - 719468);
+}
+
+
+static void CivilFromDay(uint32_t day, char *out, size_t size) {
+    int z = (int)day + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    snprintf(out, size, "%04d-%02u-%02u", (int)yoe + era * 400 + (m <= 2), m, d);
+}
+
+
+static uint32_t LocalDay(void) {
+    time_t now = time(NULL);
+    struct tm *lt = localtime(&now);
+    return lt ? DayFromCivil(lt->tm_year + 1900, lt->tm_mon + 1, lt->tm_mday) : (uint32_t)(now / 86400);
+}
+
+
+static uint16_t Saturate(uint64_t v) {
+    return v > 65535 ? 65535 : (uint16_t)v;
+}
+
+
+static int Seek(LONGLONG offset) {
+    LARGE_INTEGER at;
+    at.QuadPart = offset;
+    return SetFilePointerEx(file, at, NULL, FILE_BEGIN) ? 0 : -1;
+}
+
+
+static int Write(LONGLONG offset, const void *data, DWORD size) {
+    DWORD written = 0;
+    return Seek(offset) == 0 && WriteFile(file, data, size, &written, NULL) && written == size ? 0 : -1;
+}
+
+
+static int Read(LONGLONG offset, void *data, DWORD size) {
+    DWORD got = 0;
+    return Seek(offset) == 0 && ReadFile(file, data, size, &got, NULL) && got == size ? 0 : -1;
+}
+
+
+static LONGLONG DayOffset(uint32_t day) {
+    return TREND_HEADER + (LONGLONG)(day - header.first_day) * TREND_RECORD;
+}
+
+
+/* The record of day as the earlier sessions left it, zeros if it isn't written yet */
+static void StartDay(uint32_t day) {
+    today = day;
+    memset(&base, 0, sizeof(base));
+    if (day - header.first_day < header.days) Read(DayOffset(day), &base, sizeof(base));
+    if (base.sessions < 65535) base.sessions++;
+    for (int k = 0; k < TREND_SLOTS; k++) {
+        uint8_t shift = acc[k].shift;
+        memset(&acc[k], 0, sizeof(acc[k]));
+        acc[k].shift = shift;
+    }
+}
+
+
+static int FindSlot(const WatchTable *wt, int w) {
+    int free_Slot = -1;
+    for (int k = 0; k < TREND_SLOTS; k++) {
+        if (!slots[k].used) {
+            if (free_Slot < 0) free_Slot = k;
+            continue;
+        }
+        if (slots[k].joy_ID == wt->joy_ID[wt->device[w]] && slots[k].axis == wt->axis[w]
+            && strncmp(slots[k].name, wt->specs[w].name, WATCH_NAME_SIZE) == 0) return k;
+    }
+    if (free_Slot < 0) return -1;
+
+    TrendSlot *sl = &slots[free_Slot];
+    memset(sl, 0, sizeof(*sl));
+    sl->used = 1;
+    sl->joy_ID = wt->joy_ID[wt->device[w]];
+    sl->axis = wt->axis[w];
+    strncpy(sl->name, wt->specs[w].name, WATCH_NAME_SIZE - 1);
+    return free_Slot;
+}
+
+
+int TrendOpen(const char *path, const WatchTable *wt) {
+    // the report can read the file while the monitor writes it
+    file = CreateFile(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        printf("Could not open the trend store '%s', error=[%lu]\n", path, GetLastError());
+        return -1;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) goto BAD;
+
+    if (size.QuadPart == 0) {
+        memset(&header, 0, sizeof(header));
+        memset(slots, 0, sizeof(slots));
+        memcpy(header.magic, "FPT1", 4);
+        header.version = TREND_VERSION;
+        header.record_size = TREND_RECORD;
+        header.slots = TREND_SLOTS;
+        header.first_day = LocalDay();
+        header.created_unix_us = UnixMicrosecondsNow();
+    } else if (size.QuadPart < TREND_HEADER || Read(0, &header, sizeof(header)) != 0 || Read(64, slots, sizeof(slots)) != 0
+               || memcmp(header.magic, "FPT1", 4) != 0 || header.version != TREND_VERSION
+               || header.record_size != TREND_RECORD || header.slots != TREND_SLOTS) {
+        printf("'%s' is not a trend store of this version\n", path);
+        goto BAD;
+    }
+    // a crash between the record and the header: the header is right, what follows it is rewritten
+    if ((size.QuadPart - TREND_HEADER) / TREND_RECORD < header.days) header.days = (uint32_t)((size.QuadPart - TREND_HEADER) / TREND_RECORD);
+
+    for (int w = 0; w < wt->count; w++) {
+        slot_of[w] = FindSlot(wt, w);
+        if (slot_of[w] < 0) {
+            if (verbose_flag) printf("Trend store: no slot for watch %s\n", wt->specs[w].name);
+            continue;
+        }
+        uint32_t rest = wt->rest[w];
+        int bits = 0;
+        while (bits < 32 && (rest >> bits)) bits++;
+        acc[slot_of[w]].shift = (uint8_t)(bits > 10 ? bits - 10 : 0); // the heatmap bins
+    }
+    if (Write(64, slots, sizeof(slots)) != 0 || Write(0, &header, sizeof(header)) != 0) goto BAD;
+
+    for (int d = 0; d < FPM_MAX_DEVICES; d++) last_t[d] = -1;
+    uint32_t day = LocalDay();
+    if (day < header.first_day) {
+        puts("Trend store: the clock is before the first day of the store, not writing it");
+        goto BAD;
+    }
+    StartDay(day);
+    if (verbose_flag) printf("Trend store=[%s] days=[%u]\n", path, header.days);
+    return 0;
+
+BAD:
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+    return -1;
+}
+
+
+void TrendSample(const WatchTable *wt, const FpmSample *s, const uint16_t *run_before, uint32_t alerts) {
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    int64_t dt = last_t[s->device] >= 0 ? s->t_us - last_t[s->device] : 0;
+    last_t[s->device] = s->t_us;
+    if (s->status != 0) return; // JOYERR_NOERROR
+
+    int w_End = wt->first[s->device] + wt->n[s->device];
+    for (int w = wt->first[s->device]; w < w_End; w++) {
+        if (slot_of[w] < 0) continue;
+        TrendAccum *a = &acc[slot_of[w]];
+        uint32_t v = s->axes[wt->axis[w]];
+        a->active_us += dt;
+        if (v >= wt->rest[w]) a->rest_us += dt;
+        if (wt->run[w]) {
+            uint32_t b = v >> a->shift;
+            a->bins[b < WATCH_ZONE_BINS ? b : WATCH_ZONE_BINS - 1]++;
+            a->stuck_us += dt;
+        }
+        // a run ends when it resets or alerts, a single close pair is not a run
+        int alert = (alerts >> w) & 1;
+        if ((wt->run[w] == 0 || alert) && run_before[w] + alert >= WATCH_MIN_RUN) {
+            a->runs++;
+            if ((uint32_t)run_before[w] + alert > a->longest_run) a->longest_run = run_before[w] + alert;
+        }
+        a->alerts += alert;
+    }
+}
+
+
+/* base + acc into the record of today */
+static void Merge(TrendDay *day) {
+    *day = base;
+    for (int k = 0; k < TREND_SLOTS; k++) {
+        const TrendAccum *a = &acc[k];
+        TrendWatchDay *d = &day->w[k];
+        d->alerts = Saturate((uint64_t)d->alerts + a->alerts);
+        d->runs = Saturate((uint64_t)d->runs + a->runs);
+        if (a->longest_run > d->longest_run) d->longest_run = Saturate(a->longest_run);
+        d->stuck_s = Saturate(d->stuck_s + (uint64_t)(a->stuck_us / 1000000));
+        d->rest_min = Saturate(d->rest_min + (uint64_t)(a->rest_us / 60000000));
+        d->active_min = Saturate(d->active_min + (uint64_t)(a->active_us / 60000000));
+
+        // the peak of this session, if it saw more stuck samples than the earlier ones together
+        uint32_t peak = 0, hit = 0;
+        uint64_t total = 0;
+        for (int b = 0; b < WATCH_ZONE_BINS; b++) {
+            total += a->bins[b];
+            if (a->bins[b]) hit++;
+            if (a->bins[b] > a->bins[peak]) peak = b;
+        }
+        if (total && (uint64_t)a->stuck_us / 1000000 >= base.w[k].stuck_s) d->peak_bin = (uint16_t)(peak << a->shift);
+        if (hit > d->bins_hit) d->bins_hit = (uint16_t)hit;
+    }
+}
+
+
+void TrendCheckpoint(void) {
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    TrendDay record;
+    Merge(&record);
+    uint32_t index = today - header.first_day;
+    if (index > header.days) { // days nobody monitored, zeros
+        static const TrendDay empty;
+        for (uint32_t i = header.days; i < index; i++) Write(DayOffset(header.first_day + i), &empty, sizeof(empty));
+    }
+    if (Write(DayOffset(today), &record, sizeof(record)) != 0) return;
+    if (index >= header.days) header.days = index + 1;
+    header.updated_unix_us = UnixMicrosecondsNow();
+    Write(0, &header, sizeof(header));
+
+    uint32_t day = LocalDay(); // after midnight the minute before it still counted for yesterday
+    if (day > today) StartDay(day);
+}
+
+
+void TrendClose(void) {
+    if (file == INVALID_HANDLE_VALUE) return;
+    TrendCheckpoint();
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+}
+
+
+/* Per monitored hour, over a range of days */
+typedef struct {
+    uint64_t alerts, runs, stuck_s, rest_min, active_min;
+} TrendSum;
+
+
+static void Add(TrendSum *sum, const TrendWatchDay *d) {
+    sum->alerts += d->alerts;
+    sum->runs += d->runs;
+    sum->stuck_s += d->stuck_s;
+    sum->rest_min += d->rest_min;
+    sum->active_min += d->active_min;
+}
+
+
+static double PerHour(uint64_t n, uint64_t minutes) {
+    return minutes ? n * 60.0 / minutes : 0;
+}
+
+
+int TrendReport(const char *path) {
+    HANDLE f = CreateFile(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE) {
+        printf("Could not open the trend store '%s', error=[%lu]\n", path, GetLastError());
+        return EXIT_FAILURE;
+    }
+    LARGE_INTEGER size;
+    HANDLE m = NULL;
+    const unsigned char *view = NULL;
+    if (!GetFileSizeEx(f, &size) || size.QuadPart < TREND_HEADER
+        || (m = CreateFileMapping(f, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL
+        || (view = (const unsigned char *)MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0)) == NULL) {
+        printf("Could not map the trend store '%s'\n", path);
+        if (m) CloseHandle(m);
+        CloseHandle(f);
+        return EXIT_FAILURE;
+    }
+    const TrendHeader *h = (const TrendHeader *)view;
+    const TrendSlot *sl = (const TrendSlot *)(view + 64);
+    if (memcmp(h->magic, "FPT1", 4) != 0 || h->version != TREND_VERSION || h->record_size != TREND_RECORD || h->slots != TREND_SLOTS) {
+        printf("'%s' is not a trend store of this version\n", path);
+        UnmapViewOfFile(view);
+        CloseHandle(m);
+        CloseHandle(f);
+        return EXIT_FAILURE;
+    }
+    // the monitor may have grown the file after the header we see, or be in the middle of it
+    uint32_t days = h->days;
+    if ((uint64_t)(size.QuadPart - TREND_HEADER) / TREND_RECORD < days) days = (uint32_t)((size.QuadPart - TREND_HEADER) / TREND_RECORD);
+
+    char first[16], last[16], when[16];
+    CivilFromDay(h->first_day, first, sizeof(first));
+    CivilFromDay(h->first_day + (days ? days - 1 : 0), last, sizeof(last));
+    printf("Trend store=[%s] days=[%u] from=[%s] to=[%s] size=[%lld]\n", path, days, first, last, (long long)size.QuadPart);
+
+    for (int k = 0; k < TREND_SLOTS; k++) {
+        if (!sl[k].used) continue;
+        printf("\n%s (joystick %u axis %c)\n", sl[k].name, sl[k].joy_ID, "XYZRUV"[sl[k].axis % FPM_AXES]);
+        puts("    day          monitored  alerts  alerts/h  runs/h  longest  stuck s  at rest  peak");
+
+        // one pass, O(1) per day: the last 30 days one by one, rates by 30 day period for the slope
+        TrendSum all = { 0 }, first_Period = { 0 }, last_Period = { 0 };
+        double sx = 0, sy = 0, sxx = 0, sxy = 0, sw = 0;
+        TrendSum period = { 0 };
+        uint32_t period_Start = 0;
+        for (uint32_t i = 0; i < days; i++) {
+            const TrendDay *d = (const TrendDay *)(view + TREND_HEADER + (size_t)i * TREND_RECORD);
+            const TrendWatchDay *w = &d->w[k];
+            if (w->active_min) {
+                Add(&all, w);
+                Add(&period, w);
+                if (i < 30) Add(&first_Period, w);
+                if (i + 30 >= days) Add(&last_Period, w);
+            }
+            if (w->active_min && i + TREND_REPORT_DAYS >= days) {
+                CivilFromDay(h->first_day + i, when, sizeof(when));
+                printf("    %s  %5u min  %6u  %8.2f  %6.2f  %7u  %7u  %6.0f%%  %4u\n", when, w->active_min, w->alerts,
+                       PerHour(w->alerts, w->active_min), PerHour(w->runs, w->active_min), w->longest_run, w->stuck_s,
+                       w->active_min ? 100.0 * w->rest_min / w->active_min : 0, w->peak_bin);
+            }
+            // least squares of runs/h over 30 day periods, weighted by the hours monitored
+            if (i - period_Start == 29 || i + 1 == days) {
+                if (period.active_min) {
+                    double x = (period_Start + i) / 2.0 / 30.0, y = PerHour(period.runs, period.active_min), weight = period.active_min / 60.0;
+                    sw += weight; sx += weight * x; sy += weight * y; sxx += weight * x * x; sxy += weight * x * y;
+                }
+                memset(&period, 0, sizeof(period));
+                period_Start = i + 1;
+            }
+        }
+        double slope = sw > 0 && sw * sxx - sx * sx > 1e-9 ? (sw * sxy - sx * sy) / (sw * sxx - sx * sx) : 0;
+        printf("    all days: monitored=[%.1f h] alerts=[%llu] alerts/h=[%.2f] runs/h=[%.2f] stuck=[%.1f min] at rest=[%.0f%%]\n",
+               all.active_min / 60.0, (unsigned long long)all.alerts, PerHour(all.alerts, all.active_min),
+               PerHour(all.runs, all.active_min), all.stuck_s / 60.0, all.active_min ? 100.0 * all.rest_min / all.active_min : 0);
+        printf("    first 30 days: alerts/h=[%.2f] runs/h=[%.2f]  last 30 days: alerts/h=[%.2f] runs/h=[%.2f]  trend=[%+.2f runs/h per 30 days]\n",
+               PerHour(first_Period.alerts, first_Period.active_min), PerHour(first_Period.runs, first_Period.active_min),
+               PerHour(last_Period.alerts, last_Period.active_min), PerHour(last_Period.runs, last_Period.active_min), slope);
+    }
+
+    UnmapViewOfFile(view);
+    CloseHandle(m);
+    CloseHandle(f);
+    return EXIT_SUCCESS;
+}
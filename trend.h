@@ -0,0 +1,57 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   trend.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * How fast the sensor gets worse, over months (--trend_store file.fpt while monitoring, --trend file.fpt
+ * to print it).  Every local day is one fixed size record in an append-only file, with TREND_SLOTS watches:
+ * the alerts, the stuck runs, the longest run, the seconds spent in stuck runs, the minutes at rest and
+ * the minutes monitored, and a summary of that day's noise heatmap (the position with most stuck samples
+ * and how many positions had any).  68 bytes a day, 25 KB a year.
+ *
+ * The live loop only adds to counters in memory; TrendCheckpoint() (once a minute, with the heatmap one)
+ * rewrites the record of today, or appends it, and the days nobody monitored as zeros in between.  Old
+ * records are never read or rewritten.  A second session in the same day adds to the record it finds.
+ * The report maps the file and reads day i at offset TREND_HEADER + i * TREND_RECORD, and the monitor can
+ * keep writing while it runs.
+ *
+ * File, little endian: "FPT1", u32 version, u32 record size, u32 slots, u32 first day, u32 days,
+ * i64 created and i64 updated (us since 1970), 24 bytes 0; TREND_SLOTS * { u32 used, u32 joy_ID, u8 axis,
+ * u8 0, u16 0, char name[24] }; then days * { u16 sessions, u16 0, TREND_SLOTS * { u16 alerts, u16 runs,
+ * u16 longest run, u16 stuck seconds, u16 minutes at rest, u16 minutes monitored, u16 peak bin,
+ * u16 bins hit } }.  Days are local days since 1970-01-01, the counters saturate.
+ */
+
+#ifndef TREND_H
+#define TREND_H
+
+#include <stdint.h>
+#include "sample.h"
+#include "watch.h"
+
+#define TREND_VERSION 1
+#define TREND_SLOTS 4
+#define TREND_HEADER (64 + TREND_SLOTS * 36)
+#define TREND_RECORD (4 + TREND_SLOTS * 16)
+#define TREND_REPORT_DAYS 30     // days printed one by one, older ones only go into the rates
+
+/* Opens or creates the store and finds the slot of every watch, like the heatmap.  Returns 0 on success */
+int  TrendOpen(const char *path, const WatchTable *wt);
+
+/* After DetectorFeed() and StatsRuns(), with the same run_before and alerts */
+void TrendSample(const WatchTable *wt, const FpmSample *s, const uint16_t *run_before, uint32_t alerts);
+
+/* Writes the record of today */
+void TrendCheckpoint(void);
+
+void TrendClose(void);
+
+/* --trend: prints the store and exits.  Returns the exit code */
+int  TrendReport(const char *path);
+
+#endif /* TREND_H */
@@ -0,0 +1,221 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   vjoy.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "vjoy.h"
+#include "timer.h"
+#include "hist.h"
+
+#define VJOY_DLL "vJoyInterface.dll"
+#define VJD_STAT_OWN 0
+#define VJD_STAT_FREE 1
+#define VJOY_DEFAULT_MAX 0x7FFF
+
+/* vJoyInterface.h, all __cdecl */
+typedef BOOL (__cdecl *vJoyEnabledFn)(void);
+typedef int  (__cdecl *GetVJDStatusFn)(UINT rID);
+typedef BOOL (__cdecl *AcquireVJDFn)(UINT rID);
+typedef VOID (__cdecl *RelinquishVJDFn)(UINT rID);
+typedef BOOL (__cdecl *GetVJDAxisExistFn)(UINT rID, UINT Axis);
+typedef BOOL (__cdecl *GetVJDAxisMaxFn)(UINT rID, UINT Axis, LONG *Max);
+typedef BOOL (__cdecl *SetAxisFn)(LONG Value, UINT rID, UINT Axis);
+
+static HMODULE dll = NULL;
+static RelinquishVJDFn RelinquishVJD;
+static SetAxisFn SetAxis;
+
+/* HID usages of X Y Z R U V: the rudder goes to Rz like on most wheels and pedals */
+static const UINT usage_of[FPM_AXES] = { 0x30, 0x31, 0x32, 0x35, 0x33, 0x34 };
+
+typedef struct {
+    // euro
+    double x, dx;
+    int64_t last_t;
+    int primed;
+    // median
+    uint32_t window[VJOY_MEDIAN];
+    int filled, next;
+    // output
+    LONG out;
+    LONG max;
+    int written;
+    int failed;
+} FilterState;
+
+static UINT vjoy = 0;
+static FilterKind kind = FILTER_EURO;
+static const WatchTable *watches = NULL;
+static FilterState state[MAX_WATCHES];
+static Histogram set_cost;           // SetAxis() of one sample, in ns
+static ULONGLONG set_errors = 0;
+
+
+const char *FilterKindName(FilterKind k) {
+    switch (k) {
+        case FILTER_NONE: return "none";
+        case FILTER_MEDIAN: return "median";
+        case FILTER_EURO: return "euro";
+    }
+    return "?";
+}
+
+
+int FilterKindFromName(const char *name) {
+    for (int k = FILTER_NONE; k <= FILTER_EURO; k++)
+        if (strcmp(name, FilterKindName((FilterKind)k)) == 0) return k;
+    return -1;
+}
+
+
+int VJoyOpen(UINT vjoy_ID, FilterKind filter, const WatchTable *wt) {
+    dll = LoadLibrary(VJOY_DLL);
+    if (dll == NULL) {
+        printf("Could not load %s, is vJoy installed?  error=[%lu]\n", VJOY_DLL, GetLastError());
+        return -1;
+    }
+    vJoyEnabledFn vJoyEnabled = (vJoyEnabledFn)GetProcAddress(dll, "vJoyEnabled");
+    GetVJDStatusFn GetVJDStatus = (GetVJDStatusFn)GetProcAddress(dll, "GetVJDStatus");
+    AcquireVJDFn AcquireVJD = (AcquireVJDFn)GetProcAddress(dll, "AcquireVJD");
+    GetVJDAxisExistFn GetVJDAxisExist = (GetVJDAxisExistFn)GetProcAddress(dll, "GetVJDAxisExist");
+    GetVJDAxisMaxFn GetVJDAxisMax = (GetVJDAxisMaxFn)GetProcAddress(dll, "GetVJDAxisMax"); // not in old versions
+    RelinquishVJD = (RelinquishVJDFn)GetProcAddress(dll, "RelinquishVJD");
+    SetAxis = (SetAxisFn)GetProcAddress(dll, "SetAxis");
+
+    const char *why = NULL;
+    if (!vJoyEnabled || !GetVJDStatus || !AcquireVJD || !GetVJDAxisExist || !RelinquishVJD || !SetAxis) why = "is not a vJoy library";
+    else if (!vJoyEnabled()) why = "vJoy is not enabled";
+    else {
+        int status = GetVJDStatus(vjoy_ID);
+        if (status != VJD_STAT_OWN && status != VJD_STAT_FREE) why = "the vJoy device is missing or used by another feeder";
+        else if (status == VJD_STAT_FREE && !AcquireVJD(vjoy_ID)) why = "could not acquire the vJoy device";
+    }
+    if (why) {
+        printf("No --vjoy output: %s (device %u)\n", why, vjoy_ID);
+        FreeLibrary(dll);
+        dll = NULL;
+        return -1;
+    }
+
+    vjoy = vjoy_ID;
+    kind = filter;
+    watches = wt;
+    memset(state, 0, sizeof(state));
+    for (int w = 0; w < wt->count; w++) {
+        UINT usage = usage_of[wt->axis[w]];
+        FilterState *f = &state[w];
+        f->max = VJOY_DEFAULT_MAX;
+        if (GetVJDAxisMax) GetVJDAxisMax(vjoy_ID, usage, &f->max);
+        if (!GetVJDAxisExist(vjoy_ID, usage)) {
+            printf("vJoy device %u has no axis %c, %s is not written\n", vjoy_ID, "XYZRUV"[wt->axis[w]], wt->specs[w].name);
+            f->failed = 1;
+        }
+    }
+    HistReset(&set_cost);
+    return 0;
+}
+
+
+static uint32_t Median(FilterState *f, uint32_t x) {
+    uint32_t sorted[VJOY_MEDIAN];
+    f->window[f->next] = x;
+    f->next = (f->next + 1) % VJOY_MEDIAN;
+    if (f->filled < VJOY_MEDIAN) f->filled++;
+
+    // insertion sort of at most 5 values
+    for (int i = 0; i < f->filled; i++) {
+        uint32_t v = f->window[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > v) { sorted[j] = sorted[j - 1]; j--; }
+        sorted[j] = v;
+    }
+    return sorted[f->filled / 2];
+}
+
+
+static double Alpha(double cutoff, double dt) {
+    double tau = 1.0 / (6.283185307179586 * cutoff);
+    return 1.0 / (1.0 + tau / dt);
+}
+
+
+/* x in travel units, 0..1 */
+static double Euro(FilterState *f, double x, int64_t t_us) {
+    if (!f->primed || t_us <= f->last_t) {
+        f->primed = 1;
+        f->x = x;
+        f->dx = 0;
+        f->last_t = t_us;
+        return x;
+    }
+    double dt = (t_us - f->last_t) / 1e6;
+    f->last_t = t_us;
+
+    double a_d = Alpha(VJOY_EURO_D_CUTOFF, dt);
+    f->dx += a_d * ((x - f->x) / dt - f->dx);
+    double a = Alpha(VJOY_EURO_MIN_CUTOFF + VJOY_EURO_BETA * fabs(f->dx), dt);
+    f->x += a * (x - f->x);
+    return f->x;
+}
+
+
+void VJoyUpdate(const FpmSample *s) {
+    if (dll == NULL || s->status != 0) return;
+
+    const WatchTable *wt = watches;
+    LONGLONG t0 = QpcNow();
+    int w_End = wt->first[s->device] + wt->n[s->device];
+    for (int w = wt->first[s->device]; w < w_End; w++) {
+        FilterState *f = &state[w];
+        if (f->failed) continue;
+
+        WatchRule rule; // the main thread may be changing the range or the hot zones
+        WatchRuleRead(wt, w, &rule);
+        uint32_t raw = s->axes[wt->axis[w]];
+        uint32_t lo = rule.axis_min, hi = rule.rest;
+        uint32_t x = raw < lo ? lo : raw > hi ? hi : raw;
+        double range = hi > lo ? (double)(hi - lo) : 1.0;
+
+        if (kind == FILTER_MEDIAN) x = Median(f, x);
+        else if (kind == FILTER_EURO) x = lo + (uint32_t)(Euro(f, (x - lo) / range, s->t_us) * range + 0.5);
+
+        LONG out = (LONG)((x - lo) / range * f->max + 0.5);
+        if (rule.zoned) { // inside a hot zone small changes are the noise, keep the last value
+            uint32_t bin = raw >> rule.zone_shift;
+            if (bin >= WATCH_ZONE_BINS) bin = WATCH_ZONE_BINS - 1;
+            LONG band = (LONG)((double)rule.margin / range * f->max);
+            LONG diff = out - f->out;
+            if ((rule.hot[bin >> 5] & (1u << (bin & 31))) && diff <= band && diff >= -band) out = f->out;
+        }
+        if (out == f->out && f->written) continue; // vJoy keeps the last value
+        f->out = out;
+        f->written = 1;
+        if (!SetAxis(out, vjoy, usage_of[wt->axis[w]])) set_errors++;
+    }
+    HistAdd(&set_cost, (uint64_t)QpcToNanoseconds(QpcNow() - t0));
+}
+
+
+void VJoyReport(void) {
+    if (dll == NULL) return;
+    printf("vJoy device=[%u] filter=[%s] SetAxis errors=[%llu]\n", vjoy, FilterKindName(kind), set_errors);
+    HistPrint(&set_cost, "vJoy update", "ns");
+}
+
+
+void VJoyClose(void) {
+    if (dll == NULL) return;
+    RelinquishVJD(vjoy);
+    FreeLibrary(dll);
+    dll = NULL;
+}
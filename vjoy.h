@@ -0,0 +1,60 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   vjoy.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * --vjoy id writes every watched axis, de-noised, to the same axis of vJoy device id (R goes to Rz), so
+ * the sim or Joystick Gremlin can use the clean value instead of the pedal.  It runs on the sampler
+ * thread right after joyGetPosEx(), before the sample goes into the ring: one SetAxis() per watch, a
+ * few microseconds, VJoyReport() prints what it really costs.
+ *
+ * --vjoy_filter:
+ *      euro    one euro filter (Casiez, Roussel, Vogel 2012): strong smoothing while the pedal is still,
+ *              almost none while it moves fast.  Default
+ *      median  median of the last VJOY_MEDIAN samples, removes single sample spikes, VJOY_MEDIAN/2 samples late
+ *      none    the raw value
+ * With --heatmap_margin the output also holds still inside the hot zones while the value stays within
+ * the margin of the watch, the noise of a worn area never reaches the sim.  The range and the zones come
+ * from WatchRuleRead(), the main thread changes them while this runs.
+ *
+ * vJoyInterface.dll is loaded at run time, the monitor works the same without vJoy installed.
+ */
+
+#ifndef VJOY_H
+#define VJOY_H
+
+#include "windows.h"
+#include "sample.h"
+#include "watch.h"
+
+#define VJOY_MEDIAN 5
+#define VJOY_EURO_MIN_CUTOFF 1.0   // Hz, at rest
+#define VJOY_EURO_BETA 20.0        // cutoff increase per travel/s of speed
+#define VJOY_EURO_D_CUTOFF 5.0     // Hz, for the speed itself
+
+typedef enum {
+    FILTER_NONE = 0,
+    FILTER_MEDIAN,
+    FILTER_EURO
+} FilterKind;
+
+const char *FilterKindName(FilterKind kind);
+int FilterKindFromName(const char *name);   // -1 if unknown
+
+/* Loads vJoy and acquires device vjoy_ID for the watches of wt.  Returns 0 on success, prints why not */
+int  VJoyOpen(UINT vjoy_ID, FilterKind filter, const WatchTable *wt);
+
+/* Sampler thread, every sample.  Does nothing if VJoyOpen() failed */
+void VJoyUpdate(const FpmSample *s);
+
+/* SetAxis() cost and the axes that failed */
+void VJoyReport(void);
+
+void VJoyClose(void);
+
+#endif /* VJOY_H */
@@ -0,0 +1,307 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   watch.c
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "watch.h"
+#include "detector.h"
+
+
+int AxisFromLetter(char c) {
+    switch (c) {
+        case 'X': case 'x': return FPM_X;
+        case 'Y': case 'y': return FPM_Y;
+        case 'Z': case 'z': return FPM_Z;
+        case 'R': case 'r': return FPM_R;
+        case 'U': case 'u': return FPM_U;
+        case 'V': case 'v': return FPM_V;
+        case '-': return -1;
+    }
+    return -2;
+}
+
+
+void WatchInit(WatchTable *wt) {
+    memset(wt, 0, sizeof(*wt));
+}
+
+
+int WatchAdd(WatchTable *wt, const char *spec) {
+    char buf[128];
+    char *field[6] = { 0 };
+    int fields = 0;
+
+    if (wt->spec_count == MAX_WATCHES) {
+        printf("Too many --watch, the maximum is %d\n", MAX_WATCHES);
+        return -1;
+    }
+    strncpy(buf, spec, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    for (char *p = buf; fields < 6; ) {
+        field[fields++] = p;
+        char *colon = strchr(p, ':');
+        if (colon == NULL) break;
+        *colon = '\0';
+        p = colon + 1;
+    }
+
+    WatchSpec *w = &wt->specs[wt->spec_count];
+    w->gate_axis = -1;
+    w->margin_pct = -1;
+    w->repeat = -1;
+    w->repeat_ms = 0;
+
+    if (fields < 2 || field[0][0] == '\0') goto BAD;
+    w->joy_ID = atoi(field[0]);
+    if (w->joy_ID >= FPM_MAX_DEVICES) goto BAD;
+
+    if (strlen(field[1]) != 1 || (w->axis = AxisFromLetter(field[1][0])) < 0) goto BAD;
+
+    if (fields > 2 && field[2][0]) {
+        if (strlen(field[2]) != 1 || (w->gate_axis = AxisFromLetter(field[2][0])) == -2) goto BAD;
+    }
+    // the same ranges as the control pipe: margin_pct and repeat end up in a uint8_t and a uint16_t
+    char *end;
+    if (fields > 3 && field[3][0]) {
+        w->margin_pct = (int)strtol(field[3], &end, 10);
+        if (*end || w->margin_pct < 0 || w->margin_pct > 100) goto BAD;
+    }
+    if (fields > 4 && field[4][0]) {
+        long repeat = strtol(field[4], &end, 10);
+        if (strcmp(end, "ms") == 0) {
+            if (repeat < 1) goto BAD;
+            w->repeat_ms = (int)repeat;
+        } else if (*end || repeat < 1 || repeat > 65535) goto BAD;
+        else w->repeat = (int)repeat;
+    }
+
+    if (fields > 5 && field[5][0])
+        snprintf(w->name, sizeof(w->name), "%s", field[5]);
+    else
+        snprintf(w->name, sizeof(w->name), "Joystick %u %c", w->joy_ID, "XYZRUV"[w->axis]);
+
+    wt->spec_count++;
+    return 0;
+
+BAD:
+    printf("Wrong --watch '%s', use joystick:axis[:gate[:margin[:repeat[:name]]]], axis and gate are X Y Z R U V (gate - for none)\n", spec);
+    return -1;
+}
+
+
+void WatchFinish(WatchTable *wt, UINT default_joy_ID, UINT default_margin_pct) {
+    if (wt->spec_count == 0) {
+        WatchSpec *w = &wt->specs[wt->spec_count++];
+        w->joy_ID = default_joy_ID;
+        w->axis = FPM_R;     // left pedal (clutch)
+        w->gate_axis = FPM_Y; // right pedal not in use
+        w->margin_pct = -1;
+        w->repeat = -1;
+        w->repeat_ms = 0;
+        strcpy(w->name, "Rudder");
+    }
+    for (int s = 0; s < wt->spec_count; s++) {
+        WatchSpec *w = &wt->specs[s];
+        if (w->repeat > 0 || w->repeat_ms > 0) continue;
+        w->repeat_ms = wt->default_repeat_ms;
+        w->repeat = 4;
+    }
+
+    wt->device_count = 0;
+    for (int s = 0; s < wt->spec_count; s++) {
+        int d;
+        for (d = 0; d < wt->device_count; d++)
+            if (wt->joy_ID[d] == wt->specs[s].joy_ID) break;
+        if (d == wt->device_count) wt->joy_ID[wt->device_count++] = wt->specs[s].joy_ID;
+    }
+
+    // device by device, keeping the command line order inside a device
+    wt->count = 0;
+    for (int d = 0; d < wt->device_count; d++) {
+        wt->first[d] = (uint8_t)wt->count;
+        for (int s = 0; s < wt->spec_count; s++) {
+            const WatchSpec *w = &wt->specs[s];
+            if (w->joy_ID != wt->joy_ID[d]) continue;
+
+            int i = wt->count++;
+            int pct = w->margin_pct >= 0 ? w->margin_pct : (int)default_margin_pct;
+            wt->device[i] = (uint8_t)d;
+            wt->axis[i] = (uint8_t)w->axis;
+            wt->gate_axis[i] = (int8_t)w->gate_axis;
+            wt->gate_rest[i] = AXIS_REST;
+            wt->rest[i] = AXIS_REST;
+            wt->margin[i] = AXIS_REST * pct / 100; // re-expresar el margin de puntos porentuales a significancia sobre 1023
+            wt->margin_pct[i] = (uint8_t)pct;
+            wt->axis_min[i] = 0;
+            wt->repeat[i] = (uint16_t)(w->repeat_ms > 0 ? WATCH_MIN_RUN : w->repeat);
+            wt->repeat_us[i] = (uint32_t)w->repeat_ms * 1000;
+            wt->engine[i] = (uint8_t)wt->default_engine;
+            NoiseReset(&wt->noise[i]);
+            wt->last[i] = 0;
+            wt->run[i] = 0;
+            wt->since_us[i] = 0;
+        }
+        wt->n[d] = (uint8_t)(wt->count - wt->first[d]);
+    }
+
+    memset(wt->seen_max, 0, sizeof(wt->seen_max));
+    memset(wt->seen_min, 0xFF, sizeof(wt->seen_min));
+    memset(wt->seen_count, 0, sizeof(wt->seen_count));
+
+    // the specs follow the same order, so specs[i] describes watch i from here on
+    WatchSpec sorted[MAX_WATCHES];
+    int k = 0;
+    for (int d = 0; d < wt->device_count; d++)
+        for (int s = 0; s < wt->spec_count; s++)
+            if (wt->specs[s].joy_ID == wt->joy_ID[d]) sorted[k++] = wt->specs[s];
+    memcpy(wt->specs, sorted, sizeof(sorted[0]) * k);
+    WatchPublish(wt);
+}
+
+
+static void SetRange(WatchTable *wt, int w, uint32_t lo, uint32_t hi, uint32_t gate_hi) {
+    wt->axis_min[w] = lo;
+    wt->rest[w] = hi;
+    if (wt->gate_axis[w] >= 0) wt->gate_rest[w] = gate_hi;
+    wt->margin[w] = (int32_t)((uint64_t)(hi - lo) * wt->margin_pct[w] / 100);
+    wt->margin_cold[w] = (int32_t)((uint64_t)(hi - lo) * wt->cold_pct[w] / 100);
+}
+
+
+void WatchCalibrate(WatchTable *wt, int device, const uint32_t axis_min[FPM_AXES], const uint32_t axis_max[FPM_AXES]) {
+    int w_End = wt->first[device] + wt->n[device];
+    for (int w = wt->first[device]; w < w_End; w++) {
+        int a = wt->axis[w], g = wt->gate_axis[w];
+        if (axis_max[a] <= axis_min[a]) continue;
+        if (g >= 0 && axis_max[g] <= axis_min[g]) continue;
+        SetRange(wt, w, axis_min[a], axis_max[a], g >= 0 ? axis_max[g] : 0);
+    }
+    WatchPublish(wt);
+}
+
+
+int WatchObserve(WatchTable *wt, const FpmSample *s) {
+    int d = s->device, changed = 0;
+    if (s->status != 0) return 0; // JOYERR_NOERROR, the values of a failed read mean nothing
+
+    uint32_t *seen_max = wt->seen_max[d], *seen_min = wt->seen_min[d];
+    uint16_t *seen_count = wt->seen_count[d];
+    int w_End = wt->first[d] + wt->n[d];
+    for (int w = wt->first[d]; w < w_End; w++) {
+        // the watched axis and its gate, a gate reaches the top of its range the same way
+        for (int k = 0; k < 2; k++) {
+            int a = k == 0 ? wt->axis[w] : wt->gate_axis[w];
+            if (a < 0) continue;
+            uint32_t v = s->axes[a];
+            if (seen_count[a] == 0 || v > seen_max[a]) { seen_max[a] = v; seen_count[a] = 1; }
+            else if (v == seen_max[a] && seen_count[a] < WATCH_SEEN_STABLE) seen_count[a]++;
+            if (v < seen_min[a]) seen_min[a] = v;
+        }
+        int a = wt->axis[w], g = wt->gate_axis[w];
+        if (seen_count[a] < WATCH_SEEN_STABLE || (g >= 0 && seen_count[g] < WATCH_SEEN_STABLE)) continue;
+        uint32_t gate_hi = g >= 0 ? seen_max[g] : 0;
+        uint32_t lo = seen_min[a]; // the lowest value really seen, not only below the JOYCAPS minimum
+        if (seen_max[a] == wt->rest[w] && lo == wt->axis_min[w] && (g < 0 || gate_hi == wt->gate_rest[w])) continue;
+        if (seen_max[a] <= lo) continue;
+        SetRange(wt, w, lo, seen_max[a], gate_hi);
+        changed = 1;
+    }
+    if (changed) WatchPublish(wt);
+    return changed;
+}
+
+
+/* One writer, the main thread: the same seqlock as the telemetry block */
+void WatchPublish(WatchTable *wt) {
+    wt->rules_seq = wt->rules_seq + 1;
+    atomic_thread_fence(memory_order_release);
+    for (int w = 0; w < wt->count; w++) {
+        WatchRule *r = &wt->rules[w];
+        r->axis_min = wt->axis_min[w];
+        r->rest = wt->rest[w];
+        r->gate_rest = wt->gate_rest[w];
+        r->margin = wt->margin[w];
+        r->zoned = wt->zoned[w];
+        r->zone_shift = wt->zone_shift[w];
+        memcpy(r->hot, wt->hot[w], sizeof(r->hot));
+    }
+    atomic_thread_fence(memory_order_release);
+    wt->rules_seq = wt->rules_seq + 1;
+}
+
+
+void WatchRuleRead(const WatchTable *wt, int w, WatchRule *rule) {
+    uint32_t seq;
+    do {
+        seq = wt->rules_seq;
+        atomic_thread_fence(memory_order_acquire);
+        *rule = wt->rules[w];
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != wt->rules_seq);
+}
+
+
+int WatchFind(const WatchTable *wt, const char *name) {
+    for (int w = 0; w < wt->count; w++)
+        if (_stricmp(wt->specs[w].name, name) == 0) return w;
+    char *end;
+    long w = strtol(name, &end, 10);
+    return *name && *end == '\0' && w >= 0 && w < wt->count ? (int)w : -1;
+}
+
+
+static void Restart(WatchTable *wt, int w) {
+    wt->run[w] = 0;
+    wt->since_us[w] = 0;
+}
+
+
+void WatchSetMargin(WatchTable *wt, int w, int pct) {
+    wt->specs[w].margin_pct = pct;
+    wt->margin_pct[w] = (uint8_t)pct;
+    wt->margin[w] = (int32_t)((uint64_t)(wt->rest[w] - wt->axis_min[w]) * pct / 100);
+    Restart(wt, w);
+    WatchPublish(wt);
+}
+
+
+void WatchSetRepeat(WatchTable *wt, int w, int repeat, int in_ms) {
+    wt->specs[w].repeat = in_ms ? -1 : repeat;
+    wt->specs[w].repeat_ms = in_ms ? repeat : 0;
+    wt->repeat[w] = (uint16_t)(in_ms ? WATCH_MIN_RUN : repeat);
+    wt->repeat_us[w] = in_ms ? (uint32_t)repeat * 1000 : 0;
+    Restart(wt, w);
+}
+
+
+void WatchSetEngine(WatchTable *wt, int w, int engine) {
+    if (wt->engine[w] == engine) return;
+    wt->engine[w] = (uint8_t)engine;
+    NoiseReset(&wt->noise[w]);
+    Restart(wt, w);
+}
+
+
+void WatchPrint(const WatchTable *wt) {
+    for (int i = 0; i < wt->count; i++) {
+        char repeat[16];
+        if (wt->repeat_us[i]) snprintf(repeat, sizeof(repeat), "%u ms", wt->repeat_us[i] / 1000);
+        else snprintf(repeat, sizeof(repeat), "%u", wt->repeat[i]);
+        printf("Watch %d: joystick=[%u] axis=[%c] gate=[%c] margin=[%d] repeat=[%s] engine=[%s] name=[%s]\n",
+               i, wt->joy_ID[wt->device[i]], "XYZRUV"[wt->axis[i]],
+               wt->gate_axis[i] < 0 ? '-' : "XYZRUV"[(int)wt->gate_axis[i]],
+               (int)wt->margin[i], repeat, DetectorEngineName((DetectorEngine)wt->engine[i]), wt->specs[i].name);
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ * License: https://github.com/rolex20/FanatecClubSportPedalsMonitor/blob/main/LICENSE
+ */
+
+/*
+ * File:   watch.h
+ * Author: rolex20
+ *
+ * Created on October 14, 2026
+ *
+ * The axes being watched, for any number of devices in one process.
+ * --watch joystick:axis[:gate[:margin[:repeat[:name]]]] can be repeated, for example:
+ *      --watch 1:R:Y:1:4:Rudder --watch 2:X:-:2:6:Throttle --watch 1:Z:-:1:3000ms:Brake
+ * Without --watch the original rule is used: --joystick, axis R, gated by Y at rest, --margin, 4 repeats.
+ * A repeat ending in ms is a time: the axis must stay stuck that long, whatever the sample rate is.
+ *
+ * rest, gate_rest and the margin start with the 10-bit range of the original program (a released pedal
+ * reads 1023).  WatchCalibrate() replaces them with the range of the device (JOYCAPS, or the recording of
+ * --replay), and with --calibrate WatchObserve() follows the extremes really seen: the top of the range
+ * is where a released pedal sits.  The margin is margin_pct of max - min, computed again only when the
+ * range changes.
+ *
+ * The specs are kept as an array of structs for parsing and printing.  WatchFinish() sorts them by
+ * device and copies what the loop needs into arrays (struct of arrays), so the watches of one device are
+ * contiguous and one pass over a sample touches only a few cache lines.
+ *
+ * Only the main thread changes the rules (--calibrate, --heatmap, the control pipe).  The sampler thread
+ * (vJoy, --fast_sleep) reads them from rules[], a copy WatchPublish() writes under a seqlock after every
+ * change: WatchRuleRead() never sees a half updated range or a hot mask being rebuilt.
+ */
+
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <stdint.h>
+#include "platform.h"
+#include "sample.h"
+#include "noise.h"
+
+#define MAX_WATCHES FPM_MAX_WATCHES
+#define WATCH_NAME_SIZE 24
+#define AXIS_REST 1023      // value of a released pedal in 10-bit raw mode
+#define WATCH_ZONE_BINS 1024 // positions of an axis in the --heatmap hot zones
+#define WATCH_MIN_RUN 2     // stuck samples a repeat in ms needs at least, one close pair is not enough
+#define WATCH_SEEN_STABLE 16 // samples at a new extreme before --calibrate believes it
+
+typedef struct {
+    UINT joy_ID;
+    int axis;                   // FPM_X..FPM_V
+    int gate_axis;              // -1: no gate
+    int margin_pct;             // -1: use --margin
+    int repeat;                 // samples, -1: --repeat_ms or 4
+    int repeat_ms;              // > 0: repeat is a time instead
+    char name[WATCH_NAME_SIZE]; // what the alert says
+} WatchSpec;
+
+/* The part of a watch the main thread may change while the sampler runs */
+typedef struct {
+    uint32_t axis_min, rest, gate_rest;
+    int32_t  margin;
+    uint8_t  zoned, zone_shift;
+    uint32_t hot[WATCH_ZONE_BINS / 32];
+} WatchRule;
+
+typedef struct {
+    int spec_count;
+    WatchSpec specs[MAX_WATCHES];
+    int default_repeat_ms;              // --repeat_ms, for the watches without a repeat, 0: 4 samples
+    int default_engine;                 // --engine, DetectorEngine of every watch
+
+    /* Filled by WatchFinish() */
+    int device_count;
+    UINT joy_ID[FPM_MAX_DEVICES];       // joystick ID of every device index
+    uint8_t first[FPM_MAX_DEVICES];     // watches of device d are first[d] .. first[d]+n[d]-1
+    uint8_t n[FPM_MAX_DEVICES];
+
+    int count;
+    uint8_t  device[MAX_WATCHES];
+    uint8_t  axis[MAX_WATCHES];
+    int8_t   gate_axis[MAX_WATCHES];
+    uint32_t gate_rest[MAX_WATCHES];    // the gate is open when the gate axis sits at this value
+    uint32_t rest[MAX_WATCHES];         // the watched axis is ignored at this value
+    int32_t  margin[MAX_WATCHES];       // in axis units
+    uint8_t  margin_pct[MAX_WATCHES];
+    uint32_t axis_min[MAX_WATCHES];     // the range of the watched axis is axis_min .. rest
+    uint16_t repeat[MAX_WATCHES];
+    uint32_t repeat_us[MAX_WATCHES];    // 0: repeat counts samples
+    uint8_t  engine[MAX_WATCHES];       // DetectorEngine
+
+    /* Detector state */
+    uint32_t last[MAX_WATCHES];
+    uint16_t run[MAX_WATCHES];
+    int64_t  since_us[MAX_WATCHES];     // t_us of the sample the current run started from
+    NoiseState noise[MAX_WATCHES];      // ENGINE_STAT only
+
+    /* --calibrate, per device and axis */
+    int observe;
+    uint32_t seen_max[FPM_MAX_DEVICES][FPM_AXES];
+    uint32_t seen_min[FPM_MAX_DEVICES][FPM_AXES];
+    uint16_t seen_count[FPM_MAX_DEVICES][FPM_AXES]; // samples at seen_max, up to WATCH_SEEN_STABLE
+
+    /* Hot zones learned by --heatmap, with --heatmap_margin */
+    uint8_t  zoned[MAX_WATCHES];        // 1: margin_cold outside of the hot bins
+    uint8_t  zone_shift[MAX_WATCHES];   // bin = axis >> zone_shift
+    int32_t  margin_cold[MAX_WATCHES];
+    uint8_t  cold_pct[MAX_WATCHES];     // margin_cold as a percentage of the range, like margin_pct
+    uint32_t hot[MAX_WATCHES][WATCH_ZONE_BINS / 32];
+
+    /* For the sampler thread, see WatchPublish() */
+    volatile uint32_t rules_seq;        // odd while WatchPublish() writes
+    WatchRule rules[MAX_WATCHES];
+} WatchTable;
+
+void WatchInit(WatchTable *wt);
+
+/* Returns 0, or -1 (and prints why) if the spec is wrong or the table is full */
+int WatchAdd(WatchTable *wt, const char *spec);
+
+/* Adds the original rule if no --watch was given, sorts by device and fills the arrays */
+void WatchFinish(WatchTable *wt, UINT default_joy_ID, UINT default_margin_pct);
+
+void WatchPrint(const WatchTable *wt);
+
+/* Range of every axis of device d, a released pedal reads axis_max.  Axes with max <= min stay as they are */
+void WatchCalibrate(WatchTable *wt, int device, const uint32_t axis_min[FPM_AXES], const uint32_t axis_max[FPM_AXES]);
+
+/* --calibrate, after DetectorFeed().  Returns 1 when the range of a watch of s->device changed */
+int WatchObserve(WatchTable *wt, const FpmSample *s);
+
+/* Main thread, after the rules changed.  WatchFinish(), WatchCalibrate(), WatchObserve() and WatchSetMargin()
+ * do it themselves, the heatmap after it rebuilds the hot zones */
+void WatchPublish(WatchTable *wt);
+
+/* Any thread: a consistent copy of the rule of watch w */
+void WatchRuleRead(const WatchTable *wt, int w, WatchRule *rule);
+
+/* A watch by name or number, -1 if there is none */
+int WatchFind(const WatchTable *wt, const char *name);
+
+/* Changes of the control pipe, between two samples.  The current run of the watch starts again */
+void WatchSetMargin(WatchTable *wt, int w, int pct);
+void WatchSetRepeat(WatchTable *wt, int w, int repeat, int in_ms);
+void WatchSetEngine(WatchTable *wt, int w, int engine);
+
+/* 'X'..'V' -> FPM_X..FPM_V, '-' -> -1, anything else -2 */
+int AxisFromLetter(char c);
+
+#endif /* WATCH_H */